@@ -4,16 +4,24 @@
 #include "Tour.h"
 #include <random>
 #include <chrono>
+#include <utility>
 
 class SimulatedAnnealing {
 private:
     double initialTemp;
     double coolingRate;
     int iterationsPerTemp; 
+    // The run ends at minTemp, or after maxIterations when that is positive
+    double minTemp;
+    long maxIterations;
 
     double currentTemp;
     long totalIterations;
     
+    // Positions exchanged by the most recently accepted move
+    int lastSwapFirst;
+    int lastSwapSecond;
+    
     std::mt19937 generator;
 
     double acceptanceProbability(double deltaEnergy, double temperature) const;
@@ -22,13 +30,16 @@ public:
     SimulatedAnnealing(double temp, double rate, int iter);
 
     // --- Methods for Stepwise Execution (The core refactoring) ---
+    // Cools by coolingRate after every iterationsPerTemp iterations, as
+    // TSPSolver does, so tuned profiles run the schedule they were scored on
     bool runOneIteration(Tour& currentTour); 
-    void coolTemperature();
-    void reset(double initialTemp, double coolingRate, int iter);
+    void reset(double initialTemp, double coolingRate, int iter, double minTemp = 0.1, long maxIterations = 0);
+    bool isFinished() const { return currentTemp <= minTemp || (maxIterations > 0 && totalIterations >= maxIterations); }
 
     // --- Getters fully defined in header (FIX: Removed from .cpp) ---
     long getTotalIterations() const { return totalIterations; }
     double getCurrentTemperature() const { return currentTemp; }
+    std::pair<int, int> getLastSwap() const { return std::make_pair(lastSwapFirst, lastSwapSecond); }
 
     void displayParameters() const; 
 };
@@ -5,6 +5,11 @@
 #include "City.h"
 #include "Tour.h"
 #include "SimulatedAnnealing.h"
+#include "local_search.h"
+#include "solver_profile.h"
+#include "canvas_index.h"
+#include "performance_monitor.h"
+#include <cstdint>
 #include <vector>
 #include <string>
 
@@ -19,6 +24,35 @@ private:
     Tour bestTour;
     SimulatedAnnealing solver;
     
+    // The best tour is tracked lazily: while bestTourStale is set it equals
+    // currentTour with the journaled swaps undone, and is only rebuilt when drawn.
+    double bestDistance;
+    std::vector<std::pair<int, int>> bestJournal;
+    bool bestTourStale;
+    static const size_t BEST_JOURNAL_LIMIT = 256;
+    
+    // Engine selection. The local search works on indices into
+    // localSearchCities, the city order captured when it was started.
+    SolverMode solverMode;
+    IteratedLocalSearch localSearch;
+    std::vector<City> localSearchCities;
+    bool localSearchActive;
+    bool localSearchDone;
+    
+    // Start temperature of the short re-anneal after adding or removing a
+    // city, relative to the tour's mean edge as in TSPSolver's warm restart
+    static const double WARM_TEMPERATURE_FACTOR;
+    // Cap on its iterations times the city count, since every GUI swap
+    // recomputes the O(n) tour length
+    static const long WARM_WORK_LIMIT = 20000000;
+    // Instance and best tour saved with S and restored with L
+    static const char* const INSTANCE_FILE;
+    // Tuned schedule written by tsp_tune, used instead of the built-in
+    // defaults when present at startup
+    static const char* const PROFILE_FILE;
+    SolverProfile profile;
+    bool hasProfile;
+    
     // State management
     bool isRunning;
     bool isPaused;
@@ -31,23 +65,91 @@ private:
     static const int CANVAS_WIDTH = 750;
     static const int CANVAS_HEIGHT = 650;
     static const int PANEL_WIDTH = 400;
-    static const float VISUAL_SCALE;
-    static const float OFFSET_X;
-    static const float OFFSET_Y;
+    
+    // Canvas view: the city coordinates shown at the canvas centre and the
+    // pixels per coordinate unit. The wheel zooms about the cursor, dragging
+    // with the right mouse button pans and Home fits the view to the cities.
+    double viewCenterX;
+    double viewCenterY;
+    double viewScale;
+    bool isPanning;
+    sf::Vector2i panFrom;
+    static const double ZOOM_STEP;
+    
+    // The cities in best-tour order (or cityData's when the tour does not
+    // cover them), indexed so only what is in view gets drawn. Rebuilt when
+    // the best tour changes; on large instances at most every
+    // CANVAS_REBUILD_SECONDS while solving.
+    CanvasIndex canvasIndex;
+    bool canvasFromTour;
+    bool bestTourChanged;
+    sf::Clock canvasIndexClock;
+    static const size_t LARGE_INSTANCE = 100000;
+    static const float CANVAS_REBUILD_SECONDS;
+    
+    // Tour and cities as last rendered; redrawn only when the view moves or
+    // the index is rebuilt. Views holding more than DETAIL_LIMIT cities
+    // show density tiles of DENSITY_TILE pixels and one-pixel edges instead
+    // of markers, labels and thick edges.
+    sf::RenderTexture canvasLayer;
+    bool canvasLayerStale;
+    std::vector<int> visiblePoints;
+    std::vector<int> visibleEdges;
+    std::vector<std::uint32_t> tileCounts;
+    static const size_t DETAIL_LIMIT = 2000;
+    static const int DENSITY_TILE = 4;
     
     // Button states
     sf::RectangleShape startButton;
     sf::RectangleShape pauseButton;
     sf::RectangleShape resetButton;
+    sf::RectangleShape modeButton;
     sf::RectangleShape addCityButton;
     sf::RectangleShape removeCityButton;
     
     sf::Text startButtonText;
     sf::Text pauseButtonText;
     sf::Text resetButtonText;
+    sf::Text modeButtonText;
     sf::Text addCityButtonText;
     sf::Text removeCityButtonText;
     
+    // Control panel and statistics: the boxes, titles and labels are built
+    // once; each frame only re-sets the value texts whose string changed
+    enum StatisticSlot {
+        STAT_STATUS,
+        STAT_DISTANCE,
+        STAT_TEMPERATURE,
+        STAT_ITERATIONS,
+        STAT_CITIES,
+        STAT_COUNT
+    };
+    std::vector<sf::RectangleShape> panelShapes;
+    std::vector<sf::Text> panelTexts;
+    std::vector<sf::Text> statisticValues;
+    std::vector<std::string> statisticStrings;
+    
+    // Performance overlay, toggled with P. Solving and drawing share the
+    // GUI thread, so the split is of each frame's wall time between the
+    // solver step, rendering and the rest (events, frame-limit wait).
+    PerformanceMonitor performance;
+    bool showOverlay;
+    long frameMoves;
+    long frameAccepted;
+    std::vector<sf::RectangleShape> overlayShapes;
+    std::vector<sf::Text> overlayTexts;
+    // Rolling figures, re-formatted every OVERLAY_REFRESH_SECONDS
+    std::vector<sf::Text> overlayValues;
+    sf::Clock overlayClock;
+    std::vector<sf::RectangleShape> splitBars;
+    std::vector<sf::RectangleShape> histogramBars;
+    std::vector<int> histogramCounts;
+    static const float OVERLAY_REFRESH_SECONDS;
+    static const int OVERLAY_X = CANVAS_WIDTH - 300;
+    static const int OVERLAY_Y = 50;
+    static const int OVERLAY_WIDTH = 290;
+    static const int OVERLAY_HEIGHT = 330;
+    
     // Helper methods
     void initializeCities();
     void resetSimulation();
@@ -55,17 +157,42 @@ private:
     void update(float deltaTime);
     void draw();
     void runAlgorithmStep();
+    void materialiseBestTour();
+    void startLocalSearch(bool keepOrder);
+    void runLocalSearchStep();
+    void adoptLocalSearchTour();
+    bool applyCityEdit(const City& city, bool added);
+    void reoptimiseAfterEdit();
+    void saveInstanceFile();
+    void loadInstanceFile();
+    void loadProfileFile();
+    
+    // Canvas view
+    void fitCanvasView();
+    void zoomCanvas(double factor, const sf::Vector2i& about);
+    sf::Vector2f worldToCanvas(double x, double y) const;
+    CanvasRect visibleRect() const;
+    void refreshCanvas();
+    void rebuildCanvasIndex();
+    void renderCanvasLayer();
     
     // Drawing methods
     void drawCanvas();
-    void drawTour(const Tour& tour, const sf::Color& color, float thickness);
-    void drawCities();
+    void drawTour(sf::RenderTarget& target, const sf::Color& color, float thickness);
+    void drawCities(sf::RenderTarget& target);
+    void drawDensity(sf::RenderTarget& target);
     void drawControlPanel();
     void drawButton(const sf::RectangleShape& button, const sf::Text& text);
     void drawStatistics();
+    void setStatistic(int slot, const std::string& value, const sf::Color& color);
+    void drawOverlay();
+    void refreshOverlayValues();
+    void drawSparkline(bool distance, float x, float y, float width, float height, const sf::Color& color);
     
     // UI helper methods
     void setupButtons();
+    void setupStatistics();
+    void setupOverlay();
     void updateButtonStates();
     bool isMouseOverButton(const sf::RectangleShape& button, const sf::Vector2i& mousePos);
     void handleButtonClick(const sf::Vector2i& mousePos);
@@ -25,6 +25,11 @@ public:
     void generateRandomTour();
     void swapCities(int i, int j);
     Tour createCopy() const;
+    
+    // Incremental edits (Declarations): insert at the cheapest edge, or
+    // splice out a city matched by name and position
+    void insertCheapest(const City& city);
+    bool removeCity(const City& city);
 
     // Display method (Declaration)
     void display() const;
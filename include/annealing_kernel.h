@@ -0,0 +1,95 @@
+#ifndef ANNEALING_KERNEL_H
+#define ANNEALING_KERNEL_H
+
+#include <cstddef>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Simulated annealing with the hot loop specialised at compile time.
+//
+// The generic solver picks its move, scores it and converts lengths to
+// double through runtime switches on every iteration. Here the distance
+// metric, the scalar type of the coordinates and the move set are template
+// parameters, so each combination is its own loop with the edge function
+// inlined and the unused moves compiled out. Coordinates are stored in tour
+// order, so a move's delta reads neighbouring array slots with no gather
+// through the tour. runAnnealingKernel() picks the instantiation at run time.
+
+// TSPLIB EUC_2D, MAN_2D and MAX_2D edge weights
+enum class KernelMetric {
+    Euclidean,
+    Manhattan,
+    Maximum
+};
+
+// Coordinate store, as in ScalarTraits: double, float, or int32 fixed point
+// (coordinates times the schedule's coordinateScale, rounded, with integer
+// edge lengths)
+enum class KernelScalar {
+    Double,
+    Float,
+    Fixed
+};
+
+// Moves the loop draws from; with both, each iteration picks one at random
+enum KernelMoves {
+    KERNEL_MOVES_SWAP = 1,
+    KERNEL_MOVES_TWO_OPT = 2,
+    KERNEL_MOVES_BOTH = KERNEL_MOVES_SWAP | KERNEL_MOVES_TWO_OPT
+};
+
+struct KernelConfig {
+    KernelMetric metric;
+    KernelScalar scalar;
+    KernelMoves moves;
+
+    KernelConfig() : metric(KernelMetric::Euclidean), scalar(KernelScalar::Double), moves(KERNEL_MOVES_BOTH) {}
+    KernelConfig(KernelMetric metric, KernelScalar scalar, KernelMoves moves) : metric(metric), scalar(scalar), moves(moves) {}
+};
+
+const char* kernelMetricName(KernelMetric metric);
+const char* kernelScalarName(KernelScalar scalar);
+const char* kernelMovesName(KernelMoves moves);
+// Accept the names above; metrics also take the TSPLIB EUC_2D, MAN_2D, MAX_2D
+bool parseKernelMetric(const std::string& name, KernelMetric& metric);
+bool parseKernelScalar(const std::string& name, KernelScalar& scalar);
+bool parseKernelMoves(const std::string& name, KernelMoves& moves);
+
+// Reads the "metric", "precision" and "moves" keys of an instance's
+// metadata (see InstanceData); missing keys keep the KernelConfig defaults.
+// Throws std::runtime_error on a value it does not know.
+KernelConfig kernelConfigFromMetadata(const std::vector<std::pair<std::string, std::string>>& metadata);
+
+struct KernelSchedule {
+    double initialTemperature;
+    double coolingRate;
+    double minTemperature;
+    int iterationsPerTemperature;
+    long maxIterations;
+    unsigned seed;
+    // Fixed point only, as in BasicTSPSolver::setCoordinateScale
+    double coordinateScale;
+
+    KernelSchedule()
+        : initialTemperature(100.0), coolingRate(0.999), minTemperature(0.01), iterationsPerTemperature(100),
+          maxIterations(1000000), seed(1), coordinateScale(1.0) {}
+};
+
+struct KernelResult {
+    // Best tour found, as indices into the coordinate arrays
+    std::vector<int> tour;
+    // Its length under the metric, in input coordinate units
+    double distance;
+    long iterations;
+    long accepted;
+
+    KernelResult() : distance(0.0), iterations(0), accepted(0) {}
+};
+
+// Anneals from the identity tour until maxIterations or minTemperature.
+// Equal seeds give equal tours.
+KernelResult runAnnealingKernel(const KernelConfig& config, const double* xs, const double* ys, std::size_t n,
+                                const KernelSchedule& schedule);
+
+#endif // ANNEALING_KERNEL_H
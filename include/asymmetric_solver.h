@@ -0,0 +1,84 @@
+#ifndef ASYMMETRIC_SOLVER_H
+#define ASYMMETRIC_SOLVER_H
+
+#include "cost_matrix.h"
+#include "tsp_solver.h"
+#include <random>
+#include <vector>
+
+// Simulated annealing for asymmetric (directed) costs, e.g. travel times.
+//
+// Moves are chosen so that their deltas stay O(1) on a directed tour:
+//  - swap of two cities
+//  - Or-opt: a segment of 1-3 cities moved elsewhere, orientation kept
+//  - segment insertion (3-opt "or2h"): two adjacent segments exchanged,
+//    orientation kept
+//  - reversal (2-opt): every edge inside the segment changes direction; its
+//    cost comes from a Fenwick tree over each edge's backward minus forward
+//    cost, so it is O(log n), and an accepted move updates only the edges
+//    whose cities it moved, O(log n) each.
+class AsymmetricSolver {
+public:
+    AsymmetricSolver();
+
+    void setCostMatrix(const CostMatrix& matrix);
+    const CostMatrix& getCostMatrix() const { return costs; }
+    TSPSolution solve();
+    TSPSolution getCurrentSolution() const;
+    void reset();
+
+    // For step-by-step execution; under 5 cities the first step solves the
+    // instance exactly and ends the run
+    bool step();
+    double getTemperature() const { return temperature; }
+    long getIteration() const { return iteration; }
+    const std::vector<int>& getTour() const { return tour; }
+    double getCurrentCost() const { return currentCost; }
+
+    // Algorithm parameters (temperatures <= 0 are derived from the mean cost)
+    void setInitialTemperature(double temp) { initialTemperature = temp; }
+    void setMinTemperature(double temp) { minTemperature = temp; }
+    void setMaxIterations(long iterations) { maxIterations = iterations; }
+    // Relative probabilities of swap, Or-opt, segment insertion and reversal
+    void setMoveWeights(double swap, double orOpt, double segmentInsertion, double reversal);
+
+private:
+    CostMatrix costs;
+    std::vector<int> tour;
+    std::vector<int> bestTour;
+    double currentCost;
+    double bestCost;
+
+    // flipCost[k]: c(k, k-1) - c(k-1, k), what reversing the edge into
+    // position k costs. flipTree is the Fenwick tree over it (1-based).
+    std::vector<double> flipCost;
+    std::vector<double> flipTree;
+
+    // Algorithm parameters
+    double initialTemperature;
+    double minTemperature;
+    long maxIterations;
+    double moveWeights[4];
+
+    // State variables
+    double temperature;
+    double coolingRate;
+    long iteration;
+    std::mt19937 rng;
+
+    // Helper methods
+    double c(size_t fromPos, size_t toPos) const { return costs.cost(tour[fromPos], tour[toPos]); }
+    size_t next(size_t pos) const { return pos + 1 == tour.size() ? 0 : pos + 1; }
+    void buildFlips();
+    // Re-reads flipCost[k] for first <= k <= last after the tour changed there
+    void refreshFlips(size_t first, size_t last);
+    // Sum of flipCost[1..k]
+    double flipPrefix(size_t k) const;
+
+    double swapDelta(size_t i, size_t j) const;
+    double segmentExchangeDelta(size_t i, size_t j, size_t k) const;
+    double reversalDelta(size_t i, size_t j) const;
+    bool accept(double delta);
+};
+
+#endif // ASYMMETRIC_SOLVER_H
@@ -0,0 +1,75 @@
+#ifndef CANVAS_INDEX_H
+#define CANVAS_INDEX_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Axis-aligned rectangle in city coordinates
+struct CanvasRect {
+    double minX;
+    double minY;
+    double maxX;
+    double maxY;
+
+    CanvasRect() : minX(0.0), minY(0.0), maxX(0.0), maxY(0.0) {}
+    CanvasRect(double minX, double minY, double maxX, double maxY) : minX(minX), minY(minY), maxX(maxX), maxY(maxY) {}
+    bool contains(double x, double y) const { return x >= minX && x <= maxX && y >= minY && y <= maxY; }
+    bool overlaps(double x0, double y0, double x1, double y1) const {
+        return (x0 < x1 ? x1 : x0) >= minX && (x0 < x1 ? x0 : x1) <= maxX &&
+               (y0 < y1 ? y1 : y0) >= minY && (y0 < y1 ? y0 : y1) <= maxY;
+    }
+};
+
+// What a canvas needs to draw only what is in view.
+//
+// Points are given in tour order, so the tour's edges are (i, i + 1 mod n).
+// A uniform bucket grid (about two points per cell) answers which points
+// and which edges fall inside a view rectangle, touching only the cells
+// that overlap it. Edges no longer than twice the cell size are found
+// through the points within that distance of the view; longer ones are
+// kept in a separate list and tested one by one, which only costs much
+// for a tour far from optimal.
+class CanvasIndex {
+public:
+    CanvasIndex();
+
+    // `tour` says whether consecutive points are joined by edges
+    void build(const double* xs, const double* ys, std::size_t n, bool tour);
+    std::size_t size() const { return xs.size(); }
+    double x(int point) const { return xs[point]; }
+    double y(int point) const { return ys[point]; }
+    // Smallest rectangle holding every point
+    const CanvasRect& getBounds() const { return bounds; }
+
+    // Points inside view, in no particular order
+    void pointsIn(const CanvasRect& view, std::vector<int>& points) const;
+    // Edges whose bounding box meets view, as the index of their first point
+    void edgesIn(const CanvasRect& view, std::vector<int>& edges) const;
+    // Points inside view counted per tile of a tileColumns x tileRows
+    // raster laid over it, row by row from minY
+    void density(const CanvasRect& view, int tileColumns, int tileRows, std::vector<std::uint32_t>& counts) const;
+
+private:
+    std::vector<double> xs;
+    std::vector<double> ys;
+    CanvasRect bounds;
+    bool tour;
+
+    int columns;
+    int rows;
+    double cellWidth;
+    double cellHeight;
+    // Points of cell c are cellPoints[cellStart[c] .. cellStart[c + 1])
+    std::vector<int> cellStart;
+    std::vector<int> cellPoints;
+    double longEdge;
+    std::vector<int> longEdges;
+
+    int next(int point) const { return static_cast<std::size_t>(point) + 1 == xs.size() ? 0 : point + 1; }
+    // Calls visit(point) for every point inside view
+    template<typename Visit>
+    void forEachPoint(const CanvasRect& view, Visit visit) const;
+};
+
+#endif // CANVAS_INDEX_H
@@ -0,0 +1,35 @@
+#ifndef COST_MATRIX_H
+#define COST_MATRIX_H
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+// Dense directed cost matrix: cost(a, b) is the cost of travelling from
+// city a to city b and need not equal cost(b, a).
+class CostMatrix {
+public:
+    CostMatrix();
+    explicit CostMatrix(std::size_t n);
+
+    // Reads either a TSPLIB file (EDGE_WEIGHT_TYPE: EXPLICIT with
+    // EDGE_WEIGHT_FORMAT: FULL_MATRIX) or a plain file holding the city count
+    // followed by n*n row-major costs. Throws std::runtime_error on bad input.
+    static CostMatrix load(const std::string& path);
+    void save(const std::string& path) const;
+
+    std::size_t size() const { return n; }
+    double cost(int from, int to) const { return costs[static_cast<std::size_t>(from) * n + to]; }
+    void setCost(int from, int to, double value) { costs[static_cast<std::size_t>(from) * n + to] = value; }
+    const double* data() const { return costs.data(); }
+
+    // Cost of the closed directed tour
+    double tourCost(const std::vector<int>& tour) const;
+    bool isSymmetric() const;
+
+private:
+    std::size_t n;
+    std::vector<double> costs;
+};
+
+#endif // COST_MATRIX_H
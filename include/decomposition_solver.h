@@ -0,0 +1,63 @@
+#ifndef DECOMPOSITION_SOLVER_H
+#define DECOMPOSITION_SOLVER_H
+
+#include "tsp_solver.h"
+#include "window_annealer.h"
+#include <vector>
+
+// Decomposition mode for instances far beyond what one annealing chain can
+// handle. solve() runs the pipeline:
+//   1. partition the cities with k-d tree median cuts into clusters
+//   2. anneal every cluster with its own TSPSolver, in parallel
+//   3. order the clusters by a tour over their centroids and stitch the
+//      cluster tours together, opening each at its cheapest edge
+//   4. refine a window around every stitch point with windowed annealing
+class DecompositionSolver {
+public:
+    DecompositionSolver();
+
+    void setCities(const std::vector<City>& cities);
+    TSPSolution solve();
+    TSPSolution getCurrentSolution() const { return solution; }
+    std::vector<City> getCities() const { return cities; }
+
+    // Parameters
+    void setClusterSize(int size) { clusterSize = size < 8 ? 8 : size; }
+    void setThreadCount(int threads) { threadCount = threads; }
+    void setClusterIterations(int iterations) { clusterIterations = iterations; }
+    void setRefinementWindow(int positions) { refinementWindow = positions; }
+    void setRefinementParams(const WindowAnnealParams& params) { refinementParams = params; }
+
+    // Cluster index of every city after the last solve()
+    const std::vector<int>& getClusterAssignment() const { return clusterOf; }
+    int getClusterCount() const { return static_cast<int>(clusters.size()); }
+
+private:
+    std::vector<City> cities;
+    std::vector<double> xs;
+    std::vector<double> ys;
+    TSPSolution solution;
+
+    // Parameters
+    int clusterSize;
+    int threadCount;
+    int clusterIterations;
+    int refinementWindow;
+    WindowAnnealParams refinementParams;
+
+    // Pipeline state
+    std::vector<std::vector<int>> clusters;
+    std::vector<int> clusterOf;
+
+    // Pipeline stages
+    void partition();
+    void solveClusters(std::vector<std::vector<int>>& clusterTours) const;
+    std::vector<int> orderClusters() const;
+    std::vector<int> stitch(const std::vector<std::vector<int>>& clusterTours, const std::vector<int>& order,
+                            std::vector<size_t>& junctions) const;
+    void refineJunctions(std::vector<int>& tour, const std::vector<size_t>& junctions) const;
+
+    int workerCount() const;
+};
+
+#endif // DECOMPOSITION_SOLVER_H
@@ -0,0 +1,59 @@
+#ifndef DISTANCE_CACHE_H
+#define DISTANCE_CACHE_H
+
+#include "neighbour_lists.h"
+#include <cmath>
+#include <cstddef>
+#include <vector>
+
+// Precomputed Euclidean distances along the k-nearest-neighbour graph, for
+// instances too large for a dense matrix. Row a of the CSR arrays holds a's
+// k listed neighbours in list order, then the cities that list a (up to 2k
+// entries in all), so a lookup probes one short row and computes the
+// distance on a miss. Memory is linear in the city count. The cache keeps
+// its own copy of the coordinates for misses, so rebuild it after edits.
+class DistanceCache {
+public:
+    DistanceCache();
+
+    void build(const double* xs, const double* ys, std::size_t n, const NeighbourLists& lists);
+    void clear();
+    bool empty() const { return rowStart.empty(); }
+
+    double distance(int a, int b) const {
+        const int* column = columns.data() + rowStart[a];
+        const int* end = columns.data() + rowStart[a + 1];
+        for (; column != end; ++column) {
+            if (*column == b) {
+                ++hits;
+                return values[column - columns.data()];
+            }
+        }
+        ++misses;
+        return compute(a, b);
+    }
+
+    // Distance from a to its j-th listed neighbour, with no probe
+    double neighbourDistance(int a, int j) const { ++hits; return values[rowStart[a] + j]; }
+
+    std::size_t entryCount() const { return columns.size(); }
+    long getHits() const { return hits; }
+    long getMisses() const { return misses; }
+
+private:
+    std::vector<double> xs;
+    std::vector<double> ys;
+    std::vector<std::size_t> rowStart;
+    std::vector<int> columns;
+    std::vector<double> values;
+    mutable long hits;
+    mutable long misses;
+
+    double compute(int a, int b) const {
+        double dx = xs[a] - xs[b];
+        double dy = ys[a] - ys[b];
+        return std::sqrt(dx * dx + dy * dy);
+    }
+};
+
+#endif // DISTANCE_CACHE_H
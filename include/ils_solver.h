@@ -0,0 +1,64 @@
+#ifndef ILS_SOLVER_H
+#define ILS_SOLVER_H
+
+#include "tsp_solver.h"
+#include "local_search.h"
+#include <vector>
+
+// Iterated local search behind the TSPSolver interface. In hybrid mode the
+// annealer runs first and the local search starts from its best tour;
+// configure that phase through getAnnealer().
+class ILSSolver {
+public:
+    ILSSolver();
+
+    void setCities(const std::vector<City>& cities);
+    TSPSolution solve();
+    TSPSolution getCurrentSolution() const;
+    std::vector<City> getCities() const { return cities; }
+    void reset();
+    // Incremental edits, re-optimised locally (see IteratedLocalSearch::addCity)
+    void addCity(const City& city);
+    void removeCity(int index);
+
+    // One annealing iteration while the hybrid warm start runs, otherwise
+    // one local search step; returns false once both are done
+    bool step();
+    bool isAnnealing() const { return annealing; }
+    long getKickCount() const { return search.getKickCount(); }
+
+    // Parameters
+    void setHybrid(bool enabled) { hybrid = enabled; }
+    // solve() returns an optimal tour for up to this many cities (see
+    // TSPSolver::setExactLimit); 0 always searches
+    void setExactLimit(int cities) { exactLimit = cities < 0 ? 0 : std::min(cities, EXACT_CITY_LIMIT); }
+    TSPSolver& getAnnealer() { return annealer; }
+    void setNeighbourCount(int k) { search.setNeighbourCount(k); }
+    void setMaxKicks(long count) { search.setMaxKicks(count); }
+    void setKickSegmentLimit(int cities) { search.setKickSegmentLimit(cities); }
+    void setDistanceCache(bool enabled) { search.setDistanceCache(enabled); }
+    const DistanceCache& getDistanceCache() const { return search.getDistanceCache(); }
+    void setSeed(unsigned seed) { search.setSeed(seed); annealer.setSeed(seed); }
+    // Renumbers cities along a space-filling curve for both engines (see
+    // TSPSolver::setSpatialOrder); takes effect on the next setCities
+    void setSpatialOrder(SpatialOrder order) { spatialOrder = order; annealer.setSpatialOrder(order); }
+    // Annealer schedule and neighbour-list size from a tuned profile; call
+    // after setCities
+    void applyProfile(const SolverProfile& profile);
+
+private:
+    std::vector<City> cities;
+    // Search coordinates in curve order; originalIndex maps back to the
+    // caller's indices (empty = identity)
+    std::vector<double> xs;
+    std::vector<double> ys;
+    std::vector<int> originalIndex;
+    SpatialOrder spatialOrder;
+    IteratedLocalSearch search;
+    TSPSolver annealer;
+    bool hybrid;
+    bool annealing;
+    int exactLimit;
+};
+
+#endif // ILS_SOLVER_H
@@ -0,0 +1,90 @@
+#ifndef INSTANCE_FILE_H
+#define INSTANCE_FILE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Binary instance/tour file (.tspb).
+//
+// A fixed 80-byte header is followed by 8-byte aligned blocks:
+//   coordinates  n doubles of x, then n doubles of y (SoA)
+//   matrix       optional n*n row-major doubles
+//   tours        tourCount permutations of n int32 each
+//   metadata     "key=value\n" lines of UTF-8 text
+// Every block is stored in host byte order at the offset recorded in the
+// header, so a mapped file is used in place with no parse step. A byte
+// order mark rejects files written on a host of the other endianness.
+struct InstanceFileHeader {
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t byteOrder;
+    std::uint64_t cityCount;
+    std::uint64_t tourCount;
+    std::uint64_t coordinateOffset;
+    std::uint64_t matrixOffset;
+    std::uint64_t tourOffset;
+    std::uint64_t metadataOffset;
+    std::uint64_t metadataSize;
+    std::uint64_t fileSize;
+};
+
+static_assert(sizeof(InstanceFileHeader) == 80, "InstanceFileHeader layout must not change");
+
+const std::uint32_t INSTANCE_FILE_VERSION = 1;
+
+// Owning form of a file's contents
+struct InstanceData {
+    std::vector<double> xs;
+    std::vector<double> ys;
+    // Empty, or cityCount*cityCount row-major costs
+    std::vector<double> matrix;
+    std::vector<std::vector<int>> tours;
+    std::vector<std::pair<std::string, std::string>> metadata;
+};
+
+// Both throw std::runtime_error on I/O errors or malformed input
+void saveInstance(const std::string& path, const InstanceData& data);
+InstanceData loadInstance(const std::string& path);
+// True if the file starts with the .tspb magic
+bool isInstanceFile(const std::string& path);
+
+// Read-only view of a file mapped into memory; the pointers stay valid for
+// the lifetime of the object. Where mmap is unavailable the file is read
+// into one buffer instead.
+class MappedInstance {
+public:
+    explicit MappedInstance(const std::string& path);
+    ~MappedInstance();
+    MappedInstance(MappedInstance&& other) noexcept;
+    MappedInstance& operator=(MappedInstance&& other) noexcept;
+    MappedInstance(const MappedInstance&) = delete;
+    MappedInstance& operator=(const MappedInstance&) = delete;
+
+    std::size_t cityCount() const { return static_cast<std::size_t>(header().cityCount); }
+    const double* xs() const { return at<double>(header().coordinateOffset); }
+    const double* ys() const { return xs() + cityCount(); }
+    bool hasMatrix() const { return header().matrixOffset != 0; }
+    const double* matrix() const { return hasMatrix() ? at<double>(header().matrixOffset) : nullptr; }
+    std::size_t tourCount() const { return static_cast<std::size_t>(header().tourCount); }
+    const std::int32_t* tour(std::size_t index) const { return at<std::int32_t>(header().tourOffset) + index * cityCount(); }
+    // Value for `key`, or an empty string
+    std::string metadata(const std::string& key) const;
+    std::vector<std::pair<std::string, std::string>> allMetadata() const;
+
+private:
+    const unsigned char* bytes;
+    std::size_t size;
+    bool mapped;
+    std::vector<unsigned char> buffer;
+
+    const InstanceFileHeader& header() const { return *reinterpret_cast<const InstanceFileHeader*>(bytes); }
+    template<typename T>
+    const T* at(std::uint64_t offset) const { return reinterpret_cast<const T*>(bytes + offset); }
+    void validate(const std::string& path) const;
+    void release();
+};
+
+#endif // INSTANCE_FILE_H
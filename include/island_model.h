@@ -0,0 +1,99 @@
+#ifndef ISLAND_MODEL_H
+#define ISLAND_MODEL_H
+
+#include "tsp_solver.h"
+#include "thread_placement.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Tours exchanged between islands are canonical: they start at city 0 and
+// run towards the smaller of its two neighbours, so two tours that differ
+// by a few moves also differ in a few positions only.
+void canonicaliseTour(std::vector<int>& tour);
+
+// Permutation delta from `previous` to `current` (same size): a run count,
+// then for every run of changed positions its start, its length and the
+// new cities, all as 32-bit words.
+std::vector<std::uint32_t> encodeTourDelta(const std::vector<int>& previous, const std::vector<int>& current);
+// Applies a delta in place; false (tour unchanged) if it is malformed or
+// the result is not a permutation
+bool applyTourDelta(std::vector<int>& tour, const std::uint32_t* words, std::size_t count);
+
+struct IslandConfig {
+    // Annealers per island, run on one thread each (0 = one per hardware thread)
+    int population;
+    // Migration rounds, and annealing iterations per annealer between them
+    int epochs;
+    int epochIterations;
+    unsigned seed;
+    // Pinning of the annealer threads; with several NUMA nodes each island
+    // keeps to node (island index mod node count)
+    PlacementPolicy placement;
+
+    IslandConfig() : population(0), epochs(20), epochIterations(100000), seed(1), placement(PlacementPolicy::None) {}
+};
+
+struct IslandStats {
+    long iterations;
+    long messages;
+    // Fewer than messages * (tour size + header) when deltas pay off
+    long bytesSent;
+    long deltaMessages;
+    long migrantsAccepted;
+    double seconds;
+
+    IslandStats() : iterations(0), messages(0), bytesSent(0), deltaMessages(0), migrantsAccepted(0), seconds(0.0) {}
+};
+
+// One island of the island model: a population of annealers sharing one
+// cooling schedule, which after every epoch sends its best tour to the next
+// island in a ring and seeds the received one into its worst annealer when
+// that is an improvement. Islands talk over TCP (a message header, then the
+// tour as a delta against the last one sent on that link, or in full when
+// that is smaller), in native byte order, so peers must share an
+// architecture. Without a peer the island runs alone.
+class IslandSolver {
+public:
+    IslandSolver();
+    ~IslandSolver();
+    IslandSolver(const IslandSolver&) = delete;
+    IslandSolver& operator=(const IslandSolver&) = delete;
+
+    void setCities(const std::vector<City>& cities) { this->cities = cities; }
+    void setConfig(const IslandConfig& config) { this->config = config; }
+    // Position in the ring, which also offsets the annealers' seeds
+    void setIslandIndex(int index) { islandIndex = index; }
+    // Opens the socket the previous island connects to (0 = any free port)
+    // and returns its port; throws std::runtime_error on failure
+    int listen(int port = 0, const std::string& address = "127.0.0.1");
+    void setPeer(const std::string& host, int port) { peerHost = host; peerPort = port; }
+
+    TSPSolution run();
+    const IslandStats& getStats() const { return stats; }
+    // Where the annealer threads of the last run() were pinned
+    const std::vector<WorkerPlacement>& getPlacements() const { return placements; }
+
+private:
+    std::vector<City> cities;
+    IslandConfig config;
+    int islandIndex;
+    int listenSocket;
+    std::string peerHost;
+    int peerPort;
+    IslandStats stats;
+    std::vector<WorkerPlacement> placements;
+
+    int connectToPeer() const;
+};
+
+// Runs `islandCount` islands as separate processes on this machine, joined
+// in a ring over localhost, and returns the best tour any of them found.
+// `totals` (optional) receives the islands' stats summed, with the
+// longest island's wall time, and `placements` (optional) each island's
+// thread placements.
+TSPSolution runIslands(const std::vector<City>& cities, int islandCount, const IslandConfig& config,
+                       IslandStats* totals = nullptr, std::vector<std::vector<WorkerPlacement>>* placements = nullptr);
+
+#endif // ISLAND_MODEL_H
@@ -0,0 +1,80 @@
+#ifndef LIBTSP_H
+#define LIBTSP_H
+
+/* C interface of the libtsp shared library.
+ *
+ * A context owns one solver and the buffers it reuses between calls. The
+ * coordinates are borrowed, not copied: the arrays passed to
+ * tsp_set_coordinates must stay valid and unchanged until the context's
+ * next tsp_set_coordinates or tsp_destroy. Tours are written into buffers
+ * the caller provides.
+ *
+ * Every call on a context locks that context, so one context may be shared
+ * between threads; calls on different contexts never contend. No function
+ * throws or aborts: failures return a status and leave a message for
+ * tsp_last_error. */
+
+#include <stddef.h>
+#include <stdint.h>
+
+#if defined(_WIN32)
+#  if defined(LIBTSP_BUILD)
+#    define TSP_API __declspec(dllexport)
+#  else
+#    define TSP_API __declspec(dllimport)
+#  endif
+#else
+#  define TSP_API __attribute__((visibility("default")))
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Bumped whenever a signature or struct layout changes */
+#define TSP_ABI_VERSION 1
+
+typedef struct tsp_context tsp_context;
+
+typedef enum tsp_status {
+    TSP_OK = 0,
+    /* A null pointer, a short buffer or a non-finite coordinate */
+    TSP_ERROR_ARGUMENT = 1,
+    /* No coordinates set, or nothing solved yet */
+    TSP_ERROR_STATE = 2,
+    TSP_ERROR_MEMORY = 3,
+    TSP_ERROR_INTERNAL = 4
+} tsp_status;
+
+TSP_API int tsp_abi_version(void);
+
+/* Returns NULL when out of memory */
+TSP_API tsp_context* tsp_create(void);
+TSP_API void tsp_destroy(tsp_context* context);
+
+/* Borrows n coordinate pairs (see above) and forgets the previous tour */
+TSP_API tsp_status tsp_set_coordinates(tsp_context* context, const double* xs, const double* ys, size_t n);
+/* Seed of the search's random kicks (default 1); equal seeds and budgets
+   that end on the same kick give equal tours */
+TSP_API tsp_status tsp_set_seed(tsp_context* context, uint32_t seed);
+/* Instances up to this many cities are solved optimally (default 10, max 24) */
+TSP_API tsp_status tsp_set_exact_limit(tsp_context* context, int cities);
+
+/* Builds a tour and improves it until `seconds` have passed since the
+   call. The first local optimum is always completed, so seconds <= 0 means
+   a single 2-opt/Or-opt descent. */
+TSP_API tsp_status tsp_solve(tsp_context* context, double seconds);
+/* Copies the last solved tour (city indices, a permutation of 0..n-1) into
+   tour[0..n-1]; capacity is the buffer's length in elements */
+TSP_API tsp_status tsp_get_tour(tsp_context* context, int32_t* tour, size_t capacity);
+TSP_API tsp_status tsp_get_length(tsp_context* context, double* length);
+
+/* Message for the last failed call on this context ("" after a success);
+   valid until the context's next call */
+TSP_API const char* tsp_last_error(tsp_context* context);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* LIBTSP_H */
@@ -0,0 +1,147 @@
+#ifndef LOCAL_SEARCH_H
+#define LOCAL_SEARCH_H
+
+#include "neighbour_lists.h"
+#include "distance_cache.h"
+#include <cstddef>
+#include <deque>
+#include <random>
+#include <vector>
+
+// Which engine a front end drives: plain annealing, iterated local search,
+// annealing followed by iterated local search from the annealed tour, or
+// the population-based MemeticSolver.
+enum class SolverMode {
+    Annealing,
+    IteratedLocalSearch,
+    Hybrid,
+    Memetic
+};
+
+const char* solverModeName(SolverMode mode);
+// Accepts "sa", "ils", "hybrid" and "memetic"; returns false for anything else
+bool parseSolverMode(const char* name, SolverMode& mode);
+
+// Iterated local search on plain coordinate arrays.
+//
+// The local search is 2-opt plus Or-opt (segments of up to three cities,
+// inserted in either orientation), restricted to each city's nearest
+// neighbours and driven by a queue of cities whose don't-look bit is off.
+// Every step then applies a segment-local double-bridge kick, re-optimises
+// around it and keeps the result only if the tour got shorter; rejected
+// kicks are rolled back by undoing the journaled array operations.
+class IteratedLocalSearch {
+public:
+    IteratedLocalSearch();
+    // Not copyable: the coordinate pointers may refer to the owned arrays
+    IteratedLocalSearch(const IteratedLocalSearch&) = delete;
+    IteratedLocalSearch& operator=(const IteratedLocalSearch&) = delete;
+
+    void setCoordinates(const std::vector<double>& xs, const std::vector<double>& ys);
+    // Borrows the caller's arrays instead of copying them: they must stay
+    // valid and unchanged until the next setCoordinates. addCity/removeCity
+    // take a private copy first.
+    void setCoordinates(const double* xs, const double* ys, std::size_t n);
+    // Starting tour; a nearest-neighbour tour is built when none (or an invalid one) is given
+    void setTour(const std::vector<int>& tour);
+    void reset();
+    
+    // Incremental edits on the current tour: the new city (index n) goes in
+    // next to whichever listed neighbour gives the cheapest detour, a removed
+    // one is spliced out (later indices shift down), and the local search
+    // then re-optimises around the change only.
+    void addCity(double x, double y);
+    void removeCity(int index);
+
+    // The first step descends to a local optimum, every later step tries one
+    // kick; returns false once the kick budget is spent
+    bool step();
+    const std::vector<int>& getTour() const { return tour; }
+    double getLength() const { return length; }
+    long getKickCount() const { return kicks; }
+    long getImprovingKicks() const { return improvingKicks; }
+
+    // Parameters
+    // Takes effect on the next setCoordinates
+    void setNeighbourCount(int k) { neighbourCount = k < 1 ? 1 : k; }
+    void setMaxKicks(long count) { maxKicks = count; }
+    // Longest of the two segments exchanged by a kick
+    void setKickSegmentLimit(int cities) { kickSegmentLimit = cities < 1 ? 1 : cities; }
+    void setSeed(unsigned seed) { rng.seed(seed); }
+    // Look distances up in a k-NN distance cache instead of recomputing
+    // them; takes effect on the next setCoordinates
+    void setDistanceCache(bool enabled) { cacheDistances = enabled; }
+    const DistanceCache& getDistanceCache() const { return cache; }
+
+private:
+    // Array operations, journaled so a rejected kick can be undone
+    enum OperationKind {
+        OP_REVERSE,
+        OP_ROTATE
+    };
+
+    struct Operation {
+        int kind;
+        int first;
+        int second;
+        int third;
+    };
+
+    // Owned coordinates; xData/yData point either at these or at borrowed arrays
+    std::vector<double> xs;
+    std::vector<double> ys;
+    const double* xData;
+    const double* yData;
+    std::size_t cityCount;
+    NeighbourLists neighbours;
+    DistanceCache cache;
+    std::vector<int> initialTour;
+    std::vector<int> tour;
+    std::vector<int> position;
+    double length;
+
+    std::deque<int> active;
+    std::vector<char> queued;
+    std::vector<Operation> journal;
+    bool journaling;
+    bool optimised;
+
+    // Parameters
+    int neighbourCount;
+    long maxKicks;
+    int kickSegmentLimit;
+    bool cacheDistances;
+
+    // State
+    long kicks;
+    long improvingKicks;
+    std::mt19937 rng;
+
+    double dist(int a, int b) const;
+    double computeDist(int a, int b) const;
+    // Distance to the j-th listed neighbour, read straight from the cache
+    double neighbourDist(int a, int j) const { return cache.empty() ? dist(a, neighbours.of(a)[j]) : cache.neighbourDistance(a, j); }
+    void rebuildCache();
+    void buildStructures();
+    // Copies borrowed coordinates so they can be edited
+    void ownCoordinates();
+    int next(int city) const { return tour[position[city] + 1 == static_cast<int>(tour.size()) ? 0 : position[city] + 1]; }
+    int prev(int city) const { return tour[position[city] == 0 ? tour.size() - 1 : position[city] - 1]; }
+
+    void buildNearestNeighbourTour();
+    void push(int city);
+    void rebuildPositions();
+    void reoptimiseAround(int city);
+    void localSearch();
+    bool improveTwoOpt(int a);
+    bool improveOrOpt(int a);
+    void kick();
+
+    void reverseRange(int start, int count);
+    void rotateRange(int first, int middle, int last);
+    void reversePath(int from, int to);
+    void twoOptMove(int a, int b, int c, int d);
+    void undoJournal();
+};
+
+#endif // LOCAL_SEARCH_H
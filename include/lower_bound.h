@@ -0,0 +1,80 @@
+#ifndef LOWER_BOUND_H
+#define LOWER_BOUND_H
+
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+// Held-Karp lower bound on the optimal tour length: a minimum 1-tree (a
+// spanning tree on cities 1..n-1 plus the two cheapest edges at city 0)
+// under node penalties pi, raised by subgradient ascent on the degrees.
+//
+// The ascent works on the symmetrised k-nearest-neighbour graph, whose
+// 1-tree is cheap but can only overestimate the true one. Every
+// verifyInterval iterations, and when the ascent ends, the penalties are
+// checked with a 1-tree over the complete graph (O(n^2)); only those
+// values are reported as bounds. Above the dense limit nothing is
+// verified and getBound() stays 0.
+//
+// compute() may run on its own thread: getBound() and cancel() are safe
+// to call concurrently with it.
+class HeldKarpBound {
+public:
+    HeldKarpBound();
+    HeldKarpBound(const HeldKarpBound&) = delete;
+    HeldKarpBound& operator=(const HeldKarpBound&) = delete;
+
+    void setCoordinates(const double* xs, const double* ys, std::size_t n);
+    // Runs the ascent and returns the best verified bound (0 if none)
+    double compute();
+    void cancel() { cancelled = true; }
+
+    double getBound() const { return bound.load(); }
+    // Best candidate-graph value; not a valid bound
+    double getEstimate() const { return estimate.load(); }
+    int getIterations() const { return iterations.load(); }
+
+    // Parameters
+    void setNeighbourCount(int k) { neighbourCount = k < 2 ? 2 : k; }
+    void setMaxIterations(int count) { maxIterations = count; }
+    // Ascent iterations between dense checks (0 = scale with the city count)
+    void setVerifyInterval(int count) { verifyInterval = count < 0 ? 0 : count; }
+    void setDenseLimit(std::size_t cities) { denseLimit = cities; }
+    // Length of a known tour, which sets the step size; <= 0 builds a
+    // 2-opt tour first
+    void setUpperBound(double length) { upperBound = length; }
+
+private:
+    struct Edge {
+        int a;
+        int b;
+        double length;
+    };
+
+    std::vector<double> xs;
+    std::vector<double> ys;
+    std::vector<Edge> edges;
+    std::vector<double> penalty;
+    std::vector<int> degree;
+
+    int neighbourCount;
+    int maxIterations;
+    int verifyInterval;
+    std::size_t denseLimit;
+    double upperBound;
+
+    std::atomic<bool> cancelled;
+    std::atomic<double> bound;
+    std::atomic<double> estimate;
+    std::atomic<int> iterations;
+
+    double dist(int a, int b) const;
+    void buildCandidateEdges();
+    // Both fill degree and return the penalised 1-tree weight minus 2*sum(pi);
+    // the sparse one returns false if the candidate graph is disconnected
+    bool sparseOneTree(double& value);
+    double denseOneTree();
+    void verify();
+};
+
+#endif // LOWER_BOUND_H
@@ -0,0 +1,128 @@
+#ifndef MEMETIC_SOLVER_H
+#define MEMETIC_SOLVER_H
+
+#include "exact_solver.h"
+#include "neighbour_lists.h"
+#include <algorithm>
+#include <cstddef>
+#include <random>
+#include <vector>
+
+// How two parent tours are combined
+enum class Crossover {
+    // Edge assembly: one random AB-cycle of the parents' differing edges is
+    // applied to the first parent, then the subtours are joined greedily
+    EdgeAssembly,
+    // Order crossover: a segment of the first parent, the rest in the order
+    // the second parent visits it
+    Order,
+    // Edge recombination: walk the union of both parents' edges, preferring
+    // the neighbour with the fewest edges left
+    EdgeRecombination
+};
+
+const char* crossoverName(Crossover crossover);
+// Accepts "eax", "ox" and "erx"; returns false for anything else
+bool parseCrossover(const char* name, Crossover& crossover);
+
+// How every offspring is improved before it competes
+enum class MemeticPolish {
+    // 2-opt plus Or-opt descent (see IteratedLocalSearch)
+    LocalSearch,
+    // A short low-temperature anneal of the whole tour (see annealWindow)
+    Annealing
+};
+
+// Memetic algorithm on plain coordinate arrays.
+//
+// The population lives in one flat pool of permutations, population tours
+// followed by one offspring slot per member. Every generation pairs each
+// member with the next one in a random order, builds one child per pair in
+// the member's offspring slot, polishes it, and lets it replace that member
+// if it is shorter and not a copy of a member's length. Children are built
+// and polished in parallel, each worker with its own local search engine;
+// a child's random stream depends only on the seed, generation and slot,
+// so results do not depend on the thread count.
+class MemeticSolver {
+public:
+    MemeticSolver();
+
+    void setCoordinates(const std::vector<double>& xs, const std::vector<double>& ys);
+    // Discards the population; the next step() builds a new one
+    void reset();
+
+    // One generation; returns false once the generation or stagnation limit
+    // is reached (the first call after reset() only builds the population).
+    // Instances within the exact limit, or too small to recombine, are
+    // solved by ExactSolver in the first call instead.
+    bool step();
+    const std::vector<int>& getBestTour() const { return bestTour; }
+    double getBestLength() const { return bestLength; }
+    double getMeanLength() const;
+    int getGeneration() const { return generation; }
+    long getImprovingOffspring() const { return improvingOffspring; }
+    int getPopulationSize() const { return populationSize; }
+    const int* getMember(int member) const { return pool.data() + static_cast<std::size_t>(member) * xs.size(); }
+
+    // Parameters
+    // Takes effect on the next reset (setCoordinates resets)
+    void setPopulationSize(int size) { populationSize = size < 2 ? 2 : size; }
+    void setCrossover(Crossover crossover) { this->crossover = crossover; }
+    void setPolish(MemeticPolish polish) { this->polish = polish; }
+    // Annealing polish moves per city
+    void setPolishIterations(int perCity) { polishIterations = perCity < 1 ? 1 : perCity; }
+    void setMaxGenerations(int generations) { maxGenerations = generations; }
+    // Generations without a new best before giving up (0 = never)
+    void setStagnationLimit(int generations) { stagnationLimit = generations < 0 ? 0 : generations; }
+    void setThreadCount(int threads) { threadCount = threads; }
+    void setSeed(unsigned seed) { this->seed = seed; }
+    // Solve instances up to this many cities exactly (see
+    // TSPSolver::setExactLimit); 0 always evolves
+    void setExactLimit(int cities) { exactLimit = cities < 0 ? 0 : std::min(cities, EXACT_CITY_LIMIT); }
+    // Takes effect on the next setCoordinates
+    void setNeighbourCount(int k) { neighbourCount = k < 1 ? 1 : k; }
+
+private:
+    std::vector<double> xs;
+    std::vector<double> ys;
+    NeighbourLists neighbours;
+    // (2 * populationSize) tours of n cities each
+    std::vector<int> pool;
+    std::vector<double> lengths;
+    std::vector<int> bestTour;
+    double bestLength;
+
+    // Parameters
+    int populationSize;
+    Crossover crossover;
+    MemeticPolish polish;
+    int polishIterations;
+    int maxGenerations;
+    int stagnationLimit;
+    int threadCount;
+    unsigned seed;
+    int neighbourCount;
+    int exactLimit;
+
+    // State
+    bool initialised;
+    int generation;
+    int stagnantGenerations;
+    long improvingOffspring;
+    std::mt19937 rng;
+
+    double dist(int a, int b) const;
+    double length(const int* tour) const;
+    int* slot(int index) { return pool.data() + static_cast<std::size_t>(index) * xs.size(); }
+    // Runs body(slot, rng) for every slot in [first, first + count) on the
+    // worker threads, each worker holding its own polishing engine
+    template<typename Body>
+    void forEachSlot(int first, int count, Body body);
+    void updateBest();
+
+    void edgeAssembly(const int* a, const int* b, int* child, std::mt19937& random) const;
+    void orderCrossover(const int* a, const int* b, int* child, std::mt19937& random) const;
+    void edgeRecombination(const int* a, const int* b, int* child, std::mt19937& random) const;
+};
+
+#endif // MEMETIC_SOLVER_H
@@ -0,0 +1,29 @@
+#ifndef NEIGHBOUR_LISTS_H
+#define NEIGHBOUR_LISTS_H
+
+#include <cstddef>
+#include <vector>
+
+// The k nearest cities of every city, nearest first, stored as one flat
+// array of n*k entries. k is clamped to n-1.
+struct NeighbourLists {
+    int k;
+    std::vector<int> indices;
+
+    NeighbourLists() : k(0) {}
+    const int* of(int city) const { return indices.data() + static_cast<std::size_t>(city) * k; }
+};
+
+// Builds the lists with a uniform bucket grid (about two cities per cell),
+// searching rings of cells outwards until no closer city can remain.
+NeighbourLists buildNeighbourLists(const double* xs, const double* ys, std::size_t n, int k);
+
+// Local repairs for incremental edits, given the arrays after the edit.
+// Appending city n-1 scans once and splices it into the lists it beats;
+// removing a city renumbers the lists and rescans only those that held it.
+// Instances too small for k neighbours are rebuilt instead.
+void appendToNeighbourLists(NeighbourLists& lists, const double* xs, const double* ys, std::size_t n, int k);
+void removeFromNeighbourLists(NeighbourLists& lists, const double* xs, const double* ys, std::size_t n, int k,
+                              int removed);
+
+#endif // NEIGHBOUR_LISTS_H
@@ -0,0 +1,37 @@
+#ifndef PARALLEL_FOR_H
+#define PARALLEL_FOR_H
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <thread>
+#include <vector>
+
+// Number of worker threads to use when the caller asked for `requested`
+// (0 or less means one per hardware thread).
+inline int resolveWorkerCount(int requested) {
+    if (requested > 0) return requested;
+    unsigned hardware = std::thread::hardware_concurrency();
+    return hardware > 0 ? static_cast<int>(hardware) : 1;
+}
+
+// Runs body(i) for i in [0, count) on up to `workers` threads, handing out
+// indices dynamically so uneven work items still balance.
+template<typename Body>
+void parallelFor(std::size_t count, int workers, Body body) {
+    if (workers <= 1 || count <= 1) {
+        for (std::size_t i = 0; i < count; ++i) body(i);
+        return;
+    }
+    std::atomic<std::size_t> next(0);
+    std::vector<std::thread> threads;
+    int spawned = static_cast<int>(std::min<std::size_t>(count, static_cast<std::size_t>(workers)));
+    for (int t = 0; t < spawned; ++t) {
+        threads.emplace_back([&]() {
+            for (std::size_t i = next++; i < count; i = next++) body(i);
+        });
+    }
+    for (auto& thread : threads) thread.join();
+}
+
+#endif // PARALLEL_FOR_H
@@ -0,0 +1,61 @@
+#ifndef PERFORMANCE_MONITOR_H
+#define PERFORMANCE_MONITOR_H
+
+#include <cstddef>
+#include <vector>
+
+// What one frame of an interactive front end did and how long it took
+struct FrameSample {
+    // Moves tried and accepted by the solver during the frame
+    long moves;
+    long accepted;
+    // Best tour length at the end of the frame
+    double bestDistance;
+    // Wall time spent stepping the solver, drawing, and in the whole frame
+    // (the rest is event handling and waiting on the frame limit)
+    double solveSeconds;
+    double renderSeconds;
+    double frameSeconds;
+
+    FrameSample()
+        : moves(0), accepted(0), bestDistance(0.0), solveSeconds(0.0), renderSeconds(0.0), frameSeconds(0.0) {}
+};
+
+// Rolling window of the most recent frames, for a live performance overlay.
+// Samples live in a fixed ring, so recording never allocates; every
+// statistic is over the frames currently in the window.
+class PerformanceMonitor {
+public:
+    // Frame-time histogram buckets: bucket i counts frames shorter than
+    // HISTOGRAM_LIMITS_MS[i], the last one every longer frame
+    static const int HISTOGRAM_BUCKETS = 8;
+    static const double HISTOGRAM_LIMITS_MS[HISTOGRAM_BUCKETS - 1];
+
+    explicit PerformanceMonitor(std::size_t capacity = 240);
+
+    void recordFrame(const FrameSample& sample);
+    void clear();
+    std::size_t size() const { return count; }
+    std::size_t capacity() const { return samples.size(); }
+    // Oldest first: getSample(0) is the oldest frame still in the window
+    const FrameSample& getSample(std::size_t index) const;
+
+    double getMovesPerSecond() const;
+    // Accepted over tried moves (0 when nothing was tried)
+    double getAcceptanceRate() const;
+    // Fractions of the window's wall time spent solving and rendering
+    double getSolveShare() const;
+    double getRenderShare() const;
+    double getMeanFrameSeconds() const;
+    void getFrameHistogram(std::vector<int>& counts) const;
+
+private:
+    std::vector<FrameSample> samples;
+    // Index the next sample goes to, and how many are held
+    std::size_t head;
+    std::size_t count;
+    // Window totals, kept up to date as samples enter and leave
+    FrameSample totals;
+};
+
+#endif // PERFORMANCE_MONITOR_H
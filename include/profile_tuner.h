@@ -0,0 +1,58 @@
+#ifndef PROFILE_TUNER_H
+#define PROFILE_TUNER_H
+
+#include "tsp_solver.h"
+#include "local_search.h"
+#include "solver_profile.h"
+#include <iosfwd>
+#include <vector>
+
+// Races solver configurations over an instance set by successive halving.
+// Configuration 0 is the default profile, the rest are sampled at random.
+// Every rung runs all surviving configurations on every instance, scores
+// each by its mean tour length relative to the best length found on that
+// instance in the rung, and keeps the best 1/eta of them for the next rung,
+// where each gets eta times the budget, until one is left. The CPU budget is split evenly
+// between rungs after timing a short calibration run.
+class ProfileTuner {
+public:
+    ProfileTuner();
+
+    void setInstances(const std::vector<std::vector<City>>& instances) { this->instances = instances; }
+    SolverProfile tune();
+
+    // Parameters
+    void setConfigurationCount(int count) { configurationCount = count < 1 ? 1 : count; }
+    void setEta(int eta) { this->eta = eta < 2 ? 2 : eta; }
+    // Total CPU seconds across all worker threads
+    void setBudgetSeconds(double seconds) { budgetSeconds = seconds; }
+    void setThreadCount(int threads) { threadCount = threads; }
+    void setMode(SolverMode mode) { this->mode = mode; }
+    void setSeed(unsigned seed) { this->seed = seed; }
+    // Progress lines for every rung (nullptr = silent)
+    void setLog(std::ostream* log) { this->log = log; }
+
+    // Mean relative length of the winner in the final rung
+    double getBestScore() const { return bestScore; }
+    int getRungCount() const { return rungCount; }
+
+private:
+    std::vector<std::vector<City>> instances;
+    int configurationCount;
+    int eta;
+    double budgetSeconds;
+    int threadCount;
+    SolverMode mode;
+    unsigned seed;
+    std::ostream* log;
+    double bestScore;
+    int rungCount;
+
+    std::vector<SolverProfile> sampleConfigurations() const;
+    // Tour length of one run with `budget` annealing iterations per city
+    // (kicks are budget / 100 per city)
+    double evaluate(const SolverProfile& profile, size_t instance, int budget) const;
+    double secondsPerUnit() const;
+};
+
+#endif // PROFILE_TUNER_H
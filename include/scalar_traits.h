@@ -0,0 +1,50 @@
+#ifndef SCALAR_TRAITS_H
+#define SCALAR_TRAITS_H
+
+#include <cmath>
+#include <cstdint>
+
+// Coordinate representations the solver can be instantiated with.
+//  - double:  reference precision
+//  - float:   half the bandwidth, twice the SIMD lanes; lengths are summed in double
+//  - int32_t: scaled fixed-point coordinates with TSPLIB EUC_2D integer edges
+template<typename Scalar>
+struct ScalarTraits;
+
+template<>
+struct ScalarTraits<double> {
+    using Length = double;
+    // Accepted moves between exact recomputations of the running length
+    static constexpr int defaultResyncInterval = 100000;
+
+    static Length edge(double dx, double dy) { return std::sqrt(dx * dx + dy * dy); }
+    static double fromCoordinate(double v, double) { return v; }
+    static double toDouble(Length length, double) { return length; }
+};
+
+template<>
+struct ScalarTraits<float> {
+    using Length = double;
+    static constexpr int defaultResyncInterval = 1000;
+
+    static Length edge(float dx, float dy) { return std::sqrt(dx * dx + dy * dy); }
+    static float fromCoordinate(double v, double) { return static_cast<float>(v); }
+    static double toDouble(Length length, double) { return length; }
+};
+
+template<>
+struct ScalarTraits<std::int32_t> {
+    using Length = std::int64_t;
+    // Integer edges sum exactly, so the running length never drifts
+    static constexpr int defaultResyncInterval = 0;
+
+    // TSPLIB nint(sqrt(dx^2 + dy^2))
+    static Length edge(std::int32_t dx, std::int32_t dy) {
+        double d2 = static_cast<double>(dx) * dx + static_cast<double>(dy) * dy;
+        return static_cast<Length>(std::sqrt(d2) + 0.5);
+    }
+    static std::int32_t fromCoordinate(double v, double scale) { return static_cast<std::int32_t>(std::lround(v * scale)); }
+    static double toDouble(Length length, double scale) { return static_cast<double>(length) / scale; }
+};
+
+#endif // SCALAR_TRAITS_H
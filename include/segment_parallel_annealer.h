@@ -0,0 +1,63 @@
+#ifndef SEGMENT_PARALLEL_ANNEALER_H
+#define SEGMENT_PARALLEL_ANNEALER_H
+
+#include "tsp_solver.h"
+#include "window_annealer.h"
+#include <random>
+#include <vector>
+
+// Anneals one large tour on all cores at once.
+//
+// Every epoch the tour positions are cut into one disjoint segment per
+// thread and each thread anneals only inside its own segment (see
+// annealWindow), so no locking is needed. Between epochs the cut points
+// are rotated by half a segment, which brings the edges that crossed a
+// boundary into the interior of a segment in the next epoch.
+class SegmentParallelAnnealer {
+public:
+    SegmentParallelAnnealer();
+
+    void setCities(const std::vector<City>& cities);
+    // Starting tour; a random one is used when none (or an invalid one) is given
+    void setTour(const std::vector<int>& tour);
+    TSPSolution solve();
+    TSPSolution getCurrentSolution() const;
+    std::vector<City> getCities() const { return cities; }
+    void reset();
+
+    // Runs one epoch; returns false once the schedule is exhausted. Under
+    // 8 cities the first step solves the instance exactly and ends the run.
+    bool step();
+    int getEpoch() const { return epoch; }
+    double getTemperature() const { return temperature; }
+
+    // Parameters
+    void setThreadCount(int threads) { threadCount = threads; }
+    void setEpochs(int count) { epochs = count < 1 ? 1 : count; }
+    void setIterationsPerEpoch(long iterations) { iterationsPerEpoch = iterations; }
+    // Geometric schedule across all epochs; <= 0 derives it from the typical edge length
+    void setTemperatureRange(double start, double end) { startTemperature = start; endTemperature = end; }
+
+private:
+    std::vector<City> cities;
+    std::vector<double> xs;
+    std::vector<double> ys;
+    std::vector<int> initialTour;
+    std::vector<int> tour;
+    double tourLengthValue;
+
+    // Parameters
+    int threadCount;
+    int epochs;
+    long iterationsPerEpoch;
+    double startTemperature;
+    double endTemperature;
+
+    // State
+    int epoch;
+    double temperature;
+    double epochCooling;
+    std::mt19937 rng;
+};
+
+#endif // SEGMENT_PARALLEL_ANNEALER_H
@@ -0,0 +1,117 @@
+#ifndef SOLUTION_CACHE_H
+#define SOLUTION_CACHE_H
+
+#include "tsp_solver.h"
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Order-independent 64-bit hash of a set of cities: the sum of a mixed hash
+// of every city's exact coordinates, so any permutation of the same
+// coordinates (ids are ignored) gives the same key
+std::uint64_t instanceHash(const std::vector<City>& cities);
+
+struct SolutionCacheStats {
+    long hits;
+    long nearHits;
+    long misses;
+    long stores;
+    long evictions;
+    std::size_t entries;
+    std::size_t bytes;
+
+    SolutionCacheStats() : hits(0), nearHits(0), misses(0), stores(0), evictions(0), entries(0), bytes(0) {}
+};
+
+// Best known tours of previously solved instances.
+//
+// Entries are keyed by instanceHash and hold the tour as coordinates in
+// tour order, so a lookup works whatever order the caller lists the cities
+// in. Besides exact hits, lookup() finds near hits: stored instances whose
+// city set differs from the query in a few cities. Candidates come from a
+// bottom-k sketch of the per-city hashes (near-identical sets share most
+// of their k smallest hashes); the symmetric difference is then counted
+// exactly.
+//
+// Memory is bounded by an LRU over entry sizes. Entries are spread over
+// independently locked shards by key, so concurrent solvers rarely
+// contend. save()/load() persist the entries between runs.
+class SolutionCache {
+public:
+    enum MatchKind {
+        MATCH_NONE,
+        MATCH_EXACT,
+        MATCH_NEAR
+    };
+
+    struct Match {
+        MatchKind kind;
+        // Exact: the cached tour in the query's indices. Near: the cached
+        // tour as coordinates, with the query cities that are not in it.
+        std::vector<int> tour;
+        std::vector<City> cachedTour;
+        std::vector<int> added;
+        double length;
+
+        Match() : kind(MATCH_NONE), length(0.0) {}
+    };
+
+    explicit SolutionCache(std::size_t capacityBytes = 64 << 20, int shardCount = 16);
+
+    Match lookup(const std::vector<City>& cities);
+    // Keeps the shorter of this and any tour already stored for the instance
+    void store(const std::vector<City>& cities, const std::vector<int>& tour, double length);
+    void clear();
+
+    // Near hits differ from the query in at most this many cities
+    // (added plus removed); 0 = max(3, n / 20)
+    void setMaxDifference(int cities) { maxDifference = cities < 0 ? 0 : cities; }
+    SolutionCacheStats getStats() const;
+
+    // Both throw std::runtime_error on I/O errors or malformed input;
+    // loaded entries are added to the current ones
+    void save(const std::string& path) const;
+    void load(const std::string& path);
+
+private:
+    struct Entry {
+        std::uint64_t key;
+        // Cities in tour order
+        std::vector<City> tour;
+        double length;
+        // Sorted per-city hashes, for exact and symmetric-difference checks
+        std::vector<std::uint64_t> hashes;
+        std::vector<std::uint64_t> sketch;
+
+        std::size_t bytes() const;
+    };
+
+    struct Shard {
+        std::mutex mutex;
+        // Most recently used first
+        std::list<Entry> entries;
+        std::unordered_map<std::uint64_t, std::list<Entry>::iterator> byKey;
+        std::unordered_multimap<std::uint64_t, std::uint64_t> bySketch;
+        std::size_t bytes;
+
+        Shard() : bytes(0) {}
+    };
+
+    std::vector<std::unique_ptr<Shard>> shards;
+    std::size_t shardCapacity;
+    int maxDifference;
+
+    mutable std::mutex statsMutex;
+    SolutionCacheStats stats;
+
+    Shard& shardFor(std::uint64_t key) { return *shards[key % shards.size()]; }
+    void insert(Entry entry);
+    void evict(Shard& shard);
+};
+
+#endif // SOLUTION_CACHE_H
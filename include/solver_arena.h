@@ -0,0 +1,47 @@
+#ifndef SOLVER_ARENA_H
+#define SOLVER_ARENA_H
+
+#include <cstddef>
+#include <memory>
+
+// Bump allocator backing all of a solver's per-instance buffers.
+// The block is (re)allocated only when a layout needs more room than the
+// last one, so re-laying out the same instance never touches the heap.
+class SolverArena {
+public:
+    static constexpr std::size_t ALIGNMENT = 64;
+
+    SolverArena();
+
+    // Discards all carved buffers and makes room for at least `bytes`.
+    void reserve(std::size_t bytes);
+    // Discards all carved buffers, keeping the block.
+    void clear() { used = 0; }
+
+    // Carves an uninitialised, cache-line aligned array out of the block.
+    template<typename T>
+    T* allocate(std::size_t count) {
+        return static_cast<T*>(carve(count * sizeof(T)));
+    }
+
+    // Bytes needed to carve an array of `count` T's (including alignment padding).
+    template<typename T>
+    static std::size_t footprint(std::size_t count) {
+        return (count * sizeof(T) + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT;
+    }
+
+    std::size_t capacity() const { return size; }
+    // Number of times the backing block has been allocated
+    long blockAllocations() const { return allocations; }
+
+private:
+    std::unique_ptr<unsigned char[]> block;
+    unsigned char* base;
+    std::size_t size;
+    std::size_t used;
+    long allocations;
+
+    void* carve(std::size_t bytes);
+};
+
+#endif // SOLVER_ARENA_H
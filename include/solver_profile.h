@@ -0,0 +1,41 @@
+#ifndef SOLVER_PROFILE_H
+#define SOLVER_PROFILE_H
+
+#include <cstddef>
+#include <string>
+
+// Tuned solver parameters, as written by tsp_tune. Temperatures are given
+// relative to the instance's typical edge length so one profile carries
+// over between instances of different scale.
+struct SolverProfile {
+    double temperatureFactor;
+    double minTemperatureFactor;
+    double coolingRate;
+    int iterationsPerTemperature;
+    // Annealing budget per city (0 leaves the solver's own limit)
+    int iterationsPerCity;
+    double swapWeight;
+    double segmentWeight;
+    int neighbourCount;
+
+    SolverProfile()
+        : temperatureFactor(1.0),
+          minTemperatureFactor(1e-3),
+          coolingRate(0.9995),
+          iterationsPerTemperature(1),
+          iterationsPerCity(0),
+          swapWeight(1.0),
+          segmentWeight(1.0),
+          neighbourCount(10) {}
+};
+
+// "key = value" lines; '#' starts a comment. Throws std::runtime_error on
+// unreadable files, unknown keys or bad values.
+SolverProfile loadProfile(const std::string& path);
+void saveProfile(const std::string& path, const SolverProfile& profile, const std::string& comment = "");
+
+// sqrt(bounding box area / n), the expected edge length of a good tour up
+// to a constant, or 2 * longer side / n for thin and collinear sets
+double typicalEdgeLength(const double* xs, const double* ys, std::size_t n);
+
+#endif // SOLVER_PROFILE_H
@@ -0,0 +1,30 @@
+#ifndef SPATIAL_ORDER_H
+#define SPATIAL_ORDER_H
+
+#include <cstddef>
+#include <vector>
+
+// Space-filling curve used to renumber cities so that cities close in the
+// plane get close indices, and with them close coordinate and neighbour
+// list entries in memory.
+enum class SpatialOrder {
+    None,
+    Hilbert,
+    Morton
+};
+
+const char* spatialOrderName(SpatialOrder order);
+// Accepts "none", "hilbert" or "morton"; returns false for anything else
+bool parseSpatialOrder(const char* name, SpatialOrder& order);
+
+// City indices listed in curve order (entry k is the original index of the
+// k-th city along the curve). Coordinates are quantised to a 65536 x 65536
+// grid over the bounding square. Empty for SpatialOrder::None.
+std::vector<int> spatialOrdering(const double* xs, const double* ys, std::size_t n, SpatialOrder order);
+
+// Drops original index `original` from an ordering and shifts the original
+// indices above it down by one. Returns the renumbered index it had, which
+// is `original` itself when the ordering is empty (identity).
+int removeFromOrdering(std::vector<int>& ordering, int original);
+
+#endif // SPATIAL_ORDER_H
@@ -0,0 +1,89 @@
+#ifndef THREAD_PLACEMENT_H
+#define THREAD_PLACEMENT_H
+
+#include <mutex>
+#include <string>
+#include <vector>
+
+// How worker threads are spread over the machine: not at all, filling one
+// NUMA node before the next, or round-robin across nodes.
+enum class PlacementPolicy {
+    None,
+    Compact,
+    Scatter
+};
+
+const char* placementPolicyName(PlacementPolicy policy);
+// Accepts "none", "compact" and "scatter"; returns false for anything else
+bool parsePlacementPolicy(const char* name, PlacementPolicy& policy);
+
+// Parses a sysfs CPU list such as "0-3,8,10-11"; malformed parts are skipped
+std::vector<int> parseCpuList(const std::string& list);
+
+// CPUs and NUMA nodes as Linux reports them under sysfs
+struct CpuTopology {
+    // Usable CPUs in ascending order, and the node of each
+    std::vector<int> cpus;
+    std::vector<int> nodes;
+    int nodeCount;
+
+    CpuTopology() : nodeCount(0) {}
+
+    // Online CPUs (restricted to the process's affinity mask when
+    // allowedOnly) grouped by node; one node holding every hardware thread
+    // when sysfs is unavailable
+    static CpuTopology detect(const std::string& sysfsRoot = "/sys/devices/system", bool allowedOnly = true);
+    int nodeOf(int cpu) const;
+};
+
+// Where a worker was placed, and where it was running once pinned
+struct WorkerPlacement {
+    int worker;
+    int cpu;
+    int node;
+    int runningOn;
+    bool pinned;
+
+    WorkerPlacement() : worker(-1), cpu(-1), node(-1), runningOn(-1), pinned(false) {}
+};
+
+// Maps worker numbers to CPUs and pins threads there. A worker pinned
+// before it allocates its buffers gets them from its own node, since Linux
+// places pages on the node of the thread that first touches them.
+// Thread-safe; the placements recorded by pin() are kept for reporting.
+class ThreadPlacement {
+public:
+    ThreadPlacement();
+    ThreadPlacement(const CpuTopology& topology, PlacementPolicy policy);
+
+    // Only that node's CPUs are used (ignored for an unknown node)
+    void restrictToNode(int node);
+    PlacementPolicy getPolicy() const { return policy; }
+    const CpuTopology& getTopology() const { return topology; }
+
+    // -1 when the policy is None
+    int cpuFor(int worker) const;
+    int nodeFor(int worker) const;
+
+    // Pins the calling thread to the worker's CPU, remembering its previous
+    // affinity for release(), and records the placement; false if nothing
+    // was pinned
+    bool pin(int worker);
+    // Restores the calling thread's affinity from before its last pin()
+    static void release();
+
+    // Latest placement of every worker pinned so far, by worker number
+    std::vector<WorkerPlacement> getPlacements() const;
+
+private:
+    CpuTopology topology;
+    PlacementPolicy policy;
+    // CPUs in the order workers are assigned to them
+    std::vector<int> order;
+    mutable std::mutex mutex;
+    std::vector<WorkerPlacement> placements;
+
+    void buildOrder(int node);
+};
+
+#endif // THREAD_PLACEMENT_H
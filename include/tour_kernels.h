@@ -0,0 +1,38 @@
+#ifndef TOUR_KERNELS_H
+#define TOUR_KERNELS_H
+
+#include "scalar_traits.h"
+#include <cstddef>
+#include <cstdint>
+
+// Instruction set used by the tour kernels. The best one supported by the
+// running CPU is picked on first use; forceKernelIsa() overrides it (tests/bench).
+enum class KernelIsa {
+    Scalar,
+    Avx2,
+    Avx512
+};
+
+KernelIsa activeKernelIsa();
+void forceKernelIsa(KernelIsa isa);
+const char* kernelIsaName(KernelIsa isa);
+
+// Length of the closed tour that visits (xs[tour[k]], ys[tour[k]]) in order.
+// Instantiated for double, float and int32_t coordinates.
+template<typename Scalar>
+typename ScalarTraits<Scalar>::Length tourLength(const Scalar* xs, const Scalar* ys, const int* tour, std::size_t n);
+
+// tourLength with Neumaier-compensated summation, for checking the running
+// length of long runs. Scalar only; integer lengths are summed exactly.
+template<typename Scalar>
+typename ScalarTraits<Scalar>::Length compensatedTourLength(const Scalar* xs, const Scalar* ys, const int* tour, std::size_t n);
+
+// Scores k candidate swap moves in one pass: deltas[c] is the change in tour
+// length if the cities at positions first[c] and second[c] were exchanged.
+// Every instruction set gives the same deltas, so a seed replays the same run.
+template<typename Scalar>
+void evaluateSwapDeltas(const Scalar* xs, const Scalar* ys, const int* tour, std::size_t n,
+                        const int* first, const int* second,
+                        typename ScalarTraits<Scalar>::Length* deltas, std::size_t k);
+
+#endif // TOUR_KERNELS_H
@@ -1,10 +1,21 @@
 #ifndef TSP_SOLVER_H
 #define TSP_SOLVER_H
 
+#include <algorithm>
 #include <vector>
 #include <random>
 #include <chrono>
 #include <iostream>
+#include <cstdint>
+#include <type_traits>
+#include "exact_solver.h"
+#include "scalar_traits.h"
+#include "solver_arena.h"
+#include "solver_profile.h"
+#include "spatial_order.h"
+
+class ThreadPlacement;
+class SolutionCache;
 
 struct City {
     double x, y;
@@ -20,9 +31,26 @@ struct TSPSolution {
     TSPSolution() : distance(0.0) {}
 };
 
-class TSPSolver {
+// Outcome of the running-length checks made every resync interval: the
+// absolute difference between the incrementally updated length and a
+// compensated recomputation, just before the two are re-synchronised.
+struct PrecisionStats {
+    long checks;
+    double lastDrift;
+    double maxDrift;
+    
+    PrecisionStats() : checks(0), lastDrift(0.0), maxDrift(0.0) {}
+};
+
+// Simulated annealing solver, specialised at compile time on the scalar
+// type used for coordinates and edge lengths (see ScalarTraits). Cities are
+// always passed in and reported in double; only the internal store changes.
+template<typename Scalar>
+class BasicTSPSolver {
 public:
-    TSPSolver();
+    using Length = typename ScalarTraits<Scalar>::Length;
+    
+    BasicTSPSolver();
     
     void setCities(const std::vector<City>& cities);
     TSPSolution solve();
@@ -30,15 +58,95 @@ public:
     std::vector<City> getCities() const { return cities; }
     void reset();
     
+    // Incremental edits keep the best tour: a new city goes in at its
+    // cheapest position, a removed one is spliced out, and the run restarts
+    // as a short low-temperature re-anneal (see setWarmRestart). Cities
+    // after a removed index shift down by one.
+    void addCity(const City& city);
+    void removeCity(int index);
+    // Runs the pending re-anneal to completion and returns the best tour
+    TSPSolution reoptimise();
+    // Makes `tour` (caller indices) the current and best tour mid-run,
+    // keeping the temperature and iteration count, e.g. for a migrant from
+    // another population. Returns false, changing nothing, unless it is a
+    // permutation of the cities.
+    bool seedTour(const std::vector<int>& tour);
+    
     // Getter methods for UI
     double getTemperature() const { return temperature; }
     int getIteration() const { return iteration; }
+    double getBestDistance() const { return toDistance(bestLength); }
+    int getBestIteration() const { return bestIteration; }
     
     // Algorithm parameters
     void setInitialTemperature(double temp) { initialTemperature = temp; }
     void setCoolingRate(double rate) { coolingRate = rate; }
     void setMinTemperature(double temp) { minTemperature = temp; }
     void setMaxIterations(int iterations) { maxIterations = iterations; }
+    // Reseeds the move generator, for reproducible runs
+    void setSeed(unsigned seed) { rng.seed(seed); }
+    // Iterations spent at each temperature before it is lowered
+    void setIterationsPerTemperature(int iterations) { iterationsPerTemperature = iterations < 1 ? 1 : iterations; }
+    // Number of swap proposals scored together per step (best one is tried)
+    void setCandidatesPerStep(int count) { candidatesPerStep = count < 1 ? 1 : count; }
+    // Accepted moves between exact recomputations of the running distance
+    // (0 = never). Each one records the drift in getPrecisionStats() and,
+    // in debug builds, also checks that the tour is still a permutation.
+    void setResyncInterval(int moves) { resyncInterval = moves < 0 ? 0 : moves; }
+    const PrecisionStats& getPrecisionStats() const { return precisionStats; }
+    // Stop once the best tour is within this fraction of the Held-Karp
+    // lower bound (0 = run the full schedule). solve() computes the bound
+    // on a helper thread while annealing unless setParallelBound(false).
+    // The bound is on double Euclidean distances, so the float and
+    // fixed-point solvers, whose lengths use another metric, ignore this.
+    void setTargetGap(double gap) { targetGap = std::is_same<Scalar, double>::value && gap > 0.0 ? gap : 0.0; }
+    void setParallelBound(bool enabled) { parallelBound = enabled; }
+    // solve() returns an optimal tour straight away for up to this many
+    // cities (branch and bound, then bitmask DP; see ExactSolver), and
+    // anneals larger instances. 0 always anneals; at most EXACT_CITY_LIMIT.
+    void setExactLimit(int cities) { exactLimit = cities < 0 ? 0 : std::min(cities, EXACT_CITY_LIMIT); }
+    // Computes the bound now (also usable with step()); 0 if none could be verified
+    double computeLowerBound();
+    double getLowerBound() const { return lowerBound; }
+    // Relative gap of the best tour to the lower bound, or -1 without one
+    double getGap() const { return lowerBound > 0.0 ? getBestDistance() / lowerBound - 1.0 : -1.0; }
+    // Fixed-point only: coordinates are multiplied by this before rounding
+    // (1.0 gives TSPLIB EUC_2D distances). Takes effect on the next setCities.
+    void setCoordinateScale(double scale) { coordinateScale = scale > 0.0 ? scale : 1.0; }
+    // Renumber cities along a space-filling curve for memory locality. Only
+    // the internal store changes: tours are still reported, and cities
+    // removed, by their index in setCities order. Takes effect on the next
+    // setCities.
+    void setSpatialOrder(SpatialOrder order) { spatialOrder = order; }
+    // Moves journaled before the best tour is materialised (0 = city count)
+    void setJournalLimit(int moves) { journalLimit = moves < 0 ? 0 : moves; }
+    // Relative probabilities of a swap and of a 3-opt segment insertion
+    // (half of which insert the segment reversed)
+    void setMoveWeights(double swap, double segmentInsertion);
+    // Longest segment moved by a segment insertion
+    void setSegmentLimit(int cities) { segmentLimit = cities < 1 ? 1 : cities; }
+    // Iterations without a new best (or kick) before a double-bridge kick (0 = never)
+    void setStagnationLimit(int iterations) { stagnationLimit = iterations < 0 ? 0 : iterations; }
+    int getKickCount() const { return kickCount; }
+    // Start temperature and length of the re-anneal after an incremental
+    // edit; <= 0 uses a tenth of the mean edge length and 100 moves per city
+    void setWarmRestart(double temperature, int iterations) { warmTemperature = temperature; warmIterations = iterations; }
+    // Sets the schedule and move weights from a tuned profile, scaling its
+    // temperatures to the current cities, and resets. Call after setCities.
+    void applyProfile(const SolverProfile& profile);
+    
+    // solve() first looks the cities up in this cache: an exact hit returns
+    // the stored tour straight away, a near hit replays the difference on
+    // the stored tour (removals, then cheapest insertions) and re-anneals
+    // locally, and every annealed result is stored. nullptr disables it.
+    void setSolutionCache(SolutionCache* cache) { solutionCache = cache; }
+    
+    // Pins whichever thread calls start(), resume() or solve() to the
+    // placement's CPU for `worker`; pause() and the end of solve() undo the
+    // pin. On the first pin to a new CPU the coordinates and the arena are
+    // re-allocated from that thread, so they are first-touched on its NUMA
+    // node (reset() then reuses them). nullptr leaves threads alone.
+    void setPlacement(ThreadPlacement* placement, int worker) { this->placement = placement; placementWorker = worker; }
     
     // Control methods
     void start();
@@ -50,30 +158,135 @@ public:
     // For step-by-step execution
     bool step();
     
+    // Heap blocks taken by the solver's arena so far (steady state adds none)
+    long getArenaAllocations() const { return arena.blockAllocations(); }
+    
 private:
+    // A move on the array tour, recorded so the best tour can be rebuilt by
+    // undoing it. Swap exchanges positions first and second; the segment
+    // kinds exchange the blocks [first..second] and [second+1..third],
+    // optionally reversing the block that moves to the back.
+    enum MoveKind {
+        MOVE_SWAP,
+        MOVE_SEGMENT,
+        MOVE_SEGMENT_REVERSED
+    };
+    
+    struct MoveRecord {
+        int kind;
+        int first;
+        int second;
+        int third;
+    };
+    
     std::vector<City> cities;
-    TSPSolution currentSolution;
-    TSPSolution bestSolution;
+    // Coordinates in structure-of-arrays form for the vectorised kernels,
+    // in curve order when a spatial order is set; originalIndex maps that
+    // order back to the caller's indices (empty = identity)
+    std::vector<Scalar> xs;
+    std::vector<Scalar> ys;
+    std::vector<int> originalIndex;
+    
+    // Every per-run buffer is carved out of the arena in layoutBuffers()
+    SolverArena arena;
+    int* currentTour;
+    int* bestTour;
+    int* scratch;
+    int* candidateFirst;
+    int* candidateSecond;
+    Length* candidateDelta;
+    size_t candidateCapacity;
+    
+    // The best tour is tracked lazily: while bestMaterialised is false it is
+    // the current tour with the journaled moves undone in reverse order.
+    MoveRecord* journal;
+    size_t journalSize;
+    size_t journalCapacity;
+    bool bestMaterialised;
+    int bestIteration;
+    
+    // Running lengths in the scalar's own accumulator type
+    Length currentLength;
+    Length bestLength;
     
     // Algorithm parameters
     double initialTemperature;
     double coolingRate;
     double minTemperature;
     int maxIterations;
+    int iterationsPerTemperature;
+    int candidatesPerStep;
+    int resyncInterval;
+    double coordinateScale;
+    SpatialOrder spatialOrder;
+    int journalLimit;
+    double swapWeight;
+    double segmentWeight;
+    int segmentLimit;
+    int stagnationLimit;
+    double warmTemperature;
+    int warmIterations;
+    double targetGap;
+    bool parallelBound;
+    int exactLimit;
+    SolutionCache* solutionCache;
+    ThreadPlacement* placement;
+    int placementWorker;
+    int placedCpu;
     
     // State variables
     double temperature;
     int iteration;
     bool running;
     bool finished;
-    std::mt19937 rng;
+    int movesSinceResync;
+    PrecisionStats precisionStats;
+    double lowerBound;
+    int lastKickIteration;
+    int kickCount;
+    // After an incremental edit the run is bounded by warmBudget iterations
+    // on its own cooling schedule instead of the main one
+    bool warmRestarting;
+    int warmBudget;
+    double warmCooling;
+    mutable std::mt19937 rng;
     
     // Helper methods
-    double calculateDistance(const std::vector<int>& tour) const;
+    void layoutBuffers();
+    void pinThread();
+    void localiseBuffers();
+    void anneal();
+    bool exhausted() const;
+    TSPSolution runToCompletion();
+    TSPSolution solveExactly();
+    TSPSolution solveThroughCache();
+    void warmRestart(const std::vector<int>& tour);
+    TSPSolution makeSolution(const int* tour, Length length) const;
+    void recordAcceptedMove(const MoveRecord& move);
+    void undoJournal(int* tour) const;
+    void commitMove(const MoveRecord& move, Length delta);
+    void verifyRunningLength();
+    MoveRecord generateSegmentMove();
+    Length segmentDelta(const MoveRecord& move) const;
+    void kick();
+    static void applyMove(int* tour, const MoveRecord& move);
+    static void undoMove(int* tour, const MoveRecord& move);
+    Length edgeLength(int a, int b) const { return ScalarTraits<Scalar>::edge(xs[a] - xs[b], ys[a] - ys[b]); }
+    void materialiseBest();
+    Length calculateDistance(const int* tour) const;
+    double toDistance(Length length) const { return ScalarTraits<Scalar>::toDouble(length, coordinateScale); }
     double distance(const City& a, const City& b) const;
-    std::vector<int> generateInitialTour() const;
-    std::vector<int> generateNeighbor(const std::vector<int>& tour) const;
+    void generateInitialTour(int* tour) const;
+    int generateNeighbor();
     double acceptanceProbability(double oldDistance, double newDistance, double temperature) const;
 };
 
+extern template class BasicTSPSolver<double>;
+extern template class BasicTSPSolver<float>;
+extern template class BasicTSPSolver<std::int32_t>;
+
+using TSPSolver = BasicTSPSolver<double>;
+using TSPSolverFloat = BasicTSPSolver<float>;
+using TSPSolverFixed = BasicTSPSolver<std::int32_t>;
+
 #endif // TSP_SOLVER_H
\ No newline at end of file
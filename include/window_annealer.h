@@ -0,0 +1,28 @@
+#ifndef WINDOW_ANNEALER_H
+#define WINDOW_ANNEALER_H
+
+#include <cstddef>
+#include <random>
+
+// Annealing confined to a window of consecutive tour positions.
+//
+// The window covers positions begin, begin+1, ... begin+length-1 (mod n).
+// Only positions strictly inside it are rearranged, using 2-opt segment
+// reversals; the two end positions are read to score the edges leading
+// into the window but are never written. Windows whose interiors do not
+// overlap can therefore be annealed concurrently on the same tour.
+struct WindowAnnealParams {
+    long iterations;
+    // Geometric schedule; a value <= 0 is derived from the window's mean edge length
+    double startTemperature;
+    double endTemperature;
+
+    WindowAnnealParams() : iterations(20000), startTemperature(0.0), endTemperature(0.0) {}
+};
+
+// Returns the change in tour length (negative when the window improved).
+double annealWindow(const double* xs, const double* ys, int* tour, std::size_t n,
+                    std::size_t begin, std::size_t length,
+                    const WindowAnnealParams& params, std::mt19937& rng);
+
+#endif // WINDOW_ANNEALER_H
@@ -4,17 +4,19 @@
 
 // Constructor Definition
 SimulatedAnnealing::SimulatedAnnealing(double temp, double rate, int iter)
-    : initialTemp(temp), coolingRate(rate), iterationsPerTemp(iter), 
-      currentTemp(temp), totalIterations(0) {
+    : initialTemp(temp), coolingRate(rate), iterationsPerTemp(iter > 0 ? iter : 1), 
+      minTemp(0.1), maxIterations(0), currentTemp(temp), totalIterations(0), lastSwapFirst(0), lastSwapSecond(0) {
     unsigned seed = std::chrono::system_clock::now().time_since_epoch().count();
     generator.seed(seed);
 }
 
 // Reset Method
-void SimulatedAnnealing::reset(double temp, double rate, int iter) {
+void SimulatedAnnealing::reset(double temp, double rate, int iter, double minimum, long iterations) {
     initialTemp = temp;
     coolingRate = rate;
-    iterationsPerTemp = iter;
+    iterationsPerTemp = iter > 0 ? iter : 1;
+    minTemp = minimum;
+    maxIterations = iterations;
     currentTemp = initialTemp;
     totalIterations = 0;
 }
@@ -29,43 +31,40 @@ double SimulatedAnnealing::acceptanceProbability(double deltaEnergy, double temp
 
 // Core Execution Method (Runs one single step/iteration)
 bool SimulatedAnnealing::runOneIteration(Tour& currentTour) {
-    if (currentTemp <= 0.1 || currentTour.getTour().size() < 2) {
+    if (isFinished() || currentTour.getTour().size() < 2) {
         return false; 
     }
     
     totalIterations++;
+    double temperature = currentTemp;
+    if (totalIterations % iterationsPerTemp == 0) {
+        currentTemp *= coolingRate;
+    }
     
-    // 1. Generate Neighbor
-    Tour newTour = currentTour.createCopy();
-    
-    std::uniform_int_distribution<> cityDist(0, newTour.getTour().size() - 1);
+    // 1. Generate Neighbor (in place; undone below if rejected, so no copy is made)
+    std::uniform_int_distribution<> cityDist(0, currentTour.getTour().size() - 1);
     int index1 = cityDist(generator);
     int index2 = cityDist(generator);
     while (index1 == index2) { index2 = cityDist(generator); }
     
-    newTour.swapCities(index1, index2);
+    double oldEnergy = currentTour.getTotalDistance();
+    currentTour.swapCities(index1, index2);
 
     // 2. Calculate Energy Change (Delta E)
-    double deltaEnergy = newTour.getTotalDistance() - currentTour.getTotalDistance();
+    double deltaEnergy = currentTour.getTotalDistance() - oldEnergy;
 
     // 3. Decision (Metropolis Criterion)
     std::uniform_real_distribution<> dist(0.0, 1.0);
-    if (acceptanceProbability(deltaEnergy, currentTemp) > dist(generator)) {
-        currentTour = newTour;
+    if (acceptanceProbability(deltaEnergy, temperature) > dist(generator)) {
+        lastSwapFirst = index1;
+        lastSwapSecond = index2;
         return true;
     }
     
+    currentTour.swapCities(index1, index2);
     return false;
 }
 
-// Cooling Method
-void SimulatedAnnealing::coolTemperature() {
-    // Cool the temperature after iterationsPerTemp steps
-    if (totalIterations > 0 && totalIterations % iterationsPerTemp == 0) {
-        currentTemp *= coolingRate;
-    }
-}
-
 // Display Method Definition
 void SimulatedAnnealing::displayParameters() const {
     std::cout << "SA Parameters:" << std::endl;
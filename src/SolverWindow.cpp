@@ -1,31 +1,59 @@
 #include "SolverWindow.h"
+#include "instance_file.h"
+#include <fstream>
 #include <sstream>
 #include <iomanip>
 #include <cmath>
+#include <algorithm>
+#include <unordered_map>
 #include <SFML/System/Angle.hpp> // Required for sf::degrees
 #include <SFML/System/Vector2.hpp> // Required for sf::Vector2u and sf::Vector2f
 
 // Initialize static constants
-const float SolverWindow::VISUAL_SCALE = 1.5f;
-const float SolverWindow::OFFSET_X = 40.0f;
-const float SolverWindow::OFFSET_Y = 40.0f;
+const double SolverWindow::ZOOM_STEP = 1.25;
+const float SolverWindow::CANVAS_REBUILD_SECONDS = 0.25f;
+const float SolverWindow::OVERLAY_REFRESH_SECONDS = 0.25f;
+const double SolverWindow::WARM_TEMPERATURE_FACTOR = 0.1;
+const char* const SolverWindow::INSTANCE_FILE = "tsp_instance.tspb";
+const char* const SolverWindow::PROFILE_FILE = "tsp_profile.txt";
 
 SolverWindow::SolverWindow() 
     // SFML 3.x FIX: sf::VideoMode now takes a single sf::Vector2u argument
     : window(sf::VideoMode(sf::Vector2u(WINDOW_WIDTH, WINDOW_HEIGHT)), "TSP - Simulated Annealing Solver", sf::Style::Titlebar | sf::Style::Close),
       solver(10000.0, 0.995, 100),
+      bestDistance(0.0),
+      bestTourStale(false),
+      solverMode(SolverMode::Annealing),
+      localSearchActive(false),
+      localSearchDone(false),
+      hasProfile(false),
       isRunning(false),
       isPaused(false),
       isAddingCity(false),
       iterationCount(0),
+      viewCenterX(0.0),
+      viewCenterY(0.0),
+      viewScale(1.5),
+      isPanning(false),
+      canvasFromTour(false),
+      bestTourChanged(true),
+      canvasLayerStale(true),
       // SFML 3.x FIX: Initialize all sf::Text members with the font object to satisfy the new constructor requirement.
       startButtonText(font),
       pauseButtonText(font),
       resetButtonText(font),
+      modeButtonText(font),
       addCityButtonText(font),
-      removeCityButtonText(font)
+      removeCityButtonText(font),
+      performance(240),
+      showOverlay(false),
+      frameMoves(0),
+      frameAccepted(0)
 {
     window.setFramerateLimit(60);
+    bestJournal.reserve(BEST_JOURNAL_LIMIT + 1);
+    localSearch.setMaxKicks(2000);
+    loadProfileFile();
     
     // Load font - tries multiple locations
     // SFML 3.x FIX: loadFromFile is replaced by openFromFile for sf::Font
@@ -37,9 +65,16 @@ SolverWindow::SolverWindow()
         }
     }
     
+    if (!canvasLayer.resize(sf::Vector2u(CANVAS_WIDTH, CANVAS_HEIGHT))) {
+        std::cerr << "Warning: Could not create the canvas render texture." << std::endl;
+    }
+    
     setupButtons();
+    setupStatistics();
+    setupOverlay();
     initializeCities();
     resetSimulation();
+    fitCanvasView();
 }
 
 void SolverWindow::setupButtons() {
@@ -55,6 +90,10 @@ void SolverWindow::setupButtons() {
     resetButton = createButton(800, 160, 320, 45, sf::Color(244, 67, 54));
     resetButtonText = createText("RESET", 16, sf::Color::White, 950, 173);
     
+    // Engine Mode Button (Grey-blue, cycles SA / ILS / hybrid)
+    modeButton = createButton(800, 211, 320, 24, sf::Color(96, 125, 139));
+    modeButtonText = createText("MODE: SA", 12, sf::Color::White, 910, 215);
+    
     // Add City Button (Blue)
     addCityButton = createButton(800, 240, 320, 40, sf::Color(33, 150, 243));
     addCityButtonText = createText("ADD CITY (Click Canvas)", 14, sf::Color::White, 850, 252);
@@ -86,6 +125,96 @@ sf::Text SolverWindow::createText(const std::string& str, unsigned int size, con
     return text;
 }
 
+void SolverWindow::setupStatistics() {
+    // Panel background, title and separator
+    sf::RectangleShape panel(sf::Vector2f(PANEL_WIDTH, WINDOW_HEIGHT));
+    panel.setPosition(sf::Vector2f(CANVAS_WIDTH, 0));
+    panel.setFillColor(sf::Color(240, 240, 240));
+    panelShapes.push_back(panel);
+    
+    sf::RectangleShape separator(sf::Vector2f(320, 2));
+    separator.setPosition(sf::Vector2f(800, 85));
+    separator.setFillColor(sf::Color(200, 200, 200));
+    panelShapes.push_back(separator);
+    
+    sf::Text panelTitle = createText("Control Panel", 20, sf::Color(50, 50, 50), 820, 50);
+    panelTitle.setStyle(sf::Text::Bold);
+    panelTexts.push_back(panelTitle);
+    
+    sf::Text statsTitle = createText("Algorithm Statistics", 18, sf::Color(50, 50, 50), 820, 350);
+    statsTitle.setStyle(sf::Text::Bold);
+    panelTexts.push_back(statsTitle);
+    
+    // One box per statistic, with its label and an empty value text
+    const char* labels[STAT_COUNT] = {"Status:", "Best Distance:", "Temperature:", "Iterations:", "Cities:"};
+    const unsigned int valueSizes[STAT_COUNT] = {18, 20, 18, 18, 18};
+    float startY = 360;
+    float lineHeight = 70;
+    for (int slot = 0; slot < STAT_COUNT; ++slot) {
+        float y = startY + slot * lineHeight;
+        sf::RectangleShape box(sf::Vector2f(320, 55));
+        box.setPosition(sf::Vector2f(800, y));
+        box.setFillColor(sf::Color::White);
+        box.setOutlineThickness(2);
+        box.setOutlineColor(sf::Color(200, 200, 200));
+        panelShapes.push_back(box);
+        panelTexts.push_back(createText(labels[slot], 12, sf::Color(100, 100, 100), 810, y + 8));
+        
+        sf::Text value = createText("", valueSizes[slot], sf::Color(50, 50, 50), 810, y + (slot == STAT_DISTANCE ? 26 : 28));
+        value.setStyle(sf::Text::Bold);
+        statisticValues.push_back(value);
+    }
+    statisticStrings.assign(STAT_COUNT, std::string());
+}
+
+void SolverWindow::setupOverlay() {
+    float x = OVERLAY_X;
+    float y = OVERLAY_Y;
+    sf::RectangleShape background(sf::Vector2f(OVERLAY_WIDTH, OVERLAY_HEIGHT));
+    background.setPosition(sf::Vector2f(x, y));
+    background.setFillColor(sf::Color(255, 255, 255, 225));
+    background.setOutlineThickness(1);
+    background.setOutlineColor(sf::Color(180, 180, 180));
+    overlayShapes.push_back(background);
+    
+    sf::Text title = createText("Performance (P to hide)", 14, sf::Color(50, 50, 50), x + 10, y + 8);
+    title.setStyle(sf::Text::Bold);
+    overlayTexts.push_back(title);
+    
+    // Moves/s, acceptance, frame time and the time split, filled in by refreshOverlayValues
+    for (int line = 0; line < 4; ++line) {
+        overlayValues.push_back(createText("", 12, sf::Color(50, 50, 50), x + 10, y + 32 + line * 18));
+    }
+    
+    // Stacked bar of the frame split: solve, render, the rest
+    const sf::Color splitColors[3] = {sf::Color(76, 175, 80), sf::Color(33, 150, 243), sf::Color(200, 200, 200)};
+    for (const sf::Color& color : splitColors) {
+        sf::RectangleShape bar(sf::Vector2f(0, 10));
+        bar.setPosition(sf::Vector2f(x + 10, y + 110));
+        bar.setFillColor(color);
+        splitBars.push_back(bar);
+    }
+    
+    overlayTexts.push_back(createText("Acceptance rate", 11, sf::Color(100, 100, 100), x + 10, y + 128));
+    overlayTexts.push_back(createText("Best distance", 11, sf::Color(100, 100, 100), x + 10, y + 190));
+    overlayTexts.push_back(createText("Frame times (ms)", 11, sf::Color(100, 100, 100), x + 10, y + 252));
+    
+    // Histogram bars grow upwards from y + 302 as their counts are refreshed
+    float bucketWidth = (OVERLAY_WIDTH - 20.0f) / PerformanceMonitor::HISTOGRAM_BUCKETS;
+    for (int bucket = 0; bucket < PerformanceMonitor::HISTOGRAM_BUCKETS; ++bucket) {
+        float left = x + 10 + bucket * bucketWidth;
+        sf::RectangleShape bar(sf::Vector2f(bucketWidth - 4, 0));
+        bar.setPosition(sf::Vector2f(left, y + 302));
+        bar.setFillColor(sf::Color(255, 152, 0));
+        histogramBars.push_back(bar);
+        
+        std::string label = bucket + 1 < PerformanceMonitor::HISTOGRAM_BUCKETS
+            ? "<" + std::to_string(static_cast<int>(PerformanceMonitor::HISTOGRAM_LIMITS_MS[bucket]))
+            : std::to_string(static_cast<int>(PerformanceMonitor::HISTOGRAM_LIMITS_MS[bucket - 1])) + "+";
+        overlayTexts.push_back(createText(label, 10, sf::Color(100, 100, 100), left, y + 306));
+    }
+}
+
 void SolverWindow::initializeCities() {
     cityData.clear();
     cityData.push_back(City("A", 80, 150));
@@ -101,7 +230,20 @@ void SolverWindow::initializeCities() {
 }
 
 void SolverWindow::resetSimulation() {
-    solver.reset(10000.0, 0.995, 100);
+    if (hasProfile) {
+        // Profile temperatures are relative to the typical edge length
+        std::vector<double> xs, ys;
+        for (const City& city : cityData) {
+            xs.push_back(city.getX());
+            ys.push_back(city.getY());
+        }
+        double edge = typicalEdgeLength(xs.data(), ys.data(), xs.size());
+        long budget = profile.iterationsPerCity > 0 ? static_cast<long>(profile.iterationsPerCity) * static_cast<long>(xs.size()) : 0;
+        solver.reset(profile.temperatureFactor * edge, profile.coolingRate, profile.iterationsPerTemperature,
+                     profile.minTemperatureFactor * edge, budget);
+    } else {
+        solver.reset(10000.0, 0.995, 100);
+    }
     
     if (cityData.size() >= 2) {
         currentTour = Tour(cityData);
@@ -111,10 +253,17 @@ void SolverWindow::resetSimulation() {
         currentTour = Tour();
         bestTour = Tour();
     }
+    bestDistance = bestTour.getTotalDistance();
+    bestJournal.clear();
+    bestTourStale = false;
+    bestTourChanged = true;
+    localSearchActive = false;
+    localSearchDone = false;
     
     isRunning = false;
     isPaused = false;
     iterationCount = 0;
+    performance.clear();
     updateButtonStates();
 }
 
@@ -142,6 +291,14 @@ void SolverWindow::updateButtonStates() {
         addCityButton.setFillColor(sf::Color(33, 150, 243)); // Blue
         addCityButtonText.setString("ADD CITY (Click Canvas)");
     }
+    
+    if (solverMode == SolverMode::IteratedLocalSearch) {
+        modeButtonText.setString("MODE: ILS");
+    } else if (solverMode == SolverMode::Hybrid) {
+        modeButtonText.setString("MODE: SA -> ILS");
+    } else {
+        modeButtonText.setString("MODE: SA");
+    }
 }
 
 bool SolverWindow::isMouseOverButton(const sf::RectangleShape& button, const sf::Vector2i& mousePos) {
@@ -167,13 +324,26 @@ void SolverWindow::handleButtonClick(const sf::Vector2i& mousePos) {
     else if (isMouseOverButton(resetButton, mousePos)) {
         resetSimulation();
     }
+    else if (isMouseOverButton(modeButton, mousePos) && !isRunning) {
+        if (solverMode == SolverMode::Annealing) {
+            solverMode = SolverMode::IteratedLocalSearch;
+        } else if (solverMode == SolverMode::IteratedLocalSearch) {
+            solverMode = SolverMode::Hybrid;
+        } else {
+            solverMode = SolverMode::Annealing;
+        }
+        resetSimulation();
+    }
     else if (isMouseOverButton(addCityButton, mousePos) && !isRunning) {
         isAddingCity = !isAddingCity;
         updateButtonStates();
     }
     else if (isMouseOverButton(removeCityButton, mousePos) && !isRunning && !cityData.empty()) {
+        City removed = cityData.back();
         cityData.pop_back();
-        resetSimulation();
+        if (!applyCityEdit(removed, false)) {
+            resetSimulation();
+        }
     }
 }
 
@@ -181,20 +351,22 @@ void SolverWindow::handleCanvasClick(const sf::Vector2i& mousePos) {
     if (!isAddingCity || isRunning) return;
     
     // Check if click is within canvas bounds
-    if (mousePos.x < OFFSET_X || mousePos.x > CANVAS_WIDTH || 
-        mousePos.y < OFFSET_Y || mousePos.y > CANVAS_HEIGHT) {
+    if (mousePos.x < 0 || mousePos.x > CANVAS_WIDTH || 
+        mousePos.y < 0 || mousePos.y > CANVAS_HEIGHT) {
         return;
     }
     
     // Convert screen coordinates to city coordinates
-    double cityX = (mousePos.x - OFFSET_X) / VISUAL_SCALE;
-    double cityY = (mousePos.y - OFFSET_Y) / VISUAL_SCALE;
+    double cityX = viewCenterX + (mousePos.x - CANVAS_WIDTH / 2.0) / viewScale;
+    double cityY = viewCenterY + (mousePos.y - CANVAS_HEIGHT / 2.0) / viewScale;
     
     // Create new city
     std::string cityName = std::string(1, 'A' + static_cast<char>(cityData.size()));
     cityData.push_back(City(cityName, cityX, cityY));
     
-    resetSimulation();
+    if (!applyCityEdit(cityData.back(), true)) {
+        resetSimulation();
+    }
     isAddingCity = false;
     updateButtonStates();
 }
@@ -225,6 +397,31 @@ void SolverWindow::processEvents() {
                 } else {
                     handleCanvasClick(mousePos);
                 }
+            } else if (mouseEvent.button == sf::Mouse::Button::Right && mouseEvent.position.x <= CANVAS_WIDTH) {
+                isPanning = true;
+                panFrom = mouseEvent.position;
+            }
+        }
+        
+        // Panning and zooming the canvas
+        else if (eventOpt->is<sf::Event::MouseButtonReleased>()) {
+            if (eventOpt->getIf<sf::Event::MouseButtonReleased>()->button == sf::Mouse::Button::Right) {
+                isPanning = false;
+            }
+        }
+        else if (eventOpt->is<sf::Event::MouseMoved>()) {
+            sf::Vector2i mousePos = eventOpt->getIf<sf::Event::MouseMoved>()->position;
+            if (isPanning) {
+                viewCenterX -= (mousePos.x - panFrom.x) / viewScale;
+                viewCenterY -= (mousePos.y - panFrom.y) / viewScale;
+                panFrom = mousePos;
+                canvasLayerStale = true;
+            }
+        }
+        else if (eventOpt->is<sf::Event::MouseWheelScrolled>()) {
+            const auto& wheelEvent = *eventOpt->getIf<sf::Event::MouseWheelScrolled>();
+            if (wheelEvent.wheel == sf::Mouse::Wheel::Vertical && wheelEvent.position.x <= CANVAS_WIDTH) {
+                zoomCanvas(std::pow(ZOOM_STEP, wheelEvent.delta), wheelEvent.position);
             }
         }
         
@@ -247,35 +444,376 @@ void SolverWindow::processEvents() {
             else if (keyEvent.code == sf::Keyboard::Key::R) {
                 resetSimulation();
             }
+            else if (keyEvent.code == sf::Keyboard::Key::S) {
+                saveInstanceFile();
+            }
+            else if (keyEvent.code == sf::Keyboard::Key::L && !isRunning) {
+                loadInstanceFile();
+            }
+            else if (keyEvent.code == sf::Keyboard::Key::P) {
+                showOverlay = !showOverlay;
+            }
+            else if (keyEvent.code == sf::Keyboard::Key::Home) {
+                fitCanvasView();
+            }
+            else if (keyEvent.code == sf::Keyboard::Key::Add || keyEvent.code == sf::Keyboard::Key::Equal) {
+                zoomCanvas(ZOOM_STEP, sf::Vector2i(CANVAS_WIDTH / 2, CANVAS_HEIGHT / 2));
+            }
+            else if (keyEvent.code == sf::Keyboard::Key::Subtract || keyEvent.code == sf::Keyboard::Key::Hyphen) {
+                zoomCanvas(1.0 / ZOOM_STEP, sf::Vector2i(CANVAS_WIDTH / 2, CANVAS_HEIGHT / 2));
+            }
         }
     }
 }
 
 void SolverWindow::runAlgorithmStep() {
     const int ITERS_PER_FRAME = 10;
-    for (int i = 0; i < ITERS_PER_FRAME; ++i) {
-        solver.runOneIteration(currentTour);
+    for (int i = 0; i < ITERS_PER_FRAME && !solver.isFinished(); ++i) {
+        bool accepted = solver.runOneIteration(currentTour);
         iterationCount++;
+        frameMoves++;
+        if (!accepted) continue;
+        frameAccepted++;
         
-        if (currentTour.getTotalDistance() < bestTour.getTotalDistance()) {
-            bestTour = currentTour.createCopy();
+        if (currentTour.getTotalDistance() < bestDistance) {
+            // New best: the current tour is the best, nothing to copy yet
+            bestDistance = currentTour.getTotalDistance();
+            bestJournal.clear();
+            bestTourStale = true;
+            bestTourChanged = true;
+        } else if (bestTourStale) {
+            bestJournal.push_back(solver.getLastSwap());
+            if (bestJournal.size() > BEST_JOURNAL_LIMIT) {
+                materialiseBestTour();
+            }
         }
     }
     
-    solver.coolTemperature();
+    if (solver.isFinished()) {
+        if (solverMode == SolverMode::Hybrid) {
+            // Hand the annealed tour to the local search instead of stopping
+            startLocalSearch(true);
+        } else {
+            isRunning = false;
+            updateButtonStates();
+        }
+    }
+}
+
+// Captures the current best tour's city order and points the local search
+// at it, continuing from that order or starting over from a greedy tour.
+void SolverWindow::startLocalSearch(bool keepOrder) {
+    materialiseBestTour();
+    localSearchCities = bestTour.getTour();
     
-    if (solver.getCurrentTemperature() <= 0.1) {
-        isRunning = false;
-        updateButtonStates();
+    std::vector<double> xs, ys;
+    for (const City& city : localSearchCities) {
+        xs.push_back(city.getX());
+        ys.push_back(city.getY());
+    }
+    localSearch.setCoordinates(xs, ys);
+    if (keepOrder) {
+        std::vector<int> order(localSearchCities.size());
+        for (size_t i = 0; i < order.size(); ++i) order[i] = static_cast<int>(i);
+        localSearch.setTour(order);
+    }
+    localSearchActive = true;
+}
+
+void SolverWindow::runLocalSearchStep() {
+    const int STEPS_PER_FRAME = 20;
+    long improvingBefore = localSearch.getImprovingKicks();
+    for (int i = 0; i < STEPS_PER_FRAME; ++i) {
+        frameMoves++;
+        if (!localSearch.step()) {
+            localSearchActive = false;
+            localSearchDone = true;
+            isRunning = false;
+            updateButtonStates();
+            break;
+        }
+        iterationCount++;
+    }
+    frameAccepted += localSearch.getImprovingKicks() - improvingBefore;
+    adoptLocalSearchTour();
+}
+
+// The local search only keeps improvements, so its tour is the best one
+void SolverWindow::adoptLocalSearchTour() {
+    std::vector<City> ordered;
+    ordered.reserve(localSearchCities.size());
+    for (int index : localSearch.getTour()) ordered.push_back(localSearchCities[index]);
+    currentTour = Tour(ordered);
+    bestTour = currentTour;
+    bestDistance = bestTour.getTotalDistance();
+    bestJournal.clear();
+    bestTourStale = false;
+    bestTourChanged = true;
+}
+
+// Rebuilds bestTour from currentTour by undoing the journaled swaps, newest first.
+void SolverWindow::materialiseBestTour() {
+    if (!bestTourStale) return;
+    
+    // Copy-assignment reuses bestTour's storage instead of allocating
+    bestTour = currentTour;
+    for (auto it = bestJournal.rbegin(); it != bestJournal.rend(); ++it) {
+        bestTour.swapCities(it->first, it->second);
+    }
+    bestJournal.clear();
+    bestTourStale = false;
+}
+
+// Adds or removes one city without restarting: the best tour is edited in
+// place (cheapest insertion or splice-out) and then re-optimised locally.
+// Returns false when the tour is too small or out of step with cityData,
+// in which case the caller falls back to a full reset.
+bool SolverWindow::applyCityEdit(const City& city, bool added) {
+    materialiseBestTour();
+    size_t before = added ? cityData.size() - 1 : cityData.size() + 1;
+    if (cityData.size() < 4 || bestTour.getTour().size() != before) return false;
+    
+    bool engineInSync = (localSearchActive || localSearchDone) && localSearchCities.size() == before;
+    if (solverMode != SolverMode::Annealing && engineInSync) {
+        // The engine patches its neighbour lists and repairs only around the edit
+        if (added) {
+            localSearch.addCity(city.getX(), city.getY());
+            localSearchCities.push_back(city);
+        } else {
+            size_t index = 0;
+            while (index < localSearchCities.size() && (localSearchCities[index].getName() != city.getName() ||
+                   localSearchCities[index].getX() != city.getX() || localSearchCities[index].getY() != city.getY())) {
+                ++index;
+            }
+            if (index == localSearchCities.size()) return false;
+            localSearch.removeCity(static_cast<int>(index));
+            localSearchCities.erase(localSearchCities.begin() + index);
+        }
+        adoptLocalSearchTour();
+        return true;
+    }
+    
+    if (added) {
+        bestTour.insertCheapest(city);
+    } else if (!bestTour.removeCity(city)) {
+        return false;
+    }
+    reoptimiseAfterEdit();
+    return true;
+}
+
+// Annealing mode runs a short low-temperature re-anneal right away; the
+// local search modes descend from the edited tour and stay armed, so START
+// continues with kicks from there.
+void SolverWindow::reoptimiseAfterEdit() {
+    currentTour = bestTour;
+    bestDistance = bestTour.getTotalDistance();
+    bestJournal.clear();
+    bestTourStale = false;
+    bestTourChanged = true;
+    localSearchActive = false;
+    localSearchDone = false;
+    
+    if (solverMode == SolverMode::Annealing) {
+        // Its own schedule, as TSPSolver's warm restart: a thousandfold cooling
+        // over a budget capped so the O(n) swaps stay quick on the UI thread
+        long n = static_cast<long>(cityData.size());
+        long budget = std::max(1L, std::min(100 * n, WARM_WORK_LIMIT / std::max(n, 1L)));
+        double meanEdge = n > 0 ? bestTour.getTotalDistance() / static_cast<double>(n) : 0.0;
+        double start = std::max(WARM_TEMPERATURE_FACTOR * meanEdge, 1e-9);
+        solver.reset(start, std::pow(1e-3, 1.0 / static_cast<double>(budget)), 1, 0.0, budget);
+        while (!solver.isFinished()) {
+            runAlgorithmStep();
+        }
+        materialiseBestTour();
+        currentTour = bestTour;
+    } else {
+        startLocalSearch(true);
+        localSearch.step();
+        adoptLocalSearchTour();
+    }
+}
+
+// Writes the cities and, when it covers them all, the best tour as indices
+// into cityData.
+void SolverWindow::saveInstanceFile() {
+    materialiseBestTour();
+    InstanceData data;
+    for (const City& city : cityData) {
+        data.xs.push_back(city.getX());
+        data.ys.push_back(city.getY());
+    }
+    
+    // Cities are found by name in one hashed pass; names can repeat once
+    // cities have been added, so the coordinates still have to match
+    std::unordered_multimap<std::string, int> byName;
+    byName.reserve(cityData.size());
+    for (size_t i = 0; i < cityData.size(); ++i) byName.emplace(cityData[i].getName(), static_cast<int>(i));
+    std::vector<int> order;
+    for (const City& visited : bestTour.getTour()) {
+        auto candidates = byName.equal_range(visited.getName());
+        for (auto it = candidates.first; it != candidates.second; ++it) {
+            const City& city = cityData[it->second];
+            if (city.getX() == visited.getX() && city.getY() == visited.getY()) {
+                order.push_back(it->second);
+                break;
+            }
+        }
+    }
+    if (order.size() == cityData.size()) {
+        data.tours.push_back(order);
+        data.metadata.push_back(std::make_pair("distance", std::to_string(bestTour.getTotalDistance())));
     }
+    data.metadata.push_back(std::make_pair("iterations", std::to_string(iterationCount)));
+    
+    try {
+        saveInstance(INSTANCE_FILE, data);
+        std::cout << "Saved " << cityData.size() << " cities to " << INSTANCE_FILE << std::endl;
+    } catch (const std::exception& e) {
+        std::cerr << "Could not save instance: " << e.what() << std::endl;
+    }
+}
+
+// Replaces the cities with the file's and starts from its first tour, if any
+void SolverWindow::loadInstanceFile() {
+    InstanceData data;
+    try {
+        data = loadInstance(INSTANCE_FILE);
+    } catch (const std::exception& e) {
+        std::cerr << "Could not load instance: " << e.what() << std::endl;
+        return;
+    }
+    
+    cityData.clear();
+    for (size_t i = 0; i < data.xs.size(); ++i) {
+        // Loaded instances can have any size, so cities are numbered
+        cityData.push_back(City(std::to_string(i), data.xs[i], data.ys[i]));
+    }
+    resetSimulation();
+    
+    // The stored tour is only adopted if it visits every city exactly once
+    bool validTour = !data.tours.empty() && cityData.size() >= 2 && data.tours[0].size() == cityData.size();
+    std::vector<char> seen(cityData.size(), 0);
+    for (size_t k = 0; validTour && k < data.tours[0].size(); ++k) {
+        int index = data.tours[0][k];
+        validTour = index >= 0 && static_cast<size_t>(index) < cityData.size() && !seen[index];
+        if (validTour) seen[index] = 1;
+    }
+    if (validTour) {
+        std::vector<City> ordered;
+        for (int index : data.tours[0]) ordered.push_back(cityData[index]);
+        currentTour = Tour(ordered);
+        bestTour = currentTour;
+        bestDistance = bestTour.getTotalDistance();
+    }
+    fitCanvasView();
 }
 
 void SolverWindow::update(float deltaTime) {
-    if (isRunning && !isPaused && solver.getCurrentTemperature() > 0.1) {
+    if (!isRunning || isPaused) return;
+    
+    if (solverMode == SolverMode::IteratedLocalSearch && !localSearchActive && !localSearchDone) {
+        startLocalSearch(false);
+    }
+    if (localSearchActive) {
+        runLocalSearchStep();
+    } else if (!solver.isFinished()) {
         runAlgorithmStep();
     }
 }
 
+// Centres the cities with a margin, or shows the original fixed area
+// (coordinates 0..~470 at 1.5 pixels per unit) when there are fewer than two
+void SolverWindow::fitCanvasView() {
+    const double MARGIN = 40.0;
+    if (cityData.size() < 2) {
+        viewScale = 1.5;
+        viewCenterX = (CANVAS_WIDTH / 2.0 - MARGIN) / viewScale;
+        viewCenterY = (CANVAS_HEIGHT / 2.0 - MARGIN) / viewScale;
+    } else {
+        double minX = cityData[0].getX(), maxX = minX, minY = cityData[0].getY(), maxY = minY;
+        for (const City& city : cityData) {
+            minX = std::min(minX, city.getX());
+            maxX = std::max(maxX, city.getX());
+            minY = std::min(minY, city.getY());
+            maxY = std::max(maxY, city.getY());
+        }
+        double width = std::max(maxX - minX, 1e-9);
+        double height = std::max(maxY - minY, 1e-9);
+        viewScale = std::min((CANVAS_WIDTH - 2.0 * MARGIN) / width, (CANVAS_HEIGHT - 2.0 * MARGIN) / height);
+        viewCenterX = (minX + maxX) / 2.0;
+        viewCenterY = (minY + maxY) / 2.0;
+    }
+    canvasLayerStale = true;
+}
+
+// Scales the view by factor while keeping the point under `about` in place
+void SolverWindow::zoomCanvas(double factor, const sf::Vector2i& about) {
+    double worldX = viewCenterX + (about.x - CANVAS_WIDTH / 2.0) / viewScale;
+    double worldY = viewCenterY + (about.y - CANVAS_HEIGHT / 2.0) / viewScale;
+    viewScale = std::min(1e12, std::max(1e-12, viewScale * factor));
+    viewCenterX = worldX - (about.x - CANVAS_WIDTH / 2.0) / viewScale;
+    viewCenterY = worldY - (about.y - CANVAS_HEIGHT / 2.0) / viewScale;
+    canvasLayerStale = true;
+}
+
+sf::Vector2f SolverWindow::worldToCanvas(double x, double y) const {
+    return sf::Vector2f(static_cast<float>((x - viewCenterX) * viewScale + CANVAS_WIDTH / 2.0),
+                        static_cast<float>((y - viewCenterY) * viewScale + CANVAS_HEIGHT / 2.0));
+}
+
+CanvasRect SolverWindow::visibleRect() const {
+    double halfWidth = CANVAS_WIDTH / 2.0 / viewScale;
+    double halfHeight = CANVAS_HEIGHT / 2.0 / viewScale;
+    return CanvasRect(viewCenterX - halfWidth, viewCenterY - halfHeight, viewCenterX + halfWidth, viewCenterY + halfHeight);
+}
+
+// Re-indexes after a best-tour change and re-renders the cached layer when
+// anything it shows moved
+void SolverWindow::refreshCanvas() {
+    if (bestTourChanged) {
+        bool throttled = cityData.size() > LARGE_INSTANCE && isRunning && !isPaused &&
+                         canvasIndexClock.getElapsedTime().asSeconds() < CANVAS_REBUILD_SECONDS;
+        if (!throttled) {
+            rebuildCanvasIndex();
+            bestTourChanged = false;
+            canvasIndexClock.restart();
+            canvasLayerStale = true;
+        }
+    }
+    if (canvasLayerStale) {
+        renderCanvasLayer();
+        canvasLayerStale = false;
+    }
+}
+
+void SolverWindow::rebuildCanvasIndex() {
+    const std::vector<City>& path = bestTour.getTour();
+    canvasFromTour = path.size() >= 2 && path.size() == cityData.size();
+    const std::vector<City>& points = canvasFromTour ? path : cityData;
+    std::vector<double> xs(points.size()), ys(points.size());
+    for (size_t i = 0; i < points.size(); ++i) {
+        xs[i] = points[i].getX();
+        ys[i] = points[i].getY();
+    }
+    canvasIndex.build(xs.data(), ys.data(), points.size(), canvasFromTour);
+}
+
+void SolverWindow::renderCanvasLayer() {
+    canvasLayer.clear(sf::Color::Transparent);
+    CanvasRect view = visibleRect();
+    canvasIndex.pointsIn(view, visiblePoints);
+    canvasIndex.edgesIn(view, visibleEdges);
+    if (visiblePoints.size() <= DETAIL_LIMIT) {
+        drawTour(canvasLayer, sf::Color(76, 175, 80), 3.0f);
+        drawCities(canvasLayer);
+    } else {
+        drawTour(canvasLayer, sf::Color(76, 175, 80, 160), 1.0f);
+        drawDensity(canvasLayer);
+    }
+    canvasLayer.display();
+}
+
 void SolverWindow::drawCanvas() {
     // Draw canvas background
     sf::RectangleShape canvas(sf::Vector2f(CANVAS_WIDTH, CANVAS_HEIGHT));
@@ -286,11 +824,18 @@ void SolverWindow::drawCanvas() {
     canvas.setOutlineColor(sf::Color(200, 200, 200));
     window.draw(canvas);
     
+    // Tour and cities, as cached by refreshCanvas()
+    sf::Sprite layer(canvasLayer.getTexture());
+    window.draw(layer);
+    
     // Draw title on canvas
     sf::Text title = createText("TSP - Simulated Annealing", 24, sf::Color(50, 50, 50), 20, 10);
     title.setStyle(sf::Text::Bold);
     window.draw(title);
     
+    sf::Text hint = createText("Wheel/+/-: zoom   Right-drag: pan   Home: fit", 12, sf::Color(120, 120, 120), 20, CANVAS_HEIGHT - 22);
+    window.draw(hint);
+    
     // Draw instruction if adding city
     if (isAddingCity) {
         sf::RectangleShape instructionBox(sf::Vector2f(280, 40));
@@ -307,43 +852,51 @@ void SolverWindow::drawCanvas() {
     }
 }
 
-void SolverWindow::drawTour(const Tour& tour, const sf::Color& color, float thickness) {
-    const auto& path = tour.getTour();
-    if (path.size() < 2) return;
-    
-    // Draw lines between cities
-    for (size_t i = 0; i < path.size(); ++i) {
-        const City& current = path[i];
-        const City& next = path[(i + 1) % path.size()];
-        
-        sf::Vector2f start(current.getX() * VISUAL_SCALE + OFFSET_X, current.getY() * VISUAL_SCALE + OFFSET_Y);
-        sf::Vector2f end(next.getX() * VISUAL_SCALE + OFFSET_X, next.getY() * VISUAL_SCALE + OFFSET_Y);
+// The visible edges as one vertex array: quads of the given thickness, or
+// plain lines at one pixel, skipping edges shorter than a pixel
+void SolverWindow::drawTour(sf::RenderTarget& target, const sf::Color& color, float thickness) {
+    bool lines = thickness <= 1.0f;
+    sf::VertexArray edges(lines ? sf::PrimitiveType::Lines : sf::PrimitiveType::Triangles);
+    for (int edge : visibleEdges) {
+        int next = static_cast<size_t>(edge) + 1 == canvasIndex.size() ? 0 : edge + 1;
+        sf::Vector2f start = worldToCanvas(canvasIndex.x(edge), canvasIndex.y(edge));
+        sf::Vector2f end = worldToCanvas(canvasIndex.x(next), canvasIndex.y(next));
         
         sf::Vector2f direction = end - start;
         float length = std::sqrt(direction.x * direction.x + direction.y * direction.y);
-        float angle = std::atan2(direction.y, direction.x) * 180.0f / 3.14159f;
-        
-        sf::RectangleShape line(sf::Vector2f(length, thickness));
-        line.setFillColor(color);
-        line.setPosition(start);
-        // SFML 3.x FIX: setRotation now requires sf::Angle (or sf::degrees())
-        line.setRotation(sf::degrees(angle)); 
-        
-        window.draw(line);
+        if (lines) {
+            if (length < 1.0f) continue;
+            edges.append(sf::Vertex{start, color});
+            edges.append(sf::Vertex{end, color});
+            continue;
+        }
+        if (length <= 0.0f) continue;
+        sf::Vector2f normal(-direction.y / length * thickness / 2.0f, direction.x / length * thickness / 2.0f);
+        edges.append(sf::Vertex{start + normal, color});
+        edges.append(sf::Vertex{start - normal, color});
+        edges.append(sf::Vertex{end + normal, color});
+        edges.append(sf::Vertex{end + normal, color});
+        edges.append(sf::Vertex{start - normal, color});
+        edges.append(sf::Vertex{end - normal, color});
     }
+    target.draw(edges);
 }
 
-void SolverWindow::drawCities() {
-    for (const auto& city : cityData) {
-        float x = city.getX() * VISUAL_SCALE + OFFSET_X;
-        float y = city.getY() * VISUAL_SCALE + OFFSET_Y;
+void SolverWindow::drawCities(sf::RenderTarget& target) {
+    // Labels only while the index matches the cities it was built from
+    const std::vector<City>& points = canvasFromTour ? bestTour.getTour() : cityData;
+    bool labels = !bestTourChanged && points.size() == canvasIndex.size();
+    for (int point : visiblePoints) {
+        sf::Vector2f position = worldToCanvas(canvasIndex.x(point), canvasIndex.y(point));
+        float x = position.x;
+        float y = position.y;
         
         // Draw city circle with glow effect
         sf::CircleShape glow(10.0f);
         glow.setFillColor(sf::Color(33, 150, 243, 100));
         // SFML 3.x FIX: setPosition now requires a single sf::Vector2f argument
         glow.setPosition(sf::Vector2f(x - 10, y - 10));
-        window.draw(glow);
+        target.draw(glow);
         
         sf::CircleShape circle(7.0f);
         circle.setFillColor(sf::Color(33, 150, 243));
@@ -351,34 +904,47 @@ void SolverWindow::drawCities() {
         circle.setOutlineColor(sf::Color::White);
         // SFML 3.x FIX: setPosition now requires a single sf::Vector2f argument
         circle.setPosition(sf::Vector2f(x - 7, y - 7));
-        window.draw(circle);
+        target.draw(circle);
         
         // Draw city name
-        sf::Text nameText = createText(city.getName(), 13, sf::Color(20, 20, 20), x + 10, y - 8);
-        nameText.setStyle(sf::Text::Bold);
-        window.draw(nameText);
+        if (labels) {
+            sf::Text nameText = createText(points[point].getName(), 13, sf::Color(20, 20, 20), x + 10, y - 8);
+            nameText.setStyle(sf::Text::Bold);
+            target.draw(nameText);
+        }
     }
 }
 
-void SolverWindow::drawControlPanel() {
-    // Draw panel background
-    sf::RectangleShape panel(sf::Vector2f(PANEL_WIDTH, WINDOW_HEIGHT));
-    // SFML 3.x FIX: setPosition now requires a single sf::Vector2f argument
-    panel.setPosition(sf::Vector2f(CANVAS_WIDTH, 0));
-    panel.setFillColor(sf::Color(240, 240, 240));
-    window.draw(panel);
+// Cities per DENSITY_TILE-pixel tile, shaded on a log scale
+void SolverWindow::drawDensity(sf::RenderTarget& target) {
+    int columns = CANVAS_WIDTH / DENSITY_TILE;
+    int rows = CANVAS_HEIGHT / DENSITY_TILE;
+    canvasIndex.density(visibleRect(), columns, rows, tileCounts);
+    std::uint32_t most = *std::max_element(tileCounts.begin(), tileCounts.end());
+    double scale = std::log(1.0 + most);
     
-    // Draw panel title
-    sf::Text panelTitle = createText("Control Panel", 20, sf::Color(50, 50, 50), 820, 50);
-    panelTitle.setStyle(sf::Text::Bold);
-    window.draw(panelTitle);
-    
-    // Draw section separator
-    sf::RectangleShape separator(sf::Vector2f(320, 2));
-    // SFML 3.x FIX: setPosition now requires a single sf::Vector2f argument
-    separator.setPosition(sf::Vector2f(800, 85));
-    separator.setFillColor(sf::Color(200, 200, 200));
-    window.draw(separator);
+    sf::VertexArray tiles(sf::PrimitiveType::Triangles);
+    for (int row = 0; row < rows; ++row) {
+        for (int column = 0; column < columns; ++column) {
+            std::uint32_t count = tileCounts[static_cast<size_t>(row) * columns + column];
+            if (count == 0) continue;
+            double shade = scale > 0.0 ? std::log(1.0 + count) / scale : 1.0;
+            sf::Color color(33, 150, 243, static_cast<std::uint8_t>(70 + 185 * shade));
+            float left = static_cast<float>(column * DENSITY_TILE);
+            float top = static_cast<float>(row * DENSITY_TILE);
+            sf::Vector2f corners[4] = {sf::Vector2f(left, top), sf::Vector2f(left + DENSITY_TILE, top),
+                                       sf::Vector2f(left + DENSITY_TILE, top + DENSITY_TILE), sf::Vector2f(left, top + DENSITY_TILE)};
+            const int order[6] = {0, 1, 2, 0, 2, 3};
+            for (int corner : order) tiles.append(sf::Vertex{corners[corner], color});
+        }
+    }
+    target.draw(tiles);
+}
+
+void SolverWindow::drawControlPanel() {
+    // Background, titles, statistic boxes and labels, all built once
+    for (const sf::RectangleShape& shape : panelShapes) window.draw(shape);
+    for (const sf::Text& text : panelTexts) window.draw(text);
 }
 
 void SolverWindow::drawButton(const sf::RectangleShape& button, const sf::Text& text) {
@@ -386,34 +952,24 @@ void SolverWindow::drawButton(const sf::RectangleShape& button, const sf::Text&
     window.draw(text);
 }
 
+// Re-lays out a value text only when its string changes
+void SolverWindow::setStatistic(int slot, const std::string& value, const sf::Color& color) {
+    if (statisticStrings[slot] == value) return;
+    statisticStrings[slot] = value;
+    statisticValues[slot].setString(value);
+    statisticValues[slot].setFillColor(color);
+}
+
 void SolverWindow::drawStatistics() {
-    float startY = 360;
-    float lineHeight = 70;
-    
-    // Statistics section title
-    sf::Text statsTitle = createText("Algorithm Statistics", 18, sf::Color(50, 50, 50), 820, 350);
-    statsTitle.setStyle(sf::Text::Bold);
-    window.draw(statsTitle);
-    
-    // Status
-    sf::RectangleShape statusBox(sf::Vector2f(320, 55));
-    // SFML 3.x FIX: setPosition now requires a single sf::Vector2f argument
-    statusBox.setPosition(sf::Vector2f(800, startY));
-    statusBox.setFillColor(sf::Color::White);
-    statusBox.setOutlineThickness(2);
-    statusBox.setOutlineColor(sf::Color(200, 200, 200));
-    window.draw(statusBox);
-    
-    sf::Text statusLabel = createText("Status:", 12, sf::Color(100, 100, 100), 810, startY + 8);
-    window.draw(statusLabel);
-    
     std::string statusStr;
     sf::Color statusColor;
-    if (solver.getCurrentTemperature() <= 0.1) {
+    bool finished = localSearchDone ||
+        (solverMode == SolverMode::Annealing && solver.isFinished());
+    if (finished) {
         statusStr = "FINISHED";
         statusColor = sf::Color(76, 175, 80);
     } else if (isRunning && !isPaused) {
-        statusStr = "RUNNING";
+        statusStr = localSearchActive ? "RUNNING (LOCAL SEARCH)" : "RUNNING";
         statusColor = sf::Color(76, 175, 80);
     } else if (isPaused) {
         statusStr = "PAUSED";
@@ -422,110 +978,160 @@ void SolverWindow::drawStatistics() {
         statusStr = "READY";
         statusColor = sf::Color(100, 100, 100);
     }
-    sf::Text statusValue = createText(statusStr, 18, statusColor, 810, startY + 28);
-    statusValue.setStyle(sf::Text::Bold);
-    window.draw(statusValue);
-    
-    // Best Distance
-    startY += lineHeight;
-    sf::RectangleShape distBox(sf::Vector2f(320, 55));
-    // SFML 3.x FIX: setPosition now requires a single sf::Vector2f argument
-    distBox.setPosition(sf::Vector2f(800, startY));
-    distBox.setFillColor(sf::Color::White);
-    distBox.setOutlineThickness(2);
-    distBox.setOutlineColor(sf::Color(200, 200, 200));
-    window.draw(distBox);
-    
-    sf::Text distLabel = createText("Best Distance:", 12, sf::Color(100, 100, 100), 810, startY + 8);
-    window.draw(distLabel);
+    setStatistic(STAT_STATUS, statusStr, statusColor);
     
     std::ostringstream distStream;
     distStream << std::fixed << std::setprecision(2) << bestTour.getTotalDistance();
-    sf::Text distValue = createText(distStream.str(), 20, sf::Color(76, 175, 80), 810, startY + 26);
-    distValue.setStyle(sf::Text::Bold);
-    window.draw(distValue);
-    
-    // Temperature
-    startY += lineHeight;
-    sf::RectangleShape tempBox(sf::Vector2f(320, 55));
-    // SFML 3.x FIX: setPosition now requires a single sf::Vector2f argument
-    tempBox.setPosition(sf::Vector2f(800, startY));
-    tempBox.setFillColor(sf::Color::White);
-    tempBox.setOutlineThickness(2);
-    tempBox.setOutlineColor(sf::Color(200, 200, 200));
-    window.draw(tempBox);
-    
-    sf::Text tempLabel = createText("Temperature:", 12, sf::Color(100, 100, 100), 810, startY + 8);
-    window.draw(tempLabel);
+    setStatistic(STAT_DISTANCE, distStream.str(), sf::Color(76, 175, 80));
     
     std::ostringstream tempStream;
     tempStream << std::fixed << std::setprecision(2) << solver.getCurrentTemperature() << " °";
-    sf::Text tempValue = createText(tempStream.str(), 18, sf::Color(255, 87, 34), 810, startY + 28);
-    tempValue.setStyle(sf::Text::Bold);
-    window.draw(tempValue);
+    setStatistic(STAT_TEMPERATURE, tempStream.str(), sf::Color(255, 87, 34));
     
-    // Iterations
-    startY += lineHeight;
-    sf::RectangleShape iterBox(sf::Vector2f(320, 55));
-    // SFML 3.x FIX: setPosition now requires a single sf::Vector2f argument
-    iterBox.setPosition(sf::Vector2f(800, startY));
-    iterBox.setFillColor(sf::Color::White);
-    iterBox.setOutlineThickness(2);
-    iterBox.setOutlineColor(sf::Color(200, 200, 200));
-    window.draw(iterBox);
-    
-    sf::Text iterLabel = createText("Iterations:", 12, sf::Color(100, 100, 100), 810, startY + 8);
-    window.draw(iterLabel);
-    
-    sf::Text iterValue = createText(std::to_string(iterationCount), 18, sf::Color(33, 150, 243), 810, startY + 28);
-    iterValue.setStyle(sf::Text::Bold);
-    window.draw(iterValue);
-    
-    // City Count
-    startY += lineHeight;
-    sf::RectangleShape cityBox(sf::Vector2f(320, 55));
-    // SFML 3.x FIX: setPosition now requires a single sf::Vector2f argument
-    cityBox.setPosition(sf::Vector2f(800, startY));
-    cityBox.setFillColor(sf::Color::White);
-    cityBox.setOutlineThickness(2);
-    cityBox.setOutlineColor(sf::Color(200, 200, 200));
-    window.draw(cityBox);
+    setStatistic(STAT_ITERATIONS, std::to_string(iterationCount), sf::Color(33, 150, 243));
+    setStatistic(STAT_CITIES, std::to_string(cityData.size()), sf::Color(156, 39, 176));
+    
+    for (const sf::Text& value : statisticValues) window.draw(value);
+}
+
+void SolverWindow::refreshOverlayValues() {
+    std::ostringstream moves;
+    moves << "Moves/s: " << std::fixed << std::setprecision(0) << performance.getMovesPerSecond();
+    overlayValues[0].setString(moves.str());
+    
+    std::ostringstream acceptance;
+    acceptance << "Acceptance: " << std::fixed << std::setprecision(1) << 100.0 * performance.getAcceptanceRate() << "%";
+    overlayValues[1].setString(acceptance.str());
     
-    sf::Text cityLabel = createText("Cities:", 12, sf::Color(100, 100, 100), 810, startY + 8);
-    window.draw(cityLabel);
+    double frameMs = 1000.0 * performance.getMeanFrameSeconds();
+    std::ostringstream frame;
+    frame << "Frame: " << std::fixed << std::setprecision(1) << frameMs << " ms";
+    if (frameMs > 0.0) frame << " (" << std::setprecision(0) << 1000.0 / frameMs << " fps)";
+    overlayValues[2].setString(frame.str());
+    
+    double solveShare = performance.getSolveShare();
+    double renderShare = performance.getRenderShare();
+    double otherShare = std::max(0.0, 1.0 - solveShare - renderShare);
+    std::ostringstream split;
+    split << std::fixed << std::setprecision(0) << "Solve " << 100.0 * solveShare << "%  Render "
+          << 100.0 * renderShare << "%  Other " << 100.0 * otherShare << "%";
+    overlayValues[3].setString(split.str());
+    
+    const double shares[3] = {solveShare, renderShare, otherShare};
+    float left = OVERLAY_X + 10.0f;
+    for (int part = 0; part < 3; ++part) {
+        float width = static_cast<float>((OVERLAY_WIDTH - 20) * std::min(1.0, shares[part]));
+        splitBars[part].setSize(sf::Vector2f(width, 10));
+        splitBars[part].setPosition(sf::Vector2f(left, OVERLAY_Y + 110.0f));
+        left += width;
+    }
+    
+    performance.getFrameHistogram(histogramCounts);
+    int most = std::max(1, *std::max_element(histogramCounts.begin(), histogramCounts.end()));
+    for (int bucket = 0; bucket < PerformanceMonitor::HISTOGRAM_BUCKETS; ++bucket) {
+        float height = 30.0f * histogramCounts[bucket] / most;
+        sf::RectangleShape& bar = histogramBars[bucket];
+        bar.setSize(sf::Vector2f(bar.getSize().x, height));
+        bar.setPosition(sf::Vector2f(bar.getPosition().x, OVERLAY_Y + 302.0f - height));
+    }
+}
+
+// Per-frame acceptance rate, or best distance scaled to the window's range
+void SolverWindow::drawSparkline(bool distance, float x, float y, float width, float height, const sf::Color& color) {
+    std::size_t samples = performance.size();
+    if (samples < 2) return;
+    double low = 0.0, high = 1.0;
+    if (distance) {
+        low = high = performance.getSample(0).bestDistance;
+        for (std::size_t i = 1; i < samples; ++i) {
+            low = std::min(low, performance.getSample(i).bestDistance);
+            high = std::max(high, performance.getSample(i).bestDistance);
+        }
+    }
+    double range = std::max(high - low, 1e-9);
+    float step = width / (performance.capacity() - 1);
+    // Newest sample at the right edge
+    float left = x + width - step * (samples - 1);
     
-    sf::Text cityValue = createText(std::to_string(cityData.size()), 18, sf::Color(156, 39, 176), 810, startY + 28);
-    cityValue.setStyle(sf::Text::Bold);
-    window.draw(cityValue);
+    sf::VertexArray line(sf::PrimitiveType::LineStrip);
+    for (std::size_t i = 0; i < samples; ++i) {
+        const FrameSample& sample = performance.getSample(i);
+        double value = distance ? sample.bestDistance
+                                : (sample.moves > 0 ? static_cast<double>(sample.accepted) / sample.moves : 0.0);
+        float top = y + height - static_cast<float>(height * (value - low) / range);
+        line.append(sf::Vertex{sf::Vector2f(left + step * i, top), color});
+    }
+    window.draw(line);
+}
+
+void SolverWindow::drawOverlay() {
+    if (overlayClock.getElapsedTime().asSeconds() >= OVERLAY_REFRESH_SECONDS) {
+        refreshOverlayValues();
+        overlayClock.restart();
+    }
+    for (const sf::RectangleShape& shape : overlayShapes) window.draw(shape);
+    for (const sf::Text& text : overlayTexts) window.draw(text);
+    for (const sf::Text& value : overlayValues) window.draw(value);
+    for (const sf::RectangleShape& bar : splitBars) window.draw(bar);
+    drawSparkline(false, OVERLAY_X + 10.0f, OVERLAY_Y + 146.0f, OVERLAY_WIDTH - 20.0f, 38.0f, sf::Color(33, 150, 243));
+    drawSparkline(true, OVERLAY_X + 10.0f, OVERLAY_Y + 208.0f, OVERLAY_WIDTH - 20.0f, 38.0f, sf::Color(76, 175, 80));
+    for (const sf::RectangleShape& bar : histogramBars) window.draw(bar);
 }
 
 void SolverWindow::draw() {
     window.clear(sf::Color(245, 245, 245));
+    materialiseBestTour();
+    refreshCanvas();
     
-    // Draw canvas and tour
+    // Draw canvas with the cached tour and cities
     drawCanvas();
-    drawTour(bestTour, sf::Color(76, 175, 80), 3.0f);
-    drawCities();
+    if (showOverlay) drawOverlay();
     
     // Draw control panel
     drawControlPanel();
     drawButton(startButton, startButtonText);
     drawButton(pauseButton, pauseButtonText);
     drawButton(resetButton, resetButtonText);
+    drawButton(modeButton, modeButtonText);
     drawButton(addCityButton, addCityButtonText);
     drawButton(removeCityButton, removeCityButtonText);
     drawStatistics();
-    
-    window.display();
 }
 
 void SolverWindow::run() {
     sf::Clock clock;
+    sf::Clock phaseClock;
     while (window.isOpen()) {
         float deltaTime = clock.restart().asSeconds();
         
         processEvents();
+        FrameSample sample;
+        frameMoves = 0;
+        frameAccepted = 0;
+        phaseClock.restart();
         update(deltaTime);
+        sample.solveSeconds = phaseClock.restart().asSeconds();
         draw();
+        sample.renderSeconds = phaseClock.restart().asSeconds();
+        window.display();
+        
+        // The frame limit waits inside display(), so it counts as neither
+        sample.frameSeconds = clock.getElapsedTime().asSeconds();
+        sample.moves = frameMoves;
+        sample.accepted = frameAccepted;
+        sample.bestDistance = bestDistance;
+        performance.recordFrame(sample);
+    }
+}
+
+void SolverWindow::loadProfileFile() {
+    if (!std::ifstream(PROFILE_FILE)) return;
+    try {
+        profile = loadProfile(PROFILE_FILE);
+        hasProfile = true;
+        localSearch.setNeighbourCount(profile.neighbourCount);
+        std::cout << "Loaded solver profile " << PROFILE_FILE << std::endl;
+    } catch (const std::exception& e) {
+        std::cerr << "Ignoring " << PROFILE_FILE << ": " << e.what() << std::endl;
     }
-}
\ No newline at end of file
+}
@@ -26,11 +26,11 @@ void Tour::calculateDistance() {
     }
     
     totalDistance = 0.0;
-    for (size_t i = 0; i < tour.size(); ++i) {
-        // (i + 1) % tour.size() handles the wrap-around back to the first city
-        const City& nextCity = tour[(i + 1) % tour.size()];
-        totalDistance += tour[i].distanceTo(nextCity);
+    for (size_t i = 0; i + 1 < tour.size(); ++i) {
+        totalDistance += tour[i].distanceTo(tour[i + 1]);
     }
+    // Closing edge handles the wrap-around back to the first city
+    totalDistance += tour.back().distanceTo(tour.front());
 }
 
 // Generates a random initial tour using std::shuffle.
@@ -51,6 +51,49 @@ void Tour::swapCities(int i, int j) {
     }
 }
 
+// Cheapest insertion: the new city goes into the edge whose detour is shortest.
+void Tour::insertCheapest(const City& city) {
+    if (tour.size() < 2) {
+        tour.push_back(city);
+        calculateDistance();
+        return;
+    }
+    
+    size_t bestEdge = 0;
+    double bestCost = 0.0;
+    for (size_t i = 0; i < tour.size(); ++i) {
+        const City& from = tour[i];
+        const City& to = tour[i + 1 == tour.size() ? 0 : i + 1];
+        double cost = from.distanceTo(city) + city.distanceTo(to) - from.distanceTo(to);
+        if (i == 0 || cost < bestCost) {
+            bestCost = cost;
+            bestEdge = i;
+        }
+    }
+    tour.insert(tour.begin() + bestEdge + 1, city);
+    totalDistance += bestCost;
+}
+
+// Removes the city and joins its two tour neighbours directly.
+bool Tour::removeCity(const City& city) {
+    for (size_t i = 0; i < tour.size(); ++i) {
+        if (tour[i].getName() != city.getName() || tour[i].getX() != city.getX() || tour[i].getY() != city.getY()) {
+            continue;
+        }
+        if (tour.size() <= 3) {
+            tour.erase(tour.begin() + i);
+            calculateDistance();
+            return true;
+        }
+        const City& before = tour[i == 0 ? tour.size() - 1 : i - 1];
+        const City& after = tour[i + 1 == tour.size() ? 0 : i + 1];
+        totalDistance += before.distanceTo(after) - before.distanceTo(city) - city.distanceTo(after);
+        tour.erase(tour.begin() + i);
+        return true;
+    }
+    return false;
+}
+
 // Creates a deep copy of the tour.
 Tour Tour::createCopy() const {
     // Use the parameterized constructor to create the copy
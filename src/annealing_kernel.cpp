@@ -0,0 +1,254 @@
+#include "annealing_kernel.h"
+#include "scalar_traits.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <random>
+#include <stdexcept>
+
+namespace {
+
+template<KernelMetric Metric, typename Scalar>
+inline typename ScalarTraits<Scalar>::Length metricEdge(Scalar dx, Scalar dy) {
+    using Length = typename ScalarTraits<Scalar>::Length;
+    if constexpr (Metric == KernelMetric::Euclidean) {
+        return ScalarTraits<Scalar>::edge(dx, dy);
+    } else if constexpr (Metric == KernelMetric::Manhattan) {
+        return static_cast<Length>(std::abs(dx)) + static_cast<Length>(std::abs(dy));
+    } else {
+        return static_cast<Length>(std::max(std::abs(dx), std::abs(dy)));
+    }
+}
+
+// One instantiation per metric, scalar and move set. Position p of the
+// tour holds city ids[p] at (px[p], py[p]), so every move is made on all
+// three arrays and a delta only reads the slots around its positions.
+template<KernelMetric Metric, typename Scalar, unsigned Moves>
+KernelResult annealSpecialised(const double* xs, const double* ys, std::size_t n, const KernelSchedule& schedule) {
+    using Traits = ScalarTraits<Scalar>;
+    using Length = typename Traits::Length;
+    double scale = schedule.coordinateScale > 0.0 ? schedule.coordinateScale : 1.0;
+
+    KernelResult result;
+    std::vector<Scalar> px(n), py(n);
+    std::vector<int> ids(n);
+    for (std::size_t i = 0; i < n; ++i) {
+        px[i] = Traits::fromCoordinate(xs[i], scale);
+        py[i] = Traits::fromCoordinate(ys[i], scale);
+        ids[i] = static_cast<int>(i);
+    }
+    auto edge = [&](std::size_t a, std::size_t b) {
+        return metricEdge<Metric, Scalar>(static_cast<Scalar>(px[a] - px[b]), static_cast<Scalar>(py[a] - py[b]));
+    };
+    auto tourLength = [&]() {
+        Length total = 0;
+        for (std::size_t i = 0; i < n; ++i) total += edge(i, i + 1 == n ? 0 : i + 1);
+        return total;
+    };
+
+    Length current = tourLength();
+    Length best = current;
+    // While atBest the current tour is the best one and result.tour is stale;
+    // it is only copied when an accepted move leaves it
+    bool atBest = true;
+    std::mt19937 rng(schedule.seed);
+    const std::uint32_t count = static_cast<std::uint32_t>(n);
+    auto below = [&](std::uint32_t range) {
+        return static_cast<std::size_t>((static_cast<std::uint64_t>(rng()) * range) >> 32);
+    };
+
+    double temperature = schedule.initialTemperature;
+    double inverseTemperature = temperature > 0.0 ? 1.0 / temperature : 0.0;
+    int iterationsPerTemperature = std::max(1, schedule.iterationsPerTemperature);
+    int untilCooling = iterationsPerTemperature;
+    int sinceResync = 0;
+    long iteration = 0;
+    for (; n >= 4 && iteration < schedule.maxIterations && temperature > schedule.minTemperature; ++iteration) {
+        bool twoOpt;
+        if constexpr (Moves == KERNEL_MOVES_BOTH) {
+            twoOpt = (rng() & 1u) != 0;
+        } else {
+            twoOpt = Moves == KERNEL_MOVES_TWO_OPT;
+        }
+        std::size_t i = below(count);
+        std::size_t j = below(count - 1);
+        if (j >= i) ++j;
+        if (i > j) std::swap(i, j);
+        std::size_t beforeI = i == 0 ? n - 1 : i - 1;
+        std::size_t afterJ = j + 1 == n ? 0 : j + 1;
+
+        Length delta;
+        bool noOp = false;
+        if (twoOpt) {
+            // Reversing [i..j] replaces (i-1, i) and (j, j+1); reversing the whole
+            // tour but nothing else changes nothing
+            noOp = beforeI == j;
+            delta = noOp ? Length(0) : edge(beforeI, j) + edge(i, afterJ) - edge(beforeI, i) - edge(j, afterJ);
+        } else if (j == i + 1) {
+            delta = edge(beforeI, j) + edge(i, afterJ) - edge(beforeI, i) - edge(j, afterJ);
+        } else if (afterJ == i) {
+            // i = 0 and j = n - 1 are neighbours across the wrap
+            delta = edge(j - 1, i) + edge(j, i + 1) - edge(j - 1, j) - edge(i, i + 1);
+        } else {
+            delta = edge(beforeI, j) + edge(j, i + 1) + edge(j - 1, i) + edge(i, afterJ) -
+                    edge(beforeI, i) - edge(i, i + 1) - edge(j - 1, j) - edge(j, afterJ);
+        }
+
+        bool accept = true;
+        if (delta > 0) {
+            // Past exp(-40) the draw can never accept
+            double exponent = Traits::toDouble(delta, scale) * inverseTemperature;
+            accept = exponent < 40.0 && std::exp(-exponent) > rng() * (1.0 / 4294967296.0);
+        }
+        if (accept && !noOp) {
+            if (atBest && !(current + delta < best)) {
+                result.tour = ids;
+                atBest = false;
+            }
+            if (twoOpt) {
+                // Reverse whichever side of the cycle is shorter
+                std::size_t inside = j - i + 1;
+                std::size_t left = i, right = j, steps = inside / 2;
+                if (2 * inside > n) {
+                    left = afterJ;
+                    right = beforeI;
+                    steps = (n - inside) / 2;
+                }
+                for (std::size_t s = 0; s < steps; ++s) {
+                    std::swap(px[left], px[right]);
+                    std::swap(py[left], py[right]);
+                    std::swap(ids[left], ids[right]);
+                    left = left + 1 == n ? 0 : left + 1;
+                    right = right == 0 ? n - 1 : right - 1;
+                }
+            } else {
+                std::swap(px[i], px[j]);
+                std::swap(py[i], py[j]);
+                std::swap(ids[i], ids[j]);
+            }
+            current += delta;
+            result.accepted++;
+            if (current < best) {
+                best = current;
+                atBest = true;
+            }
+            // Reduced precision drifts; see ScalarTraits::defaultResyncInterval
+            if (Traits::defaultResyncInterval > 0 && ++sinceResync >= Traits::defaultResyncInterval) {
+                current = tourLength();
+                if (atBest) best = current;
+                sinceResync = 0;
+            }
+        }
+
+        if (--untilCooling == 0) {
+            untilCooling = iterationsPerTemperature;
+            temperature *= schedule.coolingRate;
+            inverseTemperature = 1.0 / temperature;
+        }
+    }
+    if (atBest) result.tour = ids;
+    result.iterations = iteration;
+
+    // Exact length of the best tour in the kernel's own arithmetic
+    Length total = 0;
+    for (std::size_t p = 0; p < n; ++p) {
+        int a = result.tour[p];
+        int b = result.tour[p + 1 == n ? 0 : p + 1];
+        Scalar dx = static_cast<Scalar>(Traits::fromCoordinate(xs[a], scale) - Traits::fromCoordinate(xs[b], scale));
+        Scalar dy = static_cast<Scalar>(Traits::fromCoordinate(ys[a], scale) - Traits::fromCoordinate(ys[b], scale));
+        total += metricEdge<Metric, Scalar>(dx, dy);
+    }
+    result.distance = Traits::toDouble(total, scale);
+    return result;
+}
+
+template<KernelMetric Metric, typename Scalar>
+KernelResult dispatchMoves(KernelMoves moves, const double* xs, const double* ys, std::size_t n, const KernelSchedule& schedule) {
+    switch (moves) {
+        case KERNEL_MOVES_SWAP: return annealSpecialised<Metric, Scalar, KERNEL_MOVES_SWAP>(xs, ys, n, schedule);
+        case KERNEL_MOVES_TWO_OPT: return annealSpecialised<Metric, Scalar, KERNEL_MOVES_TWO_OPT>(xs, ys, n, schedule);
+        default: return annealSpecialised<Metric, Scalar, KERNEL_MOVES_BOTH>(xs, ys, n, schedule);
+    }
+}
+
+template<KernelMetric Metric>
+KernelResult dispatchScalar(const KernelConfig& config, const double* xs, const double* ys, std::size_t n, const KernelSchedule& schedule) {
+    switch (config.scalar) {
+        case KernelScalar::Float: return dispatchMoves<Metric, float>(config.moves, xs, ys, n, schedule);
+        case KernelScalar::Fixed: return dispatchMoves<Metric, std::int32_t>(config.moves, xs, ys, n, schedule);
+        default: return dispatchMoves<Metric, double>(config.moves, xs, ys, n, schedule);
+    }
+}
+
+} // namespace
+
+const char* kernelMetricName(KernelMetric metric) {
+    switch (metric) {
+        case KernelMetric::Manhattan: return "manhattan";
+        case KernelMetric::Maximum: return "maximum";
+        default: return "euclidean";
+    }
+}
+
+const char* kernelScalarName(KernelScalar scalar) {
+    switch (scalar) {
+        case KernelScalar::Float: return "float";
+        case KernelScalar::Fixed: return "fixed";
+        default: return "double";
+    }
+}
+
+const char* kernelMovesName(KernelMoves moves) {
+    switch (moves) {
+        case KERNEL_MOVES_SWAP: return "swap";
+        case KERNEL_MOVES_TWO_OPT: return "2opt";
+        default: return "both";
+    }
+}
+
+bool parseKernelMetric(const std::string& name, KernelMetric& metric) {
+    if (name == "euclidean" || name == "EUC_2D") metric = KernelMetric::Euclidean;
+    else if (name == "manhattan" || name == "MAN_2D") metric = KernelMetric::Manhattan;
+    else if (name == "maximum" || name == "MAX_2D") metric = KernelMetric::Maximum;
+    else return false;
+    return true;
+}
+
+bool parseKernelScalar(const std::string& name, KernelScalar& scalar) {
+    if (name == "double") scalar = KernelScalar::Double;
+    else if (name == "float") scalar = KernelScalar::Float;
+    else if (name == "fixed") scalar = KernelScalar::Fixed;
+    else return false;
+    return true;
+}
+
+bool parseKernelMoves(const std::string& name, KernelMoves& moves) {
+    if (name == "swap") moves = KERNEL_MOVES_SWAP;
+    else if (name == "2opt") moves = KERNEL_MOVES_TWO_OPT;
+    else if (name == "both") moves = KERNEL_MOVES_BOTH;
+    else return false;
+    return true;
+}
+
+KernelConfig kernelConfigFromMetadata(const std::vector<std::pair<std::string, std::string>>& metadata) {
+    KernelConfig config;
+    for (const auto& entry : metadata) {
+        bool known = true;
+        if (entry.first == "metric") known = parseKernelMetric(entry.second, config.metric);
+        else if (entry.first == "precision") known = parseKernelScalar(entry.second, config.scalar);
+        else if (entry.first == "moves") known = parseKernelMoves(entry.second, config.moves);
+        if (!known) {
+            throw std::runtime_error("AnnealingKernel: unknown " + entry.first + " " + entry.second);
+        }
+    }
+    return config;
+}
+
+KernelResult runAnnealingKernel(const KernelConfig& config, const double* xs, const double* ys, std::size_t n,
+                                const KernelSchedule& schedule) {
+    switch (config.metric) {
+        case KernelMetric::Manhattan: return dispatchScalar<KernelMetric::Manhattan>(config, xs, ys, n, schedule);
+        case KernelMetric::Maximum: return dispatchScalar<KernelMetric::Maximum>(config, xs, ys, n, schedule);
+        default: return dispatchScalar<KernelMetric::Euclidean>(config, xs, ys, n, schedule);
+    }
+}
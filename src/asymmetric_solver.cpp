@@ -0,0 +1,221 @@
+#include "asymmetric_solver.h"
+#include "exact_solver.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+AsymmetricSolver::AsymmetricSolver()
+    : currentCost(0.0),
+      bestCost(0.0),
+      initialTemperature(0.0),
+      minTemperature(0.0),
+      maxIterations(1000000),
+      moveWeights{1.0, 2.0, 1.0, 1.0},
+      temperature(0.0),
+      coolingRate(1.0),
+      iteration(0),
+      rng(std::chrono::steady_clock::now().time_since_epoch().count()) {
+}
+
+void AsymmetricSolver::setCostMatrix(const CostMatrix& matrix) {
+    costs = matrix;
+    reset();
+}
+
+void AsymmetricSolver::setMoveWeights(double swap, double orOpt, double segmentInsertion, double reversal) {
+    moveWeights[0] = std::max(swap, 0.0);
+    moveWeights[1] = std::max(orOpt, 0.0);
+    moveWeights[2] = std::max(segmentInsertion, 0.0);
+    moveWeights[3] = std::max(reversal, 0.0);
+}
+
+void AsymmetricSolver::reset() {
+    size_t n = costs.size();
+    tour.resize(n);
+    for (size_t i = 0; i < n; ++i) tour[i] = static_cast<int>(i);
+    std::shuffle(tour.begin(), tour.end(), rng);
+    bestTour = tour;
+    currentCost = costs.tourCost(tour);
+    bestCost = currentCost;
+
+    buildFlips();
+
+    // Default schedule spans a tenth to a ten-thousandth of the mean arc cost
+    double meanCost = 0.0;
+    if (n > 1) {
+        double total = 0.0;
+        for (size_t a = 0; a < n; ++a) {
+            for (size_t b = 0; b < n; ++b) {
+                if (a != b) total += costs.cost(static_cast<int>(a), static_cast<int>(b));
+            }
+        }
+        meanCost = total / static_cast<double>(n * (n - 1));
+    }
+    double start = initialTemperature > 0.0 ? initialTemperature : std::max(0.1 * meanCost, 1e-9);
+    double end = minTemperature > 0.0 ? minTemperature : start * 1e-3;
+    temperature = start;
+    coolingRate = std::pow(end / start, 1.0 / static_cast<double>(std::max<long>(maxIterations, 1)));
+    iteration = 0;
+}
+
+TSPSolution AsymmetricSolver::solve() {
+    reset();
+    while (step()) {
+    }
+    return getCurrentSolution();
+}
+
+TSPSolution AsymmetricSolver::getCurrentSolution() const {
+    TSPSolution solution;
+    solution.tour = bestTour;
+    solution.distance = costs.tourCost(bestTour);
+    return solution;
+}
+
+bool AsymmetricSolver::step() {
+    size_t n = tour.size();
+    if (iteration >= maxIterations) return false;
+    if (n < 5) {
+        // Too small for the segment moves; both directions of every cycle
+        // are tried by the exact solver in one step
+        ExactSolver exact;
+        exact.setCostMatrix(costs.data(), n);
+        tour = exact.solve();
+        buildFlips();
+        currentCost = costs.tourCost(tour);
+        bestCost = currentCost;
+        bestTour = tour;
+        iteration = maxIterations;
+        return true;
+    }
+
+    double totalWeight = moveWeights[0] + moveWeights[1] + moveWeights[2] + moveWeights[3];
+    if (totalWeight <= 0.0) return false;
+    double pick = std::uniform_real_distribution<double>(0.0, totalWeight)(rng);
+    auto uniform = [&](size_t lo, size_t hi) { return std::uniform_int_distribution<size_t>(lo, hi)(rng); };
+
+    if (pick < moveWeights[0]) {
+        size_t i = uniform(0, n - 1);
+        size_t j = uniform(0, n - 2);
+        if (j >= i) ++j;
+        if (i > j) std::swap(i, j);
+        if (accept(swapDelta(i, j))) {
+            std::swap(tour[i], tour[j]);
+            refreshFlips(i, i + 1);
+            refreshFlips(j, j + 1);
+        }
+    } else if (pick < moveWeights[0] + moveWeights[1] + moveWeights[2]) {
+        // Both Or-opt and segment insertion exchange [i..j] with [j+1..k]
+        size_t i, j, k;
+        if (pick < moveWeights[0] + moveWeights[1]) {
+            size_t length = uniform(1, 3);
+            if (uniform(0, 1) == 0) {
+                // Short segment first, moved forwards past [j+1..k]
+                i = uniform(1, n - 1 - length);
+                j = i + length - 1;
+                k = uniform(j + 1, n - 1);
+            } else {
+                // Short segment second, moved backwards in front of [i..j]
+                j = uniform(1, n - 1 - length);
+                k = j + length;
+                i = uniform(1, j);
+            }
+        } else {
+            i = uniform(1, n - 2);
+            k = uniform(i + 1, n - 1);
+            j = uniform(i, k - 1);
+        }
+        if (accept(segmentExchangeDelta(i, j, k))) {
+            std::rotate(tour.begin() + i, tour.begin() + j + 1, tour.begin() + k + 1);
+            refreshFlips(i, k + 1);
+        }
+    } else {
+        size_t i = uniform(1, n - 2);
+        size_t j = uniform(i + 1, n - 1);
+        if (accept(reversalDelta(i, j))) {
+            std::reverse(tour.begin() + i, tour.begin() + j + 1);
+            refreshFlips(i, j + 1);
+        }
+    }
+
+    if (currentCost < bestCost) {
+        bestCost = currentCost;
+        bestTour = tour;
+    }
+    temperature *= coolingRate;
+    iteration++;
+    return true;
+}
+
+bool AsymmetricSolver::accept(double delta) {
+    if (delta < 0.0 || std::exp(-delta / temperature) > std::uniform_real_distribution<double>(0.0, 1.0)(rng)) {
+        currentCost += delta;
+        return true;
+    }
+    return false;
+}
+
+// Positions i < j. The (up to four) edges leaving positions i-1, i, j-1, j
+// are the only ones that change; duplicates are skipped for adjacent pairs.
+double AsymmetricSolver::swapDelta(size_t i, size_t j) const {
+    size_t n = tour.size();
+    size_t edges[4] = {(i + n - 1) % n, i, (j + n - 1) % n, j};
+    auto after = [&](size_t pos) { return pos == i ? tour[j] : pos == j ? tour[i] : tour[pos]; };
+
+    double delta = 0.0;
+    for (int e = 0; e < 4; ++e) {
+        bool repeated = false;
+        for (int f = 0; f < e; ++f) repeated = repeated || edges[f] == edges[e];
+        if (repeated) continue;
+        size_t from = edges[e];
+        size_t to = next(from);
+        delta += costs.cost(after(from), after(to)) - c(from, to);
+    }
+    return delta;
+}
+
+// 1 <= i <= j < k <= n-1: [i..j][j+1..k] becomes [j+1..k][i..j].
+double AsymmetricSolver::segmentExchangeDelta(size_t i, size_t j, size_t k) const {
+    size_t before = i - 1;
+    size_t after = next(k);
+    return c(before, j + 1) + c(k, i) + c(j, after)
+         - c(before, i) - c(j, j + 1) - c(k, after);
+}
+
+// 1 <= i < j <= n-1: reverses [i..j]. The internal edges flip direction,
+// so their cost changes by the flip costs of positions i+1..j.
+double AsymmetricSolver::reversalDelta(size_t i, size_t j) const {
+    size_t after = next(j);
+    double internal = flipPrefix(j) - flipPrefix(i);
+    return c(i - 1, j) + c(i, after) - c(i - 1, i) - c(j, after) + internal;
+}
+
+void AsymmetricSolver::buildFlips() {
+    size_t n = tour.size();
+    flipCost.assign(n, 0.0);
+    flipTree.assign(n + 1, 0.0);
+    for (size_t k = 1; k < n; ++k) {
+        flipCost[k] = c(k, k - 1) - c(k - 1, k);
+        // Linear-time build: each node passes its total on to its parent
+        flipTree[k] += flipCost[k];
+        size_t parent = k + (k & (~k + 1));
+        if (parent <= n) flipTree[parent] += flipTree[k];
+    }
+}
+
+void AsymmetricSolver::refreshFlips(size_t first, size_t last) {
+    size_t n = tour.size();
+    for (size_t k = std::max<size_t>(first, 1); k <= last && k < n; ++k) {
+        double flip = c(k, k - 1) - c(k - 1, k);
+        double change = flip - flipCost[k];
+        if (change == 0.0) continue;
+        flipCost[k] = flip;
+        for (size_t node = k; node <= n; node += node & (~node + 1)) flipTree[node] += change;
+    }
+}
+
+double AsymmetricSolver::flipPrefix(size_t k) const {
+    double total = 0.0;
+    for (size_t node = k; node > 0; node -= node & (~node + 1)) total += flipTree[node];
+    return total;
+}
@@ -0,0 +1,131 @@
+#include "canvas_index.h"
+#include <algorithm>
+#include <cmath>
+
+CanvasIndex::CanvasIndex()
+    : tour(false),
+      columns(0),
+      rows(0),
+      cellWidth(1.0),
+      cellHeight(1.0),
+      longEdge(0.0) {
+}
+
+void CanvasIndex::build(const double* xs, const double* ys, std::size_t n, bool tour) {
+    this->xs.assign(xs, xs + n);
+    this->ys.assign(ys, ys + n);
+    this->tour = tour && n >= 2;
+    longEdges.clear();
+    if (n == 0) {
+        bounds = CanvasRect();
+        columns = rows = 0;
+        cellStart.assign(1, 0);
+        cellPoints.clear();
+        return;
+    }
+
+    bounds = CanvasRect(xs[0], ys[0], xs[0], ys[0]);
+    for (std::size_t i = 1; i < n; ++i) {
+        bounds.minX = std::min(bounds.minX, xs[i]);
+        bounds.maxX = std::max(bounds.maxX, xs[i]);
+        bounds.minY = std::min(bounds.minY, ys[i]);
+        bounds.maxY = std::max(bounds.maxY, ys[i]);
+    }
+    // Square-ish cells over the bounds, about two points each
+    double width = std::max(bounds.maxX - bounds.minX, 1e-9);
+    double height = std::max(bounds.maxY - bounds.minY, 1e-9);
+    double cell = std::sqrt(width * height * 2.0 / static_cast<double>(n));
+    columns = static_cast<int>(std::min(4096.0, std::max(1.0, std::ceil(width / cell))));
+    rows = static_cast<int>(std::min(4096.0, std::max(1.0, std::ceil(height / cell))));
+    cellWidth = width / columns;
+    cellHeight = height / rows;
+
+    // Counting sort of the points into cells
+    std::vector<int> pointCell(n);
+    cellStart.assign(static_cast<std::size_t>(columns) * rows + 1, 0);
+    for (std::size_t i = 0; i < n; ++i) {
+        int cx = std::min(columns - 1, static_cast<int>((xs[i] - bounds.minX) / cellWidth));
+        int cy = std::min(rows - 1, static_cast<int>((ys[i] - bounds.minY) / cellHeight));
+        pointCell[i] = cy * columns + cx;
+        cellStart[pointCell[i] + 1]++;
+    }
+    for (std::size_t c = 1; c < cellStart.size(); ++c) cellStart[c] += cellStart[c - 1];
+    std::vector<int> fill(cellStart.begin(), cellStart.end() - 1);
+    cellPoints.resize(n);
+    for (std::size_t i = 0; i < n; ++i) cellPoints[fill[pointCell[i]]++] = static_cast<int>(i);
+
+    longEdge = 2.0 * std::max(cellWidth, cellHeight);
+    if (this->tour) {
+        double limit = longEdge * longEdge;
+        for (std::size_t i = 0; i < n; ++i) {
+            int j = next(static_cast<int>(i));
+            double dx = xs[j] - xs[i];
+            double dy = ys[j] - ys[i];
+            if (dx * dx + dy * dy > limit) longEdges.push_back(static_cast<int>(i));
+        }
+    }
+}
+
+template<typename Visit>
+void CanvasIndex::forEachPoint(const CanvasRect& view, Visit visit) const {
+    if (xs.empty() || view.maxX < bounds.minX || view.minX > bounds.maxX ||
+        view.maxY < bounds.minY || view.minY > bounds.maxY) {
+        return;
+    }
+    // Clamped before the cast, so views far outside the bounds are safe
+    auto column = [&](double x) {
+        return static_cast<int>(std::max(0.0, std::min(columns - 1.0, std::floor((x - bounds.minX) / cellWidth))));
+    };
+    auto row = [&](double y) {
+        return static_cast<int>(std::max(0.0, std::min(rows - 1.0, std::floor((y - bounds.minY) / cellHeight))));
+    };
+    int firstColumn = column(view.minX), lastColumn = column(view.maxX);
+    int firstRow = row(view.minY), lastRow = row(view.maxY);
+    for (int cy = firstRow; cy <= lastRow; ++cy) {
+        bool edgeRow = cy == firstRow || cy == lastRow;
+        for (int cx = firstColumn; cx <= lastColumn; ++cx) {
+            int cell = cy * columns + cx;
+            // Interior cells lie wholly inside the view
+            bool check = edgeRow || cx == firstColumn || cx == lastColumn;
+            for (int k = cellStart[cell]; k < cellStart[cell + 1]; ++k) {
+                int point = cellPoints[k];
+                if (!check || view.contains(xs[point], ys[point])) visit(point);
+            }
+        }
+    }
+}
+
+void CanvasIndex::pointsIn(const CanvasRect& view, std::vector<int>& points) const {
+    points.clear();
+    forEachPoint(view, [&](int point) { points.push_back(point); });
+}
+
+void CanvasIndex::edgesIn(const CanvasRect& view, std::vector<int>& edges) const {
+    edges.clear();
+    if (!tour) return;
+    // A short edge meeting the view starts within longEdge of it
+    CanvasRect near(view.minX - longEdge, view.minY - longEdge, view.maxX + longEdge, view.maxY + longEdge);
+    double limit = longEdge * longEdge;
+    forEachPoint(near, [&](int point) {
+        int j = next(point);
+        double dx = xs[j] - xs[point];
+        double dy = ys[j] - ys[point];
+        if (dx * dx + dy * dy <= limit && view.overlaps(xs[point], ys[point], xs[j], ys[j])) edges.push_back(point);
+    });
+    for (int point : longEdges) {
+        int j = next(point);
+        if (view.overlaps(xs[point], ys[point], xs[j], ys[j])) edges.push_back(point);
+    }
+}
+
+void CanvasIndex::density(const CanvasRect& view, int tileColumns, int tileRows, std::vector<std::uint32_t>& counts) const {
+    counts.assign(static_cast<std::size_t>(std::max(tileColumns, 0)) * std::max(tileRows, 0), 0);
+    if (counts.empty()) return;
+    double tileWidth = std::max(view.maxX - view.minX, 1e-12) / tileColumns;
+    double tileHeight = std::max(view.maxY - view.minY, 1e-12) / tileRows;
+    forEachPoint(view, [&](int point) {
+        int tx = std::min(tileColumns - 1, static_cast<int>((xs[point] - view.minX) / tileWidth));
+        int ty = std::min(tileRows - 1, static_cast<int>((ys[point] - view.minY) / tileHeight));
+        counts[static_cast<std::size_t>(ty) * tileColumns + tx]++;
+    });
+}
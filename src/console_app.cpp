@@ -0,0 +1,268 @@
+#include "tsp_solver.h"
+#include "ils_solver.h"
+#include "instance_file.h"
+#include "solution_cache.h"
+#include "memetic_solver.h"
+#include "annealing_kernel.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <string>
+
+namespace {
+
+void printUsage(const char* program) {
+    std::cout << "Usage: " << program << " [--mode sa|ils|hybrid|memetic] [--cities N] [--seed S] [--input FILE] [--output FILE] [--profile FILE] [--order none|hilbert|morton] [--distance-cache] [--gap G]\n"
+              << "  --mode     solver engine (default sa)\n"
+              << "  --cities   number of random cities when no input is given (default 100)\n"
+              << "  --seed     seed for the random cities (default 1)\n"
+              << "  --input    .tspb instance, or a text file with one \"x y\" pair per line\n"
+              << "  --output   write the instance, best tour and run metadata as .tspb\n"
+              << "  --profile  tuned parameters written by tsp_tune\n"
+              << "  --order    renumber cities along a space-filling curve for locality (default none)\n"
+              << "  --distance-cache  ils/hybrid: look k-NN distances up instead of recomputing them\n"
+              << "  --gap      sa: stop within this fraction of the Held-Karp lower bound (e.g. 0.02)\n"
+              << "  --cache    sa: reuse and update the tours stored in this cache file\n"
+              << "  --exact    solve instances up to this many cities optimally (default 16, max 24, 0 = never)\n"
+              << "  --crossover  memetic: eax|ox|erx (default eax)\n"
+              << "  --kernel   sa: run the specialised kernel picked from the input's metric,\n"
+              << "             precision and moves metadata (default euclidean, double, both)\n";
+}
+
+std::vector<City> loadCities(const std::string& path) {
+    std::vector<City> cities;
+    if (isInstanceFile(path)) {
+        // Coordinates are used straight from the mapping
+        MappedInstance instance(path);
+        for (size_t i = 0; i < instance.cityCount(); ++i) {
+            cities.push_back(City(instance.xs()[i], instance.ys()[i], static_cast<int>(i)));
+        }
+        return cities;
+    }
+    
+    std::ifstream in(path);
+    if (!in) {
+        throw std::runtime_error("cannot open " + path);
+    }
+    double x, y;
+    while (in >> x >> y) {
+        cities.push_back(City(x, y, static_cast<int>(cities.size())));
+    }
+    return cities;
+}
+
+std::vector<City> randomCities(int count, unsigned seed) {
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<double> coord(0.0, 1000.0);
+    std::vector<City> cities;
+    for (int i = 0; i < count; ++i) {
+        double x = coord(rng);
+        double y = coord(rng);
+        cities.push_back(City(x, y, i));
+    }
+    return cities;
+}
+
+// Geometric schedule from about the typical edge length down a thousandfold
+KernelSchedule annealingSchedule(const std::vector<City>& cities) {
+    std::vector<double> xs, ys;
+    for (const City& c : cities) {
+        xs.push_back(c.x);
+        ys.push_back(c.y);
+    }
+    double edgeScale = typicalEdgeLength(xs.data(), ys.data(), cities.size());
+    int iterations = static_cast<int>(std::min<size_t>(cities.size() * 2000, 20000000));
+    KernelSchedule schedule;
+    schedule.initialTemperature = edgeScale;
+    schedule.minTemperature = edgeScale * 1e-3;
+    schedule.coolingRate = std::pow(1e-3, 1.0 / iterations);
+    schedule.iterationsPerTemperature = 1;
+    schedule.maxIterations = iterations;
+    return schedule;
+}
+
+void configureAnnealer(TSPSolver& solver, const std::vector<City>& cities) {
+    KernelSchedule schedule = annealingSchedule(cities);
+    solver.setInitialTemperature(schedule.initialTemperature);
+    solver.setMinTemperature(schedule.minTemperature);
+    solver.setCoolingRate(schedule.coolingRate);
+    solver.setIterationsPerTemperature(schedule.iterationsPerTemperature);
+    solver.setMaxIterations(static_cast<int>(schedule.maxIterations));
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    SolverMode mode = SolverMode::Annealing;
+    int cityCount = 100;
+    unsigned seed = 1;
+    std::string input;
+    std::string output;
+    std::string profilePath;
+    SpatialOrder order = SpatialOrder::None;
+    bool distanceCache = false;
+    double targetGap = 0.0;
+    int exactLimit = 16;
+    std::string cachePath;
+    Crossover crossover = Crossover::EdgeAssembly;
+    bool useKernel = false;
+
+    for (int i = 1; i < argc; ++i) {
+        bool hasValue = i + 1 < argc;
+        if (std::strcmp(argv[i], "--mode") == 0 && hasValue) {
+            if (!parseSolverMode(argv[++i], mode)) {
+                std::cerr << "Unknown mode: " << argv[i] << std::endl;
+                return 1;
+            }
+        } else if (std::strcmp(argv[i], "--cities") == 0 && hasValue) {
+            cityCount = std::atoi(argv[++i]);
+        } else if (std::strcmp(argv[i], "--seed") == 0 && hasValue) {
+            seed = static_cast<unsigned>(std::strtoul(argv[++i], nullptr, 10));
+        } else if (std::strcmp(argv[i], "--input") == 0 && hasValue) {
+            input = argv[++i];
+        } else if (std::strcmp(argv[i], "--output") == 0 && hasValue) {
+            output = argv[++i];
+        } else if (std::strcmp(argv[i], "--profile") == 0 && hasValue) {
+            profilePath = argv[++i];
+        } else if (std::strcmp(argv[i], "--order") == 0 && hasValue) {
+            if (!parseSpatialOrder(argv[++i], order)) {
+                std::cerr << "Unknown order: " << argv[i] << std::endl;
+                return 1;
+            }
+        } else if (std::strcmp(argv[i], "--gap") == 0 && hasValue) {
+            targetGap = std::atof(argv[++i]);
+        } else if (std::strcmp(argv[i], "--distance-cache") == 0) {
+            distanceCache = true;
+        } else if (std::strcmp(argv[i], "--cache") == 0 && hasValue) {
+            cachePath = argv[++i];
+        } else if (std::strcmp(argv[i], "--exact") == 0 && hasValue) {
+            exactLimit = std::min(std::atoi(argv[++i]), EXACT_CITY_LIMIT);
+        } else if (std::strcmp(argv[i], "--kernel") == 0) {
+            useKernel = true;
+        } else if (std::strcmp(argv[i], "--crossover") == 0 && hasValue) {
+            if (!parseCrossover(argv[++i], crossover)) {
+                std::cerr << "Unknown crossover: " << argv[i] << std::endl;
+                return 1;
+            }
+        } else {
+            printUsage(argv[0]);
+            return std::strcmp(argv[i], "--help") == 0 ? 0 : 1;
+        }
+    }
+
+    try {
+        std::vector<City> cities = input.empty() ? randomCities(cityCount, seed) : loadCities(input);
+        if (cities.size() < 2) {
+            std::cerr << "Need at least 2 cities" << std::endl;
+            return 1;
+        }
+
+        auto started = std::chrono::steady_clock::now();
+        TSPSolution solution;
+        PrecisionStats precision;
+        double lowerBound = 0.0;
+        if (mode == SolverMode::Annealing && useKernel) {
+            // The instance says which instantiation to run
+            KernelConfig config;
+            if (!input.empty() && isInstanceFile(input)) {
+                config = kernelConfigFromMetadata(MappedInstance(input).allMetadata());
+            }
+            std::vector<double> xs, ys;
+            for (const City& c : cities) {
+                xs.push_back(c.x);
+                ys.push_back(c.y);
+            }
+            KernelSchedule schedule = annealingSchedule(cities);
+            schedule.seed = seed;
+            KernelResult result = runAnnealingKernel(config, xs.data(), ys.data(), xs.size(), schedule);
+            solution.tour = result.tour;
+            solution.distance = result.distance;
+            std::cout << "Kernel:   " << kernelMetricName(config.metric) << ", " << kernelScalarName(config.scalar)
+                      << ", " << kernelMovesName(config.moves) << " (" << result.accepted << " of "
+                      << result.iterations << " moves accepted)" << std::endl;
+        } else if (mode == SolverMode::Annealing) {
+            TSPSolver solver;
+            configureAnnealer(solver, cities);
+            solver.setSpatialOrder(order);
+            solver.setTargetGap(targetGap);
+            solver.setExactLimit(exactLimit);
+            solver.setCities(cities);
+            if (!profilePath.empty()) solver.applyProfile(loadProfile(profilePath));
+            SolutionCache cache;
+            if (!cachePath.empty()) {
+                if (std::ifstream(cachePath)) cache.load(cachePath);
+                solver.setSolutionCache(&cache);
+            }
+            solution = solver.solve();
+            precision = solver.getPrecisionStats();
+            lowerBound = solver.getLowerBound();
+            if (!cachePath.empty()) {
+                SolutionCacheStats stats = cache.getStats();
+                std::cout << "Cache:    " << (stats.hits ? "hit" : stats.nearHits ? "near hit" : "miss")
+                          << ", " << stats.entries << " entries" << std::endl;
+                cache.save(cachePath);
+            }
+        } else if (mode == SolverMode::Memetic) {
+            std::vector<double> xs, ys;
+            for (const City& c : cities) {
+                xs.push_back(c.x);
+                ys.push_back(c.y);
+            }
+            MemeticSolver solver;
+            solver.setCrossover(crossover);
+            solver.setSeed(seed);
+            solver.setExactLimit(exactLimit);
+            solver.setCoordinates(xs, ys);
+            while (solver.step()) {
+            }
+            solution.tour = solver.getBestTour();
+            solution.distance = solver.getBestLength();
+            std::cout << "Generations: " << solver.getGeneration() << ", " << solver.getImprovingOffspring()
+                      << " improving offspring" << std::endl;
+        } else {
+            ILSSolver solver;
+            solver.setHybrid(mode == SolverMode::Hybrid);
+            solver.setSpatialOrder(order);
+            solver.setDistanceCache(distanceCache);
+            solver.setExactLimit(exactLimit);
+            configureAnnealer(solver.getAnnealer(), cities);
+            solver.setCities(cities);
+            if (!profilePath.empty()) solver.applyProfile(loadProfile(profilePath));
+            solution = solver.solve();
+            precision = solver.getAnnealer().getPrecisionStats();
+        }
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+
+        std::cout << "Mode:     " << solverModeName(mode) << "\n"
+                  << "Cities:   " << cities.size() << "\n"
+                  << "Distance: " << solution.distance << "\n"
+                  << "Time:     " << seconds << " s" << std::endl;
+        if (lowerBound > 0.0) {
+            std::cout << "Bound:    " << lowerBound << " (gap " << 100.0 * (solution.distance / lowerBound - 1.0) << "%)" << std::endl;
+        }
+        if (precision.checks > 0) {
+            std::cout << "Drift:    " << precision.maxDrift << " max over " << precision.checks << " checks" << std::endl;
+        }
+
+        if (!output.empty()) {
+            InstanceData data;
+            for (const City& c : cities) {
+                data.xs.push_back(c.x);
+                data.ys.push_back(c.y);
+            }
+            data.tours.push_back(solution.tour);
+            data.metadata.push_back(std::make_pair("mode", std::string(solverModeName(mode))));
+            data.metadata.push_back(std::make_pair("distance", std::to_string(solution.distance)));
+            data.metadata.push_back(std::make_pair("seconds", std::to_string(seconds)));
+            saveInstance(output, data);
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
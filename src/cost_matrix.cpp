@@ -0,0 +1,96 @@
+#include "cost_matrix.h"
+#include <cctype>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+
+CostMatrix::CostMatrix() : n(0) {}
+
+CostMatrix::CostMatrix(std::size_t n) : n(n), costs(n * n, 0.0) {}
+
+CostMatrix CostMatrix::load(const std::string& path) {
+    std::ifstream in(path);
+    if (!in) {
+        throw std::runtime_error("CostMatrix: cannot open " + path);
+    }
+
+    // TSPLIB files start with "KEY: value" header lines; plain files start
+    // directly with the city count.
+    std::size_t count = 0;
+    std::string line;
+    std::streampos dataStart = in.tellg();
+    while (std::getline(in, line)) {
+        std::istringstream fields(line);
+        std::string key;
+        if (!(fields >> key)) {
+            dataStart = in.tellg();
+            continue;
+        }
+        if (std::isdigit(static_cast<unsigned char>(key[0]))) {
+            count = std::stoul(key);
+            dataStart = in.tellg();
+            break;
+        }
+        if (key.back() == ':') key.pop_back();
+        std::string value;
+        if (key == "DIMENSION") {
+            if (!(fields >> value)) throw std::runtime_error("CostMatrix: missing DIMENSION value");
+            if (value == ":" && !(fields >> value)) throw std::runtime_error("CostMatrix: missing DIMENSION value");
+            count = std::stoul(value);
+        } else if (key == "EDGE_WEIGHT_FORMAT") {
+            fields >> value;
+            if (value == ":") fields >> value;
+            if (value != "FULL_MATRIX") {
+                throw std::runtime_error("CostMatrix: unsupported EDGE_WEIGHT_FORMAT " + value);
+            }
+        } else if (key == "EDGE_WEIGHT_SECTION") {
+            dataStart = in.tellg();
+            break;
+        }
+    }
+    if (count == 0) {
+        throw std::runtime_error("CostMatrix: no city count in " + path);
+    }
+
+    in.clear();
+    in.seekg(dataStart);
+    CostMatrix matrix(count);
+    for (std::size_t k = 0; k < count * count; ++k) {
+        if (!(in >> matrix.costs[k])) {
+            throw std::runtime_error("CostMatrix: expected " + std::to_string(count * count) + " costs in " + path);
+        }
+    }
+    return matrix;
+}
+
+void CostMatrix::save(const std::string& path) const {
+    std::ofstream out(path);
+    if (!out) {
+        throw std::runtime_error("CostMatrix: cannot write " + path);
+    }
+    out.precision(17);
+    out << n << "\n";
+    for (std::size_t from = 0; from < n; ++from) {
+        for (std::size_t to = 0; to < n; ++to) {
+            out << costs[from * n + to] << (to + 1 < n ? ' ' : '\n');
+        }
+    }
+}
+
+double CostMatrix::tourCost(const std::vector<int>& tour) const {
+    if (tour.size() < 2) return 0.0;
+    double total = 0.0;
+    for (std::size_t k = 0; k + 1 < tour.size(); ++k) {
+        total += cost(tour[k], tour[k + 1]);
+    }
+    return total + cost(tour.back(), tour.front());
+}
+
+bool CostMatrix::isSymmetric() const {
+    for (std::size_t a = 0; a < n; ++a) {
+        for (std::size_t b = a + 1; b < n; ++b) {
+            if (costs[a * n + b] != costs[b * n + a]) return false;
+        }
+    }
+    return true;
+}
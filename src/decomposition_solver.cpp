@@ -0,0 +1,265 @@
+#include "decomposition_solver.h"
+#include "tour_kernels.h"
+#include "parallel_for.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <limits>
+#include <utility>
+
+namespace {
+
+inline double edge(const std::vector<double>& xs, const std::vector<double>& ys, int a, int b) {
+    double dx = xs[a] - xs[b];
+    double dy = ys[a] - ys[b];
+    return std::sqrt(dx * dx + dy * dy);
+}
+
+// Anneals a small instance with a geometric schedule spread over `iterations`
+// steps, starting near the typical edge length of the point set.
+TSPSolution annealCities(const std::vector<City>& local, int iterations) {
+    std::vector<double> xs, ys;
+    for (const City& c : local) {
+        xs.push_back(c.x);
+        ys.push_back(c.y);
+    }
+    double edgeScale = typicalEdgeLength(xs.data(), ys.data(), local.size());
+
+    TSPSolver solver;
+    solver.setInitialTemperature(edgeScale);
+    solver.setMinTemperature(edgeScale * 1e-3);
+    solver.setCoolingRate(std::pow(1e-3, 1.0 / std::max(iterations, 1)));
+    solver.setMaxIterations(iterations);
+    solver.setCities(local);
+    return solver.solve();
+}
+
+} // namespace
+
+DecompositionSolver::DecompositionSolver()
+    : clusterSize(200),
+      threadCount(0),
+      clusterIterations(200000),
+      refinementWindow(64) {
+}
+
+void DecompositionSolver::setCities(const std::vector<City>& cities) {
+    this->cities = cities;
+    xs.resize(cities.size());
+    ys.resize(cities.size());
+    for (size_t i = 0; i < cities.size(); ++i) {
+        xs[i] = cities[i].x;
+        ys[i] = cities[i].y;
+    }
+    clusters.clear();
+    clusterOf.assign(cities.size(), 0);
+    solution = TSPSolution();
+}
+
+int DecompositionSolver::workerCount() const {
+    return resolveWorkerCount(threadCount);
+}
+
+TSPSolution DecompositionSolver::solve() {
+    size_t n = cities.size();
+    if (n < 2) {
+        solution = TSPSolution();
+        if (n == 1) solution.tour.push_back(0);
+        return solution;
+    }
+
+    partition();
+
+    std::vector<std::vector<int>> clusterTours(clusters.size());
+    solveClusters(clusterTours);
+
+    std::vector<size_t> junctions;
+    std::vector<int> tour = stitch(clusterTours, orderClusters(), junctions);
+    refineJunctions(tour, junctions);
+
+    solution.tour = tour;
+    solution.distance = tourLength(xs.data(), ys.data(), tour.data(), n);
+    return solution;
+}
+
+// k-d tree median cuts along the wider axis until every leaf fits in a
+// cluster. Leaves come out in depth-first order, so neighbouring clusters
+// are usually spatial neighbours as well.
+void DecompositionSolver::partition() {
+    clusters.clear();
+    std::vector<int> order(cities.size());
+    for (size_t i = 0; i < order.size(); ++i) order[i] = static_cast<int>(i);
+
+    std::vector<std::pair<size_t, size_t>> stack;
+    stack.push_back(std::make_pair(size_t(0), order.size()));
+    while (!stack.empty()) {
+        size_t lo = stack.back().first;
+        size_t hi = stack.back().second;
+        stack.pop_back();
+
+        if (hi - lo <= static_cast<size_t>(clusterSize)) {
+            clusters.push_back(std::vector<int>(order.begin() + lo, order.begin() + hi));
+            continue;
+        }
+
+        double minX = std::numeric_limits<double>::max(), maxX = -minX;
+        double minY = minX, maxY = -minX;
+        for (size_t k = lo; k < hi; ++k) {
+            minX = std::min(minX, xs[order[k]]);
+            maxX = std::max(maxX, xs[order[k]]);
+            minY = std::min(minY, ys[order[k]]);
+            maxY = std::max(maxY, ys[order[k]]);
+        }
+        const std::vector<double>& axis = (maxX - minX >= maxY - minY) ? xs : ys;
+        size_t mid = lo + (hi - lo) / 2;
+        std::nth_element(order.begin() + lo, order.begin() + mid, order.begin() + hi,
+                         [&](int a, int b) { return axis[a] < axis[b]; });
+
+        // Right half pushed first so the left half is emitted first
+        stack.push_back(std::make_pair(mid, hi));
+        stack.push_back(std::make_pair(lo, mid));
+    }
+
+    for (size_t c = 0; c < clusters.size(); ++c) {
+        for (int city : clusters[c]) clusterOf[city] = static_cast<int>(c);
+    }
+}
+
+void DecompositionSolver::solveClusters(std::vector<std::vector<int>>& clusterTours) const {
+    parallelFor(clusters.size(), workerCount(), [&](size_t c) {
+        const std::vector<int>& members = clusters[c];
+        if (members.size() < 4) {
+            clusterTours[c] = members;
+            return;
+        }
+
+        std::vector<City> local;
+        local.reserve(members.size());
+        for (size_t k = 0; k < members.size(); ++k) {
+            local.push_back(City(xs[members[k]], ys[members[k]], static_cast<int>(k)));
+        }
+        TSPSolution result = annealCities(local, clusterIterations);
+
+        clusterTours[c].resize(members.size());
+        for (size_t k = 0; k < result.tour.size(); ++k) {
+            clusterTours[c][k] = members[result.tour[k]];
+        }
+    });
+}
+
+// Tour over the cluster centroids. The k-d leaf order is kept unless
+// annealing the centroids finds a shorter cycle.
+std::vector<int> DecompositionSolver::orderClusters() const {
+    size_t count = clusters.size();
+    std::vector<int> leafOrder(count);
+    for (size_t c = 0; c < count; ++c) leafOrder[c] = static_cast<int>(c);
+    if (count < 4) return leafOrder;
+
+    std::vector<City> centroids;
+    std::vector<double> cx(count), cy(count);
+    for (size_t c = 0; c < count; ++c) {
+        for (int city : clusters[c]) {
+            cx[c] += xs[city];
+            cy[c] += ys[city];
+        }
+        cx[c] /= static_cast<double>(clusters[c].size());
+        cy[c] /= static_cast<double>(clusters[c].size());
+        centroids.push_back(City(cx[c], cy[c], static_cast<int>(c)));
+    }
+
+    TSPSolution annealed = annealCities(centroids, static_cast<int>(std::min<size_t>(count * 500, 2000000)));
+    double leafLength = tourLength(cx.data(), cy.data(), leafOrder.data(), count);
+    return annealed.distance < leafLength ? annealed.tour : leafOrder;
+}
+
+// Concatenates the cluster cycles in `order`. Each cycle is opened at the
+// edge (and walked in the direction) that best connects the previous
+// cluster's exit to the next cluster's centroid.
+std::vector<int> DecompositionSolver::stitch(const std::vector<std::vector<int>>& clusterTours,
+                                             const std::vector<int>& order,
+                                             std::vector<size_t>& junctions) const {
+    size_t count = order.size();
+    std::vector<double> cx(count), cy(count);
+    for (size_t c = 0; c < count; ++c) {
+        for (int city : clusters[c]) {
+            cx[c] += xs[city];
+            cy[c] += ys[city];
+        }
+        cx[c] /= static_cast<double>(clusters[c].size());
+        cy[c] /= static_cast<double>(clusters[c].size());
+    }
+    auto toPoint = [&](int city, double px, double py) {
+        return std::sqrt((xs[city] - px) * (xs[city] - px) + (ys[city] - py) * (ys[city] - py));
+    };
+
+    std::vector<int> tour;
+    tour.reserve(cities.size());
+    junctions.clear();
+
+    for (size_t k = 0; k < count; ++k) {
+        const std::vector<int>& cycle = clusterTours[order[k]];
+        size_t m = cycle.size();
+        int nextCluster = order[(k + 1) % count];
+        int prevCluster = order[(k + count - 1) % count];
+        junctions.push_back(tour.size());
+
+        if (m == 1) {
+            tour.push_back(cycle[0]);
+            continue;
+        }
+
+        double bestCost = std::numeric_limits<double>::max();
+        size_t bestBreak = 0;
+        bool bestReversed = false;
+        for (size_t b = 0; b < m; ++b) {
+            int u = cycle[b];
+            int v = cycle[(b + 1) % m];
+            double opened = -edge(xs, ys, u, v);
+            auto entry = [&](int city) {
+                return tour.empty() ? toPoint(city, cx[prevCluster], cy[prevCluster])
+                                    : edge(xs, ys, tour.back(), city);
+            };
+            // Forward: v ... u, reversed: u ... v
+            double forward = opened + entry(v) + toPoint(u, cx[nextCluster], cy[nextCluster]);
+            double reversed = opened + entry(u) + toPoint(v, cx[nextCluster], cy[nextCluster]);
+            if (forward < bestCost) {
+                bestCost = forward;
+                bestBreak = b;
+                bestReversed = false;
+            }
+            if (reversed < bestCost) {
+                bestCost = reversed;
+                bestBreak = b;
+                bestReversed = true;
+            }
+        }
+
+        for (size_t s = 0; s < m; ++s) {
+            size_t index = bestReversed ? (bestBreak + m - s) % m : (bestBreak + 1 + s) % m;
+            tour.push_back(cycle[index]);
+        }
+    }
+    return tour;
+}
+
+// Windows are centred on the junctions and sized so that no two interiors
+// overlap, which lets every window be annealed concurrently on the shared tour.
+void DecompositionSolver::refineJunctions(std::vector<int>& tour, const std::vector<size_t>& junctions) const {
+    size_t n = tour.size();
+    if (junctions.size() < 2 || refinementWindow < 4) return;
+
+    size_t minSpacing = n;
+    for (size_t k = 0; k < junctions.size(); ++k) {
+        size_t next = k + 1 < junctions.size() ? junctions[k + 1] : junctions[0] + n;
+        minSpacing = std::min(minSpacing, next - junctions[k]);
+    }
+    size_t window = std::min(static_cast<size_t>(refinementWindow), minSpacing);
+    if (window < 4) return;
+
+    unsigned seed = static_cast<unsigned>(std::chrono::steady_clock::now().time_since_epoch().count());
+    parallelFor(junctions.size(), workerCount(), [&](size_t k) {
+        std::mt19937 rng(seed + static_cast<unsigned>(k));
+        size_t begin = (junctions[k] + n - window / 2) % n;
+        annealWindow(xs.data(), ys.data(), tour.data(), n, begin, window, refinementParams, rng);
+    });
+}
@@ -0,0 +1,59 @@
+#include "distance_cache.h"
+
+DistanceCache::DistanceCache()
+    : hits(0),
+      misses(0) {
+}
+
+void DistanceCache::clear() {
+    xs.clear();
+    ys.clear();
+    rowStart.clear();
+    columns.clear();
+    values.clear();
+    hits = 0;
+    misses = 0;
+}
+
+void DistanceCache::build(const double* xs, const double* ys, std::size_t n, const NeighbourLists& lists) {
+    clear();
+    this->xs.assign(xs, xs + n);
+    this->ys.assign(ys, ys + n);
+    int k = lists.k;
+    std::size_t rowLimit = static_cast<std::size_t>(2 * k);
+
+    // Reverse edges: who lists each city, counted first so the rows can be
+    // laid out in one pass
+    std::vector<std::size_t> reverseStart(n + 1, 0);
+    for (std::size_t a = 0; a < n; ++a) {
+        for (int j = 0; j < k; ++j) ++reverseStart[lists.of(static_cast<int>(a))[j] + 1];
+    }
+    for (std::size_t a = 0; a < n; ++a) reverseStart[a + 1] += reverseStart[a];
+    std::vector<int> listedBy(reverseStart[n]);
+    std::vector<std::size_t> fill(reverseStart.begin(), reverseStart.end() - 1);
+    for (std::size_t a = 0; a < n; ++a) {
+        for (int j = 0; j < k; ++j) listedBy[fill[lists.of(static_cast<int>(a))[j]]++] = static_cast<int>(a);
+    }
+
+    rowStart.reserve(n + 1);
+    columns.reserve(n * rowLimit);
+    rowStart.push_back(0);
+    for (std::size_t a = 0; a < n; ++a) {
+        const int* near = lists.of(static_cast<int>(a));
+        columns.insert(columns.end(), near, near + k);
+        // Mutual neighbours are already in the row
+        for (std::size_t r = reverseStart[a]; r < reverseStart[a + 1] && columns.size() - rowStart.back() < rowLimit; ++r) {
+            int other = listedBy[r];
+            bool mutual = false;
+            for (int j = 0; j < k && !mutual; ++j) mutual = near[j] == other;
+            if (!mutual) columns.push_back(other);
+        }
+        rowStart.push_back(columns.size());
+    }
+    columns.shrink_to_fit();
+
+    values.resize(columns.size());
+    for (std::size_t a = 0; a < n; ++a) {
+        for (std::size_t e = rowStart[a]; e < rowStart[a + 1]; ++e) values[e] = compute(static_cast<int>(a), columns[e]);
+    }
+}
@@ -0,0 +1,210 @@
+#include "exact_solver.h"
+#include "parallel_for.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+
+namespace {
+
+const double INFINITE_COST = std::numeric_limits<double>::infinity();
+// Subsets handed to a worker at a time
+const std::size_t SUBSET_CHUNK = 1024;
+
+} // namespace
+
+const char* exactMethodName(ExactMethod method) {
+    switch (method) {
+        case ExactMethod::BranchAndBound: return "branch and bound";
+        case ExactMethod::DynamicProgramming: return "dynamic programming";
+        default: return "none";
+    }
+}
+
+ExactSolver::ExactSolver()
+    : n(0),
+      length(0.0),
+      method(ExactMethod::None),
+      threadCount(0),
+      branchLimit(10),
+      dynamicProgrammingLimit(20) {
+}
+
+void ExactSolver::setCoordinates(const double* xs, const double* ys, std::size_t n) {
+    this->n = n;
+    costs.resize(n * n);
+    for (std::size_t a = 0; a < n; ++a) {
+        for (std::size_t b = 0; b < n; ++b) {
+            double dx = xs[a] - xs[b];
+            double dy = ys[a] - ys[b];
+            costs[a * n + b] = std::sqrt(dx * dx + dy * dy);
+        }
+    }
+}
+
+void ExactSolver::setCostMatrix(const double* costs, std::size_t n) {
+    this->n = n;
+    this->costs.assign(costs, costs + n * n);
+}
+
+double ExactSolver::tourCost(const std::vector<int>& tour) const {
+    double total = 0.0;
+    for (std::size_t i = 0; i < tour.size(); ++i) total += cost(tour[i], tour[(i + 1) % tour.size()]);
+    return total;
+}
+
+std::vector<int> ExactSolver::solve() {
+    method = ExactMethod::None;
+    length = 0.0;
+    if (n <= 3) {
+        // Every tour is optimal up to direction; pick the cheaper direction
+        std::vector<int> tour;
+        for (std::size_t i = 0; i < n; ++i) tour.push_back(static_cast<int>(i));
+        if (n == 3 && cost(0, 2) + cost(2, 1) + cost(1, 0) < tourCost(tour)) std::swap(tour[1], tour[2]);
+        method = ExactMethod::BranchAndBound;
+        length = tourCost(tour);
+        return tour;
+    }
+    if (n <= static_cast<std::size_t>(branchLimit)) return solveBranchAndBound();
+    if (canSolve()) return solveDynamicProgramming();
+    return std::vector<int>();
+}
+
+// Depth-first over extensions of a path from city 0, pruned by the path
+// cost plus the cheapest way out of every city still to be left
+std::vector<int> ExactSolver::solveBranchAndBound() {
+    int count = static_cast<int>(n);
+    std::vector<double> cheapestOut(n, INFINITE_COST);
+    for (int a = 0; a < count; ++a) {
+        for (int b = 0; b < count; ++b) {
+            if (a != b) cheapestOut[a] = std::min(cheapestOut[a], cost(a, b));
+        }
+    }
+
+    // Nearest-neighbour tour as the first incumbent
+    std::vector<int> best(1, 0);
+    std::vector<char> used(n, 0);
+    used[0] = 1;
+    while (best.size() < n) {
+        int from = best.back(), next = -1;
+        for (int c = 0; c < count; ++c) {
+            if (!used[c] && (next < 0 || cost(from, c) < cost(from, next))) next = c;
+        }
+        used[next] = 1;
+        best.push_back(next);
+    }
+    double bestCost = tourCost(best);
+
+    std::vector<int> path(1, 0);
+    std::fill(used.begin(), used.end(), 0);
+    used[0] = 1;
+    double remainingOut = 0.0;
+    for (int c = 0; c < count; ++c) remainingOut += cheapestOut[c];
+
+    // Explicit recursion via a lambda keeps the state in this frame
+    auto search = [&](auto& self, double pathCost, double outBound) -> void {
+        int from = path.back();
+        if (path.size() == n) {
+            double total = pathCost + cost(from, 0);
+            if (total < bestCost) {
+                bestCost = total;
+                best = path;
+            }
+            return;
+        }
+        for (int c = 1; c < count; ++c) {
+            if (used[c]) continue;
+            double extended = pathCost + cost(from, c);
+            double bound = outBound - cheapestOut[from];
+            if (extended + bound >= bestCost) continue;
+            used[c] = 1;
+            path.push_back(c);
+            self(self, extended, bound);
+            path.pop_back();
+            used[c] = 0;
+        }
+    };
+    search(search, 0.0, remainingOut);
+
+    method = ExactMethod::BranchAndBound;
+    length = bestCost;
+    return best;
+}
+
+std::vector<int> ExactSolver::solveDynamicProgramming() {
+    // Cities 1..n-1 are bits 0..m-1
+    std::size_t m = n - 1;
+    std::size_t subsets = std::size_t(1) << m;
+    std::vector<double> table(subsets * m, INFINITE_COST);
+    // into[j * m + k]: cost from city k+1 to city j+1, so a transition
+    // scans contiguous memory on both sides
+    std::vector<double> into(m * m);
+    for (std::size_t j = 0; j < m; ++j) {
+        for (std::size_t k = 0; k < m; ++k) into[j * m + k] = cost(static_cast<int>(k + 1), static_cast<int>(j + 1));
+    }
+    for (std::size_t j = 0; j < m; ++j) table[(std::size_t(1) << j) * m + j] = cost(0, static_cast<int>(j + 1));
+
+    // Layers by subset size: every subset only depends on the layer below
+    std::vector<std::vector<std::uint32_t>> layers(m + 1);
+    for (std::size_t subset = 1; subset < subsets; ++subset) {
+        layers[__builtin_popcountll(subset)].push_back(static_cast<std::uint32_t>(subset));
+    }
+    int workers = resolveWorkerCount(threadCount);
+    for (std::size_t size = 2; size <= m; ++size) {
+        const std::vector<std::uint32_t>& layer = layers[size];
+        std::size_t chunks = (layer.size() + SUBSET_CHUNK - 1) / SUBSET_CHUNK;
+        parallelFor(chunks, workers, [&](std::size_t chunk) {
+            std::size_t end = std::min(layer.size(), (chunk + 1) * SUBSET_CHUNK);
+            for (std::size_t s = chunk * SUBSET_CHUNK; s < end; ++s) {
+                std::size_t subset = layer[s];
+                double* row = table.data() + subset * m;
+                for (std::size_t j = 0; j < m; ++j) {
+                    if (!(subset & (std::size_t(1) << j))) continue;
+                    // Non-members of the smaller subset hold infinity, so the
+                    // scan needs no membership test
+                    const double* previous = table.data() + (subset ^ (std::size_t(1) << j)) * m;
+                    const double* edge = into.data() + j * m;
+                    double best = INFINITE_COST;
+                    for (std::size_t k = 0; k < m; ++k) best = std::min(best, previous[k] + edge[k]);
+                    row[j] = best;
+                }
+            }
+        });
+    }
+
+    // Close the tour, then walk back through the table
+    std::size_t full = subsets - 1;
+    std::size_t last = 0;
+    double bestCost = INFINITE_COST;
+    for (std::size_t j = 0; j < m; ++j) {
+        double total = table[full * m + j] + cost(static_cast<int>(j + 1), 0);
+        if (total < bestCost) {
+            bestCost = total;
+            last = j;
+        }
+    }
+    std::vector<int> tour(n);
+    tour[0] = 0;
+    std::size_t subset = full;
+    for (std::size_t position = n - 1; position >= 1; --position) {
+        tour[position] = static_cast<int>(last + 1);
+        std::size_t previousSubset = subset ^ (std::size_t(1) << last);
+        if (previousSubset == 0) break;
+        const double* previous = table.data() + previousSubset * m;
+        const double* edge = into.data() + last * m;
+        // The same sums that produced the minimum, so exact equality holds
+        std::size_t from = 0;
+        for (std::size_t k = 0; k < m; ++k) {
+            if (previous[k] + edge[k] == table[subset * m + last]) {
+                from = k;
+                break;
+            }
+        }
+        subset = previousSubset;
+        last = from;
+    }
+
+    method = ExactMethod::DynamicProgramming;
+    length = tourCost(tour);
+    return tour;
+}
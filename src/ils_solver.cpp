@@ -0,0 +1,105 @@
+#include "ils_solver.h"
+#include "tour_kernels.h"
+#include "exact_solver.h"
+
+ILSSolver::ILSSolver()
+    : spatialOrder(SpatialOrder::None),
+      hybrid(false),
+      annealing(false),
+      exactLimit(16) {
+}
+
+void ILSSolver::setCities(const std::vector<City>& cities) {
+    this->cities = cities;
+    xs.resize(cities.size());
+    ys.resize(cities.size());
+    for (size_t i = 0; i < cities.size(); ++i) {
+        xs[i] = cities[i].x;
+        ys[i] = cities[i].y;
+    }
+    originalIndex = spatialOrdering(xs.data(), ys.data(), cities.size(), spatialOrder);
+    for (size_t i = 0; i < originalIndex.size(); ++i) {
+        xs[i] = cities[originalIndex[i]].x;
+        ys[i] = cities[originalIndex[i]].y;
+    }
+    search.setCoordinates(xs, ys);
+    annealer.setCities(cities);
+    reset();
+}
+
+void ILSSolver::applyProfile(const SolverProfile& profile) {
+    annealer.applyProfile(profile);
+    search.setNeighbourCount(profile.neighbourCount);
+    search.setCoordinates(xs, ys);
+    reset();
+}
+
+void ILSSolver::reset() {
+    search.setTour(std::vector<int>());
+    annealer.reset();
+    annealing = hybrid && cities.size() >= 2;
+}
+
+void ILSSolver::addCity(const City& city) {
+    cities.push_back(city);
+    xs.push_back(city.x);
+    ys.push_back(city.y);
+    if (!originalIndex.empty()) originalIndex.push_back(static_cast<int>(cities.size()) - 1);
+    annealer.addCity(city);
+    search.addCity(city.x, city.y);
+}
+
+void ILSSolver::removeCity(int index) {
+    if (index < 0 || static_cast<size_t>(index) >= cities.size()) return;
+    cities.erase(cities.begin() + index);
+    int removed = removeFromOrdering(originalIndex, index);
+    xs.erase(xs.begin() + removed);
+    ys.erase(ys.begin() + removed);
+    annealer.removeCity(index);
+    search.removeCity(removed);
+}
+
+TSPSolution ILSSolver::solve() {
+    reset();
+    if (cities.size() >= 2 && cities.size() <= static_cast<size_t>(exactLimit)) {
+        ExactSolver exact;
+        exact.setCoordinates(xs.data(), ys.data(), xs.size());
+        exact.setDynamicProgrammingLimit(exactLimit);
+        std::vector<int> tour = exact.solve();
+        if (!tour.empty()) {
+            search.setTour(tour);
+            annealing = false;
+            return getCurrentSolution();
+        }
+    }
+    while (step()) {
+    }
+    return getCurrentSolution();
+}
+
+bool ILSSolver::step() {
+    if (annealing) {
+        if (annealer.step()) return true;
+        // The annealer reports caller indices; the search wants curve order
+        std::vector<int> tour = annealer.getCurrentSolution().tour;
+        if (!originalIndex.empty()) {
+            std::vector<int> renumbered(cities.size());
+            for (size_t i = 0; i < originalIndex.size(); ++i) renumbered[originalIndex[i]] = static_cast<int>(i);
+            for (int& city : tour) city = renumbered[city];
+        }
+        search.setTour(tour);
+        annealing = false;
+    }
+    return search.step();
+}
+
+TSPSolution ILSSolver::getCurrentSolution() const {
+    if (annealing) return annealer.getCurrentSolution();
+    TSPSolution solution;
+    solution.tour = search.getTour();
+    solution.distance = tourLength(xs.data(), ys.data(), solution.tour.data(), solution.tour.size());
+    if (!originalIndex.empty()) {
+        for (int& city : solution.tour) city = originalIndex[city];
+    }
+    return solution;
+}
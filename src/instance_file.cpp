@@ -0,0 +1,249 @@
+#include "instance_file.h"
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+const char MAGIC[8] = {'T', 'S', 'P', 'B', 'I', 'N', '\0', '\0'};
+const std::uint32_t BYTE_ORDER_MARK = 0x01020304u;
+
+std::uint64_t alignUp(std::uint64_t offset) {
+    return (offset + 7) & ~std::uint64_t(7);
+}
+
+void writeAt(std::ofstream& out, std::uint64_t offset, const void* data, std::size_t bytes) {
+    out.seekp(static_cast<std::streamoff>(offset));
+    out.write(static_cast<const char*>(data), static_cast<std::streamsize>(bytes));
+}
+
+} // namespace
+
+void saveInstance(const std::string& path, const InstanceData& data) {
+    std::size_t n = data.xs.size();
+    if (data.ys.size() != n) {
+        throw std::runtime_error("InstanceFile: x and y counts differ");
+    }
+    if (!data.matrix.empty() && data.matrix.size() != n * n) {
+        throw std::runtime_error("InstanceFile: matrix is not cityCount x cityCount");
+    }
+    for (const std::vector<int>& tour : data.tours) {
+        if (tour.size() != n) {
+            throw std::runtime_error("InstanceFile: tour length differs from city count");
+        }
+    }
+    std::string metadata;
+    for (const auto& entry : data.metadata) {
+        if (entry.first.find_first_of("=\n") != std::string::npos || entry.second.find('\n') != std::string::npos) {
+            throw std::runtime_error("InstanceFile: metadata key or value contains a separator");
+        }
+        metadata += entry.first + "=" + entry.second + "\n";
+    }
+
+    InstanceFileHeader header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.version = INSTANCE_FILE_VERSION;
+    header.byteOrder = BYTE_ORDER_MARK;
+    header.cityCount = n;
+    header.tourCount = data.tours.size();
+    header.coordinateOffset = alignUp(sizeof(InstanceFileHeader));
+    std::uint64_t next = header.coordinateOffset + 2 * n * sizeof(double);
+    if (!data.matrix.empty()) {
+        header.matrixOffset = alignUp(next);
+        next = header.matrixOffset + n * n * sizeof(double);
+    }
+    header.tourOffset = alignUp(next);
+    next = header.tourOffset + data.tours.size() * n * sizeof(std::int32_t);
+    header.metadataOffset = alignUp(next);
+    header.metadataSize = metadata.size();
+    header.fileSize = header.metadataOffset + metadata.size();
+
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    if (!out) {
+        throw std::runtime_error("InstanceFile: cannot write " + path);
+    }
+    // Zero-filled first so alignment padding is deterministic
+    std::vector<char> zeros(static_cast<std::size_t>(header.fileSize), 0);
+    out.write(zeros.data(), static_cast<std::streamsize>(zeros.size()));
+    writeAt(out, 0, &header, sizeof(header));
+    writeAt(out, header.coordinateOffset, data.xs.data(), n * sizeof(double));
+    writeAt(out, header.coordinateOffset + n * sizeof(double), data.ys.data(), n * sizeof(double));
+    if (!data.matrix.empty()) {
+        writeAt(out, header.matrixOffset, data.matrix.data(), n * n * sizeof(double));
+    }
+    std::vector<std::int32_t> packed(n);
+    for (std::size_t t = 0; t < data.tours.size(); ++t) {
+        for (std::size_t i = 0; i < n; ++i) packed[i] = static_cast<std::int32_t>(data.tours[t][i]);
+        writeAt(out, header.tourOffset + t * n * sizeof(std::int32_t), packed.data(), n * sizeof(std::int32_t));
+    }
+    writeAt(out, header.metadataOffset, metadata.data(), metadata.size());
+    if (!out) {
+        throw std::runtime_error("InstanceFile: write failed for " + path);
+    }
+}
+
+InstanceData loadInstance(const std::string& path) {
+    MappedInstance mapped(path);
+    std::size_t n = mapped.cityCount();
+    InstanceData data;
+    data.xs.assign(mapped.xs(), mapped.xs() + n);
+    data.ys.assign(mapped.ys(), mapped.ys() + n);
+    if (mapped.hasMatrix()) {
+        data.matrix.assign(mapped.matrix(), mapped.matrix() + n * n);
+    }
+    for (std::size_t t = 0; t < mapped.tourCount(); ++t) {
+        data.tours.push_back(std::vector<int>(mapped.tour(t), mapped.tour(t) + n));
+        for (int city : data.tours.back()) {
+            if (city < 0 || static_cast<std::size_t>(city) >= n) {
+                throw std::runtime_error("InstanceFile: tour entry out of range in " + path);
+            }
+        }
+    }
+    data.metadata = mapped.allMetadata();
+    return data;
+}
+
+bool isInstanceFile(const std::string& path) {
+    std::ifstream in(path, std::ios::binary);
+    char magic[sizeof(MAGIC)];
+    return in.read(magic, sizeof(magic)) && std::memcmp(magic, MAGIC, sizeof(MAGIC)) == 0;
+}
+
+MappedInstance::MappedInstance(const std::string& path)
+    : bytes(nullptr),
+      size(0),
+      mapped(false) {
+#ifndef _WIN32
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw std::runtime_error("InstanceFile: cannot open " + path);
+    }
+    struct stat info;
+    if (::fstat(fd, &info) == 0 && info.st_size > 0) {
+        void* view = ::mmap(nullptr, static_cast<std::size_t>(info.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+        if (view != MAP_FAILED) {
+            bytes = static_cast<const unsigned char*>(view);
+            size = static_cast<std::size_t>(info.st_size);
+            mapped = true;
+        }
+    }
+    ::close(fd);
+#endif
+    if (!mapped) {
+        std::ifstream in(path, std::ios::binary);
+        if (!in) {
+            throw std::runtime_error("InstanceFile: cannot open " + path);
+        }
+        buffer.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+        bytes = buffer.data();
+        size = buffer.size();
+    }
+    try {
+        validate(path);
+    } catch (...) {
+        release();
+        throw;
+    }
+}
+
+MappedInstance::~MappedInstance() {
+    release();
+}
+
+MappedInstance::MappedInstance(MappedInstance&& other) noexcept
+    : bytes(other.bytes),
+      size(other.size),
+      mapped(other.mapped),
+      buffer(std::move(other.buffer)) {
+    other.bytes = nullptr;
+    other.size = 0;
+    other.mapped = false;
+}
+
+MappedInstance& MappedInstance::operator=(MappedInstance&& other) noexcept {
+    if (this != &other) {
+        release();
+        bytes = other.bytes;
+        size = other.size;
+        mapped = other.mapped;
+        buffer = std::move(other.buffer);
+        other.bytes = nullptr;
+        other.size = 0;
+        other.mapped = false;
+    }
+    return *this;
+}
+
+void MappedInstance::release() {
+#ifndef _WIN32
+    if (mapped && bytes) {
+        ::munmap(const_cast<unsigned char*>(bytes), size);
+    }
+#endif
+    bytes = nullptr;
+    size = 0;
+    mapped = false;
+    buffer.clear();
+}
+
+// Every block must be 8-byte aligned and lie inside the file
+void MappedInstance::validate(const std::string& path) const {
+    if (size < sizeof(InstanceFileHeader) || std::memcmp(header().magic, MAGIC, sizeof(MAGIC)) != 0) {
+        throw std::runtime_error("InstanceFile: " + path + " is not a .tspb file");
+    }
+    const InstanceFileHeader& h = header();
+    if (h.byteOrder != BYTE_ORDER_MARK) {
+        throw std::runtime_error("InstanceFile: " + path + " was written with the other byte order");
+    }
+    if (h.version != INSTANCE_FILE_VERSION) {
+        throw std::runtime_error("InstanceFile: unsupported version " + std::to_string(h.version) + " in " + path);
+    }
+    std::uint64_t n = h.cityCount;
+    auto block = [&](std::uint64_t offset, std::uint64_t count, std::uint64_t width) {
+        return offset % 8 == 0 && offset >= sizeof(InstanceFileHeader) && offset <= size &&
+               (width == 0 || count <= (size - offset) / width);
+    };
+    bool valid = h.fileSize == size && n <= size &&
+                 block(h.coordinateOffset, 2 * n, sizeof(double)) &&
+                 (h.matrixOffset == 0 || (n < (std::uint64_t(1) << 32) && block(h.matrixOffset, n * n, sizeof(double)))) &&
+                 (n == 0 || h.tourCount <= size / n) &&
+                 block(h.tourOffset, h.tourCount * n, sizeof(std::int32_t)) &&
+                 block(h.metadataOffset, h.metadataSize, 1);
+    if (!valid) {
+        throw std::runtime_error("InstanceFile: truncated or corrupt " + path);
+    }
+}
+
+std::vector<std::pair<std::string, std::string>> MappedInstance::allMetadata() const {
+    std::vector<std::pair<std::string, std::string>> entries;
+    const char* text = at<char>(header().metadataOffset);
+    std::string all(text, text + header().metadataSize);
+    std::size_t start = 0;
+    while (start < all.size()) {
+        std::size_t end = all.find('\n', start);
+        if (end == std::string::npos) end = all.size();
+        std::string line = all.substr(start, end - start);
+        std::size_t split = line.find('=');
+        if (split != std::string::npos) {
+            entries.push_back(std::make_pair(line.substr(0, split), line.substr(split + 1)));
+        }
+        start = end + 1;
+    }
+    return entries;
+}
+
+std::string MappedInstance::metadata(const std::string& key) const {
+    for (const auto& entry : allMetadata()) {
+        if (entry.first == key) return entry.second;
+    }
+    return std::string();
+}
@@ -0,0 +1,460 @@
+#include "island_model.h"
+#include "parallel_for.h"
+#include "solver_profile.h"
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+#include <thread>
+#include <arpa/inet.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+namespace {
+
+const std::uint32_t MESSAGE_MAGIC = 0x54535049; // "TSPI"
+// How long an island keeps retrying while its peer is not listening yet
+const int CONNECT_TIMEOUT_MS = 10000;
+
+enum MessageKind : std::uint32_t {
+    MESSAGE_FULL = 1,
+    MESSAGE_DELTA = 2
+};
+
+struct MessageHeader {
+    std::uint32_t magic;
+    std::uint32_t kind;
+    std::uint32_t sender;
+    std::uint32_t words;
+    double length;
+};
+
+void sendAll(int fd, const void* data, std::size_t size) {
+    const char* bytes = static_cast<const char*>(data);
+    while (size > 0) {
+        ssize_t sent = ::send(fd, bytes, size, MSG_NOSIGNAL);
+        if (sent < 0 && errno == EINTR) continue;
+        if (sent <= 0) throw std::runtime_error(std::string("IslandSolver: send failed: ") + std::strerror(errno));
+        bytes += sent;
+        size -= static_cast<std::size_t>(sent);
+    }
+}
+
+// Pipe counterpart of sendAll
+void writeAll(int fd, const void* data, std::size_t size) {
+    const char* bytes = static_cast<const char*>(data);
+    while (size > 0) {
+        ssize_t written = ::write(fd, bytes, size);
+        if (written < 0 && errno == EINTR) continue;
+        if (written <= 0) throw std::runtime_error(std::string("runIslands: write failed: ") + std::strerror(errno));
+        bytes += written;
+        size -= static_cast<std::size_t>(written);
+    }
+}
+
+void receiveAll(int fd, void* data, std::size_t size) {
+    char* bytes = static_cast<char*>(data);
+    while (size > 0) {
+        ssize_t received = ::read(fd, bytes, size);
+        if (received < 0 && errno == EINTR) continue;
+        if (received == 0) throw std::runtime_error("IslandSolver: peer closed the connection");
+        if (received < 0) throw std::runtime_error(std::string("IslandSolver: receive failed: ") + std::strerror(errno));
+        bytes += received;
+        size -= static_cast<std::size_t>(received);
+    }
+}
+
+void closeSocket(int& fd) {
+    if (fd >= 0) ::close(fd);
+    fd = -1;
+}
+
+} // namespace
+
+void canonicaliseTour(std::vector<int>& tour) {
+    std::size_t n = tour.size();
+    if (n < 3) return;
+    std::rotate(tour.begin(), std::find(tour.begin(), tour.end(), 0), tour.end());
+    if (tour[n - 1] < tour[1]) std::reverse(tour.begin() + 1, tour.end());
+}
+
+std::vector<std::uint32_t> encodeTourDelta(const std::vector<int>& previous, const std::vector<int>& current) {
+    std::vector<std::uint32_t> words(1, 0);
+    std::size_t n = std::min(previous.size(), current.size());
+    for (std::size_t i = 0; i < n; ++i) {
+        if (previous[i] == current[i]) continue;
+        std::size_t end = i;
+        while (end < n && previous[end] != current[end]) ++end;
+        words.push_back(static_cast<std::uint32_t>(i));
+        words.push_back(static_cast<std::uint32_t>(end - i));
+        for (std::size_t k = i; k < end; ++k) words.push_back(static_cast<std::uint32_t>(current[k]));
+        ++words[0];
+        i = end;
+    }
+    return words;
+}
+
+bool applyTourDelta(std::vector<int>& tour, const std::uint32_t* words, std::size_t count) {
+    if (count == 0) return false;
+    std::vector<int> result = tour;
+    std::size_t n = tour.size();
+    std::size_t at = 1;
+    for (std::uint32_t run = 0; run < words[0]; ++run) {
+        if (at + 2 > count) return false;
+        std::size_t start = words[at];
+        std::size_t length = words[at + 1];
+        at += 2;
+        if (start > n || length > n - start || length > count - at) return false;
+        for (std::size_t k = 0; k < length; ++k) result[start + k] = static_cast<int>(words[at + k]);
+        at += length;
+    }
+    if (at != count) return false;
+
+    std::vector<char> seen(n, 0);
+    for (int city : result) {
+        if (city < 0 || static_cast<std::size_t>(city) >= n || seen[city]) return false;
+        seen[city] = 1;
+    }
+    tour.swap(result);
+    return true;
+}
+
+IslandSolver::IslandSolver()
+    : islandIndex(0),
+      listenSocket(-1),
+      peerPort(0) {
+}
+
+IslandSolver::~IslandSolver() {
+    closeSocket(listenSocket);
+}
+
+int IslandSolver::listen(int port, const std::string& address) {
+    closeSocket(listenSocket);
+    listenSocket = ::socket(AF_INET, SOCK_STREAM, 0);
+    if (listenSocket < 0) throw std::runtime_error(std::string("IslandSolver: socket failed: ") + std::strerror(errno));
+    int reuse = 1;
+    ::setsockopt(listenSocket, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+
+    sockaddr_in local;
+    std::memset(&local, 0, sizeof(local));
+    local.sin_family = AF_INET;
+    local.sin_port = htons(static_cast<std::uint16_t>(port));
+    if (::inet_pton(AF_INET, address.c_str(), &local.sin_addr) != 1) {
+        closeSocket(listenSocket);
+        throw std::runtime_error("IslandSolver: invalid listen address " + address);
+    }
+    if (::bind(listenSocket, reinterpret_cast<sockaddr*>(&local), sizeof(local)) != 0 || ::listen(listenSocket, 4) != 0) {
+        std::string reason = std::strerror(errno);
+        closeSocket(listenSocket);
+        throw std::runtime_error("IslandSolver: cannot listen on port " + std::to_string(port) + ": " + reason);
+    }
+    socklen_t size = sizeof(local);
+    ::getsockname(listenSocket, reinterpret_cast<sockaddr*>(&local), &size);
+    return ntohs(local.sin_port);
+}
+
+// Retries while the peer has not started listening yet
+int IslandSolver::connectToPeer() const {
+    addrinfo hints;
+    std::memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_INET;
+    hints.ai_socktype = SOCK_STREAM;
+    addrinfo* address = nullptr;
+    if (::getaddrinfo(peerHost.c_str(), std::to_string(peerPort).c_str(), &hints, &address) != 0 || !address) {
+        throw std::runtime_error("IslandSolver: cannot resolve peer " + peerHost);
+    }
+
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(CONNECT_TIMEOUT_MS);
+    int fd = -1;
+    while (true) {
+        fd = ::socket(AF_INET, SOCK_STREAM, 0);
+        if (fd >= 0 && ::connect(fd, address->ai_addr, address->ai_addrlen) == 0) break;
+        closeSocket(fd);
+        if (std::chrono::steady_clock::now() > deadline) {
+            ::freeaddrinfo(address);
+            throw std::runtime_error("IslandSolver: cannot connect to " + peerHost + ":" + std::to_string(peerPort));
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    ::freeaddrinfo(address);
+    int noDelay = 1;
+    ::setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &noDelay, sizeof(noDelay));
+    return fd;
+}
+
+TSPSolution IslandSolver::run() {
+    auto started = std::chrono::steady_clock::now();
+    stats = IslandStats();
+    std::size_t n = cities.size();
+    if (n < 2) {
+        TSPSolution solution;
+        for (std::size_t i = 0; i < n; ++i) solution.tour.push_back(static_cast<int>(i));
+        return solution;
+    }
+
+    // One schedule across all epochs, scaled to the instance
+    std::vector<double> xs(n), ys(n);
+    for (std::size_t i = 0; i < n; ++i) {
+        xs[i] = cities[i].x;
+        ys[i] = cities[i].y;
+    }
+    double edge = typicalEdgeLength(xs.data(), ys.data(), n);
+    int epochs = std::max(config.epochs, 1);
+    int epochIterations = std::max(config.epochIterations, 1);
+    double total = static_cast<double>(epochs) * epochIterations;
+    int population = resolveWorkerCount(config.population);
+    ThreadPlacement placement(config.placement != PlacementPolicy::None ? CpuTopology::detect() : CpuTopology(), config.placement);
+    if (placement.getTopology().nodeCount > 1) placement.restrictToNode(islandIndex % placement.getTopology().nodeCount);
+    std::vector<std::unique_ptr<TSPSolver>> solvers;
+    for (int i = 0; i < population; ++i) {
+        std::unique_ptr<TSPSolver> solver(new TSPSolver());
+        solver->setInitialTemperature(edge);
+        solver->setMinTemperature(edge * 1e-3);
+        solver->setCoolingRate(std::pow(1e-3, 1.0 / total));
+        solver->setMaxIterations(static_cast<int>(std::min(total, 2e9)));
+        solver->setSeed(config.seed + 7919u * static_cast<unsigned>(islandIndex) + static_cast<unsigned>(i));
+        solver->setCities(cities);
+        if (config.placement != PlacementPolicy::None) solver->setPlacement(&placement, i);
+        solvers.push_back(std::move(solver));
+    }
+
+    bool networked = peerPort > 0;
+    int outgoing = -1, incoming = -1;
+    if (networked) {
+        if (listenSocket < 0) throw std::runtime_error("IslandSolver: listen() must be called before run() with a peer");
+        outgoing = connectToPeer();
+        // Give up on a previous island that never shows up
+        timeval timeout;
+        timeout.tv_sec = CONNECT_TIMEOUT_MS / 1000;
+        timeout.tv_usec = 0;
+        ::setsockopt(listenSocket, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+        incoming = ::accept(listenSocket, nullptr, nullptr);
+        if (incoming < 0) {
+            closeSocket(outgoing);
+            throw std::runtime_error(std::string("IslandSolver: accept failed: ") + std::strerror(errno));
+        }
+    }
+
+    std::vector<int> lastSent, lastReceived;
+    try {
+        for (int epoch = 0; epoch < epochs; ++epoch) {
+            // resume() pins the thread to the annealer's CPU, pause() unpins it
+            parallelFor(solvers.size(), population, [&](std::size_t i) {
+                TSPSolver& solver = *solvers[i];
+                if (solver.isFinished()) return;
+                solver.resume();
+                for (int k = 0; k < epochIterations && solver.step(); ++k) {
+                }
+                solver.pause();
+            });
+            if (!networked) continue;
+
+            std::size_t best = 0, worst = 0;
+            for (std::size_t i = 1; i < solvers.size(); ++i) {
+                if (solvers[i]->getBestDistance() < solvers[best]->getBestDistance()) best = i;
+                if (solvers[i]->getBestDistance() > solvers[worst]->getBestDistance()) worst = i;
+            }
+            TSPSolution emigrant = solvers[best]->getCurrentSolution();
+            canonicaliseTour(emigrant.tour);
+
+            MessageHeader header;
+            header.magic = MESSAGE_MAGIC;
+            header.sender = static_cast<std::uint32_t>(islandIndex);
+            header.length = emigrant.distance;
+            std::vector<std::uint32_t> payload;
+            if (lastSent.size() == n) payload = encodeTourDelta(lastSent, emigrant.tour);
+            if (!payload.empty() && payload.size() < n) {
+                header.kind = MESSAGE_DELTA;
+                ++stats.deltaMessages;
+            } else {
+                header.kind = MESSAGE_FULL;
+                payload.assign(emigrant.tour.begin(), emigrant.tour.end());
+            }
+            header.words = static_cast<std::uint32_t>(payload.size());
+            lastSent = emigrant.tour;
+
+            // Every island sends before it receives, so sending runs on its
+            // own thread rather than relying on socket buffers
+            std::string sendError;
+            std::thread sender([&]() {
+                try {
+                    sendAll(outgoing, &header, sizeof(header));
+                    sendAll(outgoing, payload.data(), payload.size() * sizeof(std::uint32_t));
+                } catch (const std::exception& e) {
+                    sendError = e.what();
+                }
+            });
+            MessageHeader received;
+            std::vector<std::uint32_t> words;
+            std::string receiveError;
+            try {
+                receiveAll(incoming, &received, sizeof(received));
+                if (received.magic != MESSAGE_MAGIC || received.words > 2 * n + 1) {
+                    throw std::runtime_error("IslandSolver: malformed message");
+                }
+                words.resize(received.words);
+                receiveAll(incoming, words.data(), words.size() * sizeof(std::uint32_t));
+            } catch (const std::exception& e) {
+                receiveError = e.what();
+            }
+            sender.join();
+            if (!sendError.empty()) throw std::runtime_error(sendError);
+            if (!receiveError.empty()) throw std::runtime_error(receiveError);
+            ++stats.messages;
+            stats.bytesSent += static_cast<long>(sizeof(header) + payload.size() * sizeof(std::uint32_t));
+
+            std::vector<int> migrant;
+            if (received.kind == MESSAGE_FULL && words.size() == n) {
+                migrant.assign(words.begin(), words.end());
+            } else if (received.kind == MESSAGE_DELTA && lastReceived.size() == n) {
+                migrant = lastReceived;
+                if (!applyTourDelta(migrant, words.data(), words.size())) migrant.clear();
+            }
+            if (migrant.size() != n) throw std::runtime_error("IslandSolver: malformed tour from island " + std::to_string(received.sender));
+            lastReceived = migrant;
+            if (received.length < solvers[worst]->getBestDistance() && solvers[worst]->seedTour(migrant)) {
+                ++stats.migrantsAccepted;
+            }
+        }
+    } catch (...) {
+        closeSocket(outgoing);
+        closeSocket(incoming);
+        throw;
+    }
+    closeSocket(outgoing);
+    closeSocket(incoming);
+
+    TSPSolution best = solvers[0]->getCurrentSolution();
+    for (const auto& solver : solvers) {
+        stats.iterations += solver->getIteration();
+        TSPSolution solution = solver->getCurrentSolution();
+        if (solution.distance < best.distance) best = solution;
+    }
+    stats.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+    placements = placement.getPlacements();
+    return best;
+}
+
+TSPSolution runIslands(const std::vector<City>& cities, int islandCount, const IslandConfig& config,
+                       IslandStats* totals, std::vector<std::vector<WorkerPlacement>>* placements) {
+    if (islandCount <= 1) {
+        IslandSolver island;
+        island.setCities(cities);
+        island.setConfig(config);
+        TSPSolution solution = island.run();
+        if (totals) *totals = island.getStats();
+        if (placements) placements->assign(1, island.getPlacements());
+        return solution;
+    }
+
+    // Every listener is open before any island starts, so no connect can
+    // race a bind
+    std::vector<std::unique_ptr<IslandSolver>> islands;
+    std::vector<int> ports;
+    for (int i = 0; i < islandCount; ++i) {
+        islands.emplace_back(new IslandSolver());
+        islands[i]->setCities(cities);
+        islands[i]->setConfig(config);
+        islands[i]->setIslandIndex(i);
+        ports.push_back(islands[i]->listen());
+    }
+    for (int i = 0; i < islandCount; ++i) islands[i]->setPeer("127.0.0.1", ports[(i + 1) % islandCount]);
+
+    // Each island reports back through a pipe: a status byte, its stats,
+    // its best tour and its thread placements (or an error message)
+    std::vector<pid_t> children;
+    std::vector<int> pipes;
+    for (int i = 0; i < islandCount; ++i) {
+        int ends[2];
+        if (::pipe(ends) != 0) throw std::runtime_error("runIslands: pipe failed");
+        pid_t pid = ::fork();
+        if (pid < 0) throw std::runtime_error("runIslands: fork failed");
+        if (pid == 0) {
+            ::close(ends[0]);
+            for (int j = 0; j < islandCount; ++j) {
+                if (j != i) islands[j].reset();
+            }
+            char status = 1;
+            try {
+                TSPSolution solution = islands[i]->run();
+                IslandStats stats = islands[i]->getStats();
+                std::uint64_t size = solution.tour.size();
+                writeAll(ends[1], &status, 1);
+                writeAll(ends[1], &stats, sizeof(stats));
+                writeAll(ends[1], &solution.distance, sizeof(solution.distance));
+                writeAll(ends[1], &size, sizeof(size));
+                writeAll(ends[1], solution.tour.data(), size * sizeof(int));
+                const std::vector<WorkerPlacement>& placed = islands[i]->getPlacements();
+                size = placed.size();
+                writeAll(ends[1], &size, sizeof(size));
+                writeAll(ends[1], placed.data(), size * sizeof(WorkerPlacement));
+            } catch (const std::exception& e) {
+                status = 0;
+                std::uint64_t size = std::strlen(e.what());
+                ssize_t ignored = ::write(ends[1], &status, 1);
+                ignored = ::write(ends[1], &size, sizeof(size));
+                ignored = ::write(ends[1], e.what(), size);
+                (void)ignored;
+            }
+            ::_exit(0);
+        }
+        ::close(ends[1]);
+        children.push_back(pid);
+        pipes.push_back(ends[0]);
+    }
+    islands.clear();
+
+    TSPSolution best;
+    best.distance = -1.0;
+    if (placements) placements->assign(islandCount, std::vector<WorkerPlacement>());
+    IslandStats sum;
+    std::string failure;
+    for (int i = 0; i < islandCount; ++i) {
+        try {
+            char status = 0;
+            receiveAll(pipes[i], &status, 1);
+            std::uint64_t size = 0;
+            if (status) {
+                IslandStats stats;
+                TSPSolution solution;
+                receiveAll(pipes[i], &stats, sizeof(stats));
+                receiveAll(pipes[i], &solution.distance, sizeof(solution.distance));
+                receiveAll(pipes[i], &size, sizeof(size));
+                solution.tour.resize(size);
+                receiveAll(pipes[i], solution.tour.data(), size * sizeof(int));
+                receiveAll(pipes[i], &size, sizeof(size));
+                std::vector<WorkerPlacement> placed(size);
+                receiveAll(pipes[i], placed.data(), size * sizeof(WorkerPlacement));
+                if (placements) (*placements)[i] = placed;
+                sum.iterations += stats.iterations;
+                sum.messages += stats.messages;
+                sum.bytesSent += stats.bytesSent;
+                sum.deltaMessages += stats.deltaMessages;
+                sum.migrantsAccepted += stats.migrantsAccepted;
+                sum.seconds = std::max(sum.seconds, stats.seconds);
+                if (best.distance < 0.0 || solution.distance < best.distance) best = solution;
+            } else {
+                receiveAll(pipes[i], &size, sizeof(size));
+                std::string message(size, '\0');
+                receiveAll(pipes[i], &message[0], size);
+                if (failure.empty()) failure = "island " + std::to_string(i) + ": " + message;
+            }
+        } catch (const std::exception&) {
+            if (failure.empty()) failure = "island " + std::to_string(i) + " exited without a result";
+        }
+        ::close(pipes[i]);
+    }
+    for (pid_t pid : children) ::waitpid(pid, nullptr, 0);
+    if (!failure.empty()) throw std::runtime_error("runIslands: " + failure);
+    if (totals) *totals = sum;
+    return best;
+}
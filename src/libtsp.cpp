@@ -0,0 +1,178 @@
+#include "libtsp.h"
+#include "local_search.h"
+#include "exact_solver.h"
+#include <chrono>
+#include <cmath>
+#include <exception>
+#include <limits>
+#include <mutex>
+#include <new>
+#include <string>
+#include <vector>
+
+// Everything a context reuses between calls; the engine keeps its tour,
+// position and neighbour buffers, so repeated solves of similar sizes do
+// not allocate.
+struct tsp_context {
+    std::mutex mutex;
+    IteratedLocalSearch search;
+    ExactSolver exact;
+    const double* xs;
+    const double* ys;
+    std::size_t n;
+    std::uint32_t seed;
+    int exactLimit;
+    // Set by tsp_solve: the exact tour when one was computed, else the engine's
+    std::vector<int> exactTour;
+    double length;
+    bool solved;
+    std::string error;
+
+    tsp_context() : xs(nullptr), ys(nullptr), n(0), seed(1), exactLimit(10), length(0.0), solved(false) {
+        search.setMaxKicks(std::numeric_limits<long>::max());
+        // Request paths should not start threads of their own, and the DP
+        // beats branch and bound from 9 cities on
+        exact.setThreadCount(1);
+        exact.setBranchLimit(8);
+    }
+};
+
+namespace {
+
+tsp_status fail(tsp_context* context, tsp_status status, const char* message) {
+    context->error = message;
+    return status;
+}
+
+// Runs body under the context's lock, turning exceptions into statuses so
+// none cross the C boundary
+template<typename Body>
+tsp_status guarded(tsp_context* context, Body body) {
+    if (!context) return TSP_ERROR_ARGUMENT;
+    try {
+        std::lock_guard<std::mutex> lock(context->mutex);
+        context->error.clear();
+        return body();
+    } catch (const std::bad_alloc&) {
+        return fail(context, TSP_ERROR_MEMORY, "libtsp: out of memory");
+    } catch (const std::exception& e) {
+        context->error = std::string("libtsp: ") + e.what();
+        return TSP_ERROR_INTERNAL;
+    } catch (...) {
+        return fail(context, TSP_ERROR_INTERNAL, "libtsp: unknown error");
+    }
+}
+
+} // namespace
+
+extern "C" {
+
+int tsp_abi_version(void) {
+    return TSP_ABI_VERSION;
+}
+
+tsp_context* tsp_create(void) {
+    return new (std::nothrow) tsp_context();
+}
+
+void tsp_destroy(tsp_context* context) {
+    delete context;
+}
+
+tsp_status tsp_set_coordinates(tsp_context* context, const double* xs, const double* ys, size_t n) {
+    return guarded(context, [&]() {
+        if (n > 0 && (!xs || !ys)) return fail(context, TSP_ERROR_ARGUMENT, "libtsp: null coordinate array");
+        if (n > static_cast<size_t>(std::numeric_limits<int>::max())) {
+            return fail(context, TSP_ERROR_ARGUMENT, "libtsp: too many cities");
+        }
+        for (size_t i = 0; i < n; ++i) {
+            if (!std::isfinite(xs[i]) || !std::isfinite(ys[i])) {
+                return fail(context, TSP_ERROR_ARGUMENT, "libtsp: coordinates must be finite");
+            }
+        }
+        context->xs = xs;
+        context->ys = ys;
+        context->n = n;
+        context->solved = false;
+        if (n > static_cast<size_t>(context->exactLimit)) context->search.setCoordinates(xs, ys, n);
+        return TSP_OK;
+    });
+}
+
+tsp_status tsp_set_seed(tsp_context* context, uint32_t seed) {
+    return guarded(context, [&]() {
+        context->seed = seed;
+        return TSP_OK;
+    });
+}
+
+tsp_status tsp_set_exact_limit(tsp_context* context, int cities) {
+    return guarded(context, [&]() {
+        if (cities < 0 || cities > 24) return fail(context, TSP_ERROR_ARGUMENT, "libtsp: exact limit must be 0..24");
+        bool wasExact = context->n <= static_cast<size_t>(context->exactLimit);
+        context->exactLimit = cities;
+        if (wasExact && context->n > static_cast<size_t>(cities)) {
+            context->search.setCoordinates(context->xs, context->ys, context->n);
+        }
+        context->solved = false;
+        return TSP_OK;
+    });
+}
+
+tsp_status tsp_solve(tsp_context* context, double seconds) {
+    auto started = std::chrono::steady_clock::now();
+    return guarded(context, [&]() {
+        if (context->n == 0) return fail(context, TSP_ERROR_STATE, "libtsp: no coordinates set");
+        context->exactTour.clear();
+        if (context->n <= static_cast<size_t>(context->exactLimit) || context->n < 4) {
+            context->exact.setCoordinates(context->xs, context->ys, context->n);
+            context->exact.setDynamicProgrammingLimit(context->exactLimit < 3 ? 3 : context->exactLimit);
+            context->exactTour = context->exact.solve();
+            context->length = context->exact.getLength();
+            context->solved = true;
+            return TSP_OK;
+        }
+
+        IteratedLocalSearch& search = context->search;
+        search.setSeed(context->seed);
+        search.setTour(std::vector<int>());
+        auto deadline = started + std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                                      std::chrono::duration<double>(seconds > 0.0 ? seconds : 0.0));
+        // The first step is the descent; kicks follow while time remains
+        bool more = search.step();
+        while (more && std::chrono::steady_clock::now() < deadline) more = search.step();
+        context->length = search.getLength();
+        context->solved = true;
+        return TSP_OK;
+    });
+}
+
+tsp_status tsp_get_tour(tsp_context* context, int32_t* tour, size_t capacity) {
+    return guarded(context, [&]() {
+        if (!context->solved) return fail(context, TSP_ERROR_STATE, "libtsp: nothing solved yet");
+        if (context->n > 0 && (!tour || capacity < context->n)) {
+            return fail(context, TSP_ERROR_ARGUMENT, "libtsp: tour buffer shorter than the city count");
+        }
+        const std::vector<int>& source = context->exactTour.size() == context->n ? context->exactTour
+                                                                                  : context->search.getTour();
+        for (size_t i = 0; i < context->n; ++i) tour[i] = static_cast<int32_t>(source[i]);
+        return TSP_OK;
+    });
+}
+
+tsp_status tsp_get_length(tsp_context* context, double* length) {
+    return guarded(context, [&]() {
+        if (!length) return fail(context, TSP_ERROR_ARGUMENT, "libtsp: null length pointer");
+        if (!context->solved) return fail(context, TSP_ERROR_STATE, "libtsp: nothing solved yet");
+        *length = context->length;
+        return TSP_OK;
+    });
+}
+
+const char* tsp_last_error(tsp_context* context) {
+    if (!context) return "libtsp: null context";
+    std::lock_guard<std::mutex> lock(context->mutex);
+    return context->error.c_str();
+}
+
+} // extern "C"
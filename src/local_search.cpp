@@ -0,0 +1,484 @@
+#include "local_search.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+
+namespace {
+
+// Moves must gain at least this much, so rounding noise cannot cycle
+const double MIN_GAIN = 1e-10;
+
+} // namespace
+
+const char* solverModeName(SolverMode mode) {
+    switch (mode) {
+        case SolverMode::Annealing: return "sa";
+        case SolverMode::IteratedLocalSearch: return "ils";
+        case SolverMode::Hybrid: return "hybrid";
+        case SolverMode::Memetic: return "memetic";
+    }
+    return "sa";
+}
+
+bool parseSolverMode(const char* name, SolverMode& mode) {
+    const SolverMode modes[] = {SolverMode::Annealing, SolverMode::IteratedLocalSearch, SolverMode::Hybrid,
+                                SolverMode::Memetic};
+    for (SolverMode candidate : modes) {
+        if (std::strcmp(name, solverModeName(candidate)) == 0) {
+            mode = candidate;
+            return true;
+        }
+    }
+    return false;
+}
+
+IteratedLocalSearch::IteratedLocalSearch()
+    : xData(nullptr),
+      yData(nullptr),
+      cityCount(0),
+      length(0.0),
+      journaling(false),
+      optimised(false),
+      neighbourCount(10),
+      maxKicks(100000),
+      kickSegmentLimit(50),
+      cacheDistances(false),
+      kicks(0),
+      improvingKicks(0),
+      rng(std::chrono::steady_clock::now().time_since_epoch().count()) {
+}
+
+void IteratedLocalSearch::setCoordinates(const std::vector<double>& xs, const std::vector<double>& ys) {
+    this->xs = xs;
+    this->ys = ys;
+    xData = this->xs.data();
+    yData = this->ys.data();
+    cityCount = xs.size();
+    buildStructures();
+}
+
+void IteratedLocalSearch::setCoordinates(const double* xs, const double* ys, std::size_t n) {
+    this->xs.clear();
+    this->ys.clear();
+    xData = xs;
+    yData = ys;
+    cityCount = n;
+    buildStructures();
+}
+
+void IteratedLocalSearch::buildStructures() {
+    neighbours = buildNeighbourLists(xData, yData, cityCount, neighbourCount);
+    rebuildCache();
+    initialTour.clear();
+    reset();
+}
+
+void IteratedLocalSearch::ownCoordinates() {
+    if (xData != xs.data()) {
+        xs.assign(xData, xData + cityCount);
+        ys.assign(yData, yData + cityCount);
+    }
+}
+
+void IteratedLocalSearch::setTour(const std::vector<int>& tour) {
+    initialTour = tour;
+    reset();
+}
+
+void IteratedLocalSearch::reset() {
+    size_t n = cityCount;
+    std::vector<char> seen(n, 0);
+    bool valid = initialTour.size() == n;
+    for (size_t i = 0; valid && i < n; ++i) {
+        int city = initialTour[i];
+        valid = city >= 0 && static_cast<size_t>(city) < n && !seen[city];
+        if (valid) seen[city] = 1;
+    }
+    if (valid) {
+        tour = initialTour;
+    } else {
+        buildNearestNeighbourTour();
+    }
+
+    rebuildPositions();
+    length = 0.0;
+    for (size_t i = 0; i < n && n > 1; ++i) length += dist(tour[i], tour[(i + 1) % n]);
+
+    active.clear();
+    queued.assign(n, 0);
+    journal.clear();
+    journaling = false;
+    optimised = false;
+    kicks = 0;
+    improvingKicks = 0;
+}
+
+void IteratedLocalSearch::rebuildPositions() {
+    position.resize(tour.size());
+    for (size_t i = 0; i < tour.size(); ++i) position[tour[i]] = static_cast<int>(i);
+}
+
+void IteratedLocalSearch::addCity(double x, double y) {
+    ownCoordinates();
+    xs.push_back(x);
+    ys.push_back(y);
+    xData = xs.data();
+    yData = ys.data();
+    size_t n = cityCount = xs.size();
+    int added = static_cast<int>(n) - 1;
+    appendToNeighbourLists(neighbours, xData, yData, n, neighbourCount);
+    rebuildCache();
+
+    // Cheapest detour over the edges touching the new city's neighbours
+    size_t insertAfter = tour.empty() ? 0 : tour.size() - 1;
+    double bestCost = 0.0;
+    bool found = false;
+    const int* near = neighbours.of(added);
+    for (int j = 0; j < neighbours.k; ++j) {
+        int c = near[j];
+        int candidates[2] = {prev(c), c};
+        for (int from : candidates) {
+            int to = next(from);
+            double cost = dist(from, added) + dist(added, to) - dist(from, to);
+            if (!found || cost < bestCost) {
+                bestCost = cost;
+                insertAfter = static_cast<size_t>(position[from]);
+                found = true;
+            }
+        }
+    }
+    tour.insert(tour.begin() + (tour.empty() ? 0 : insertAfter + 1), added);
+    rebuildPositions();
+    length += bestCost;
+    queued.assign(n, 0);
+    reoptimiseAround(added);
+}
+
+void IteratedLocalSearch::removeCity(int index) {
+    if (index < 0 || static_cast<size_t>(index) >= cityCount) return;
+    int before = tour.size() > 1 ? prev(index) : -1;
+    int after = tour.size() > 1 ? next(index) : -1;
+    if (tour.size() > 1) {
+        length += (tour.size() > 2 ? dist(before, after) : 0.0) - dist(before, index) - dist(index, after);
+    }
+
+    tour.erase(tour.begin() + position[index]);
+    for (int& city : tour) {
+        if (city > index) --city;
+    }
+    ownCoordinates();
+    xs.erase(xs.begin() + index);
+    ys.erase(ys.begin() + index);
+    xData = xs.data();
+    yData = ys.data();
+    cityCount = xs.size();
+    removeFromNeighbourLists(neighbours, xData, yData, cityCount, neighbourCount, index);
+    rebuildCache();
+    rebuildPositions();
+    queued.assign(cityCount, 0);
+    if (before >= 0) reoptimiseAround(before > index ? before - 1 : before);
+}
+
+// Re-queues a city and its two tour neighbours and runs the local search,
+// which then only spreads as far as moves keep improving.
+void IteratedLocalSearch::reoptimiseAround(int city) {
+    if (tour.size() < 4) return;
+    push(city);
+    push(prev(city));
+    push(next(city));
+    localSearch();
+}
+
+void IteratedLocalSearch::rebuildCache() {
+    if (cacheDistances) {
+        cache.build(xData, yData, cityCount, neighbours);
+    } else {
+        cache.clear();
+    }
+}
+
+double IteratedLocalSearch::dist(int a, int b) const {
+    return cache.empty() ? computeDist(a, b) : cache.distance(a, b);
+}
+
+double IteratedLocalSearch::computeDist(int a, int b) const {
+    double dx = xData[a] - xData[b];
+    double dy = yData[a] - yData[b];
+    return std::sqrt(dx * dx + dy * dy);
+}
+
+// Greedy construction: walk to the nearest unvisited neighbour, falling back
+// to a full scan when all listed neighbours are already in the tour.
+void IteratedLocalSearch::buildNearestNeighbourTour() {
+    size_t n = cityCount;
+    tour.clear();
+    if (n == 0) return;
+    tour.reserve(n);
+
+    std::vector<int> unvisited(n);
+    std::vector<int> slot(n);
+    for (size_t i = 0; i < n; ++i) {
+        unvisited[i] = static_cast<int>(i);
+        slot[i] = static_cast<int>(i);
+    }
+    auto visit = [&](int city) {
+        int last = unvisited.back();
+        unvisited[slot[city]] = last;
+        slot[last] = slot[city];
+        unvisited.pop_back();
+        slot[city] = -1;
+        tour.push_back(city);
+    };
+
+    visit(0);
+    while (!unvisited.empty()) {
+        int current = tour.back();
+        int chosen = -1;
+        const int* near = neighbours.of(current);
+        for (int j = 0; j < neighbours.k && chosen < 0; ++j) {
+            if (slot[near[j]] >= 0) chosen = near[j];
+        }
+        if (chosen < 0) {
+            double best = 0.0;
+            // Far pairs: probing the cache would only miss
+            for (int city : unvisited) {
+                double d = computeDist(current, city);
+                if (chosen < 0 || d < best) {
+                    best = d;
+                    chosen = city;
+                }
+            }
+        }
+        visit(chosen);
+    }
+}
+
+bool IteratedLocalSearch::step() {
+    size_t n = tour.size();
+    if (!optimised) {
+        optimised = true;
+        if (n < 4) return false;
+        for (size_t i = 0; i < n; ++i) push(tour[i]);
+        localSearch();
+        return true;
+    }
+    if (kicks >= maxKicks || n < 8) return false;
+
+    double before = length;
+    journal.clear();
+    journaling = true;
+    kick();
+    localSearch();
+    journaling = false;
+    kicks++;
+
+    if (length < before - MIN_GAIN) {
+        improvingKicks++;
+    } else {
+        undoJournal();
+        length = before;
+    }
+    return true;
+}
+
+void IteratedLocalSearch::push(int city) {
+    if (queued[city]) return;
+    queued[city] = 1;
+    active.push_back(city);
+}
+
+// Cities leave the queue (their don't-look bit is set) once neither move
+// improves around them; the endpoints of every applied move are re-queued.
+void IteratedLocalSearch::localSearch() {
+    while (!active.empty()) {
+        int city = active.front();
+        active.pop_front();
+        queued[city] = 0;
+        if (!improveTwoOpt(city)) improveOrOpt(city);
+    }
+}
+
+// 2-opt on the edge from a to its successor or predecessor, trying only
+// neighbours closer to a than the edge being removed.
+bool IteratedLocalSearch::improveTwoOpt(int a) {
+    for (int direction = 0; direction < 2; ++direction) {
+        int b = direction == 0 ? next(a) : prev(a);
+        double removed = dist(a, b);
+        const int* near = neighbours.of(a);
+        for (int j = 0; j < neighbours.k; ++j) {
+            int c = near[j];
+            double added = neighbourDist(a, j);
+            if (added >= removed) break;
+            int d = direction == 0 ? next(c) : prev(c);
+            if (c == b || d == a) continue;
+
+            double delta = added + dist(b, d) - removed - dist(c, d);
+            if (delta < -MIN_GAIN) {
+                twoOptMove(a, b, c, d);
+                length += delta;
+                push(a);
+                push(b);
+                push(c);
+                push(d);
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+// Or-opt: a segment of one to three cities starting or ending at a is cut
+// out and reinserted, in either orientation, next to a neighbour of one of
+// its ends.
+bool IteratedLocalSearch::improveOrOpt(int a) {
+    int n = static_cast<int>(tour.size());
+    for (int segmentLength = 1; segmentLength <= 3 && segmentLength + 3 <= n; ++segmentLength) {
+        for (int side = 0; side < 2; ++side) {
+            int s1 = a;
+            int s2 = a;
+            for (int t = 1; t < segmentLength; ++t) {
+                if (side == 0) s2 = next(s2);
+                else s1 = prev(s1);
+            }
+            int p = prev(s1);
+            int nx = next(s2);
+            double removeGain = dist(p, s1) + dist(s2, nx) - dist(p, nx);
+            if (removeGain <= MIN_GAIN) continue;
+
+            auto inSegment = [&](int city) {
+                for (int c = s1;; c = next(c)) {
+                    if (c == city) return true;
+                    if (c == s2) return false;
+                }
+            };
+
+            for (int endIndex = 0; endIndex < 2; ++endIndex) {
+                int end = endIndex == 0 ? s1 : s2;
+                int other = endIndex == 0 ? s2 : s1;
+                const int* near = neighbours.of(end);
+                for (int j = 0; j < neighbours.k; ++j) {
+                    int c = near[j];
+                    double attach = neighbourDist(end, j);
+                    if (attach >= removeGain) break;
+                    if (inSegment(c)) continue;
+
+                    for (int direction = 0; direction < 2; ++direction) {
+                        int d = direction == 0 ? next(c) : prev(c);
+                        if (inSegment(d)) continue;
+                        double delta = attach + dist(other, d) - dist(c, d) - removeGain;
+                        if (delta >= -MIN_GAIN) continue;
+
+                        // Insert between u and its successor v: two 2-opt moves
+                        // leave the segment there reversed, a third flips it back.
+                        int u = direction == 0 ? c : d;
+                        int v = direction == 0 ? d : c;
+                        int follower = u == c ? end : other;
+                        twoOptMove(p, s1, u, v);
+                        twoOptMove(p, u, nx, s2);
+                        if (follower == s1) twoOptMove(u, s2, s1, v);
+
+                        length += delta;
+                        push(p);
+                        push(nx);
+                        push(s1);
+                        push(s2);
+                        push(u);
+                        push(v);
+                        return true;
+                    }
+                }
+            }
+        }
+    }
+    return false;
+}
+
+// Segment-local double bridge: A B C D -> A C B D with B and C short, so
+// the local search only has to repair a small region.
+void IteratedLocalSearch::kick() {
+    int n = static_cast<int>(tour.size());
+    int limit = std::min(kickSegmentLimit, (n - 2) / 2);
+    std::uniform_int_distribution<int> segment(1, limit);
+    int firstLength = segment(rng);
+    int secondLength = segment(rng);
+    int first = std::uniform_int_distribution<int>(0, n - firstLength - secondLength)(rng);
+    int middle = first + firstLength;
+    int last = middle + secondLength;
+
+    int before = tour[(first + n - 1) % n];
+    int after = tour[last % n];
+    int bFirst = tour[first];
+    int bLast = tour[middle - 1];
+    int cFirst = tour[middle];
+    int cLast = tour[last - 1];
+    length += dist(before, cFirst) + dist(cLast, bFirst) + dist(bLast, after)
+            - dist(before, bFirst) - dist(bLast, cFirst) - dist(cLast, after);
+    rotateRange(first, middle, last);
+
+    push(before);
+    push(after);
+    push(bFirst);
+    push(bLast);
+    push(cFirst);
+    push(cLast);
+}
+
+// Reverses `count` positions starting at `start`, wrapping around the array.
+void IteratedLocalSearch::reverseRange(int start, int count) {
+    if (count < 2) return;
+    int n = static_cast<int>(tour.size());
+    for (int t = 0; t < count / 2; ++t) {
+        int i = (start + t) % n;
+        int j = (start + count - 1 - t) % n;
+        std::swap(tour[i], tour[j]);
+        position[tour[i]] = i;
+        position[tour[j]] = j;
+    }
+    if (journaling) journal.push_back(Operation{OP_REVERSE, start, count, 0});
+}
+
+void IteratedLocalSearch::rotateRange(int first, int middle, int last) {
+    std::rotate(tour.begin() + first, tour.begin() + middle, tour.begin() + last);
+    for (int i = first; i < last; ++i) position[tour[i]] = i;
+    if (journaling) journal.push_back(Operation{OP_ROTATE, first, middle, last});
+}
+
+// Reverses the path from `from` forwards to `to`, or the complementary path
+// when that is shorter; both give the same cycle.
+void IteratedLocalSearch::reversePath(int from, int to) {
+    int n = static_cast<int>(tour.size());
+    int i = position[from];
+    int j = position[to];
+    int inner = (j - i + n) % n + 1;
+    if (2 * inner > n) {
+        reverseRange((j + 1) % n, n - inner);
+    } else {
+        reverseRange(i, inner);
+    }
+}
+
+// Replaces edges (a,b) and (c,d) by (a,c) and (b,d), where b follows a and
+// d follows c in the same direction around the tour (either one).
+void IteratedLocalSearch::twoOptMove(int a, int b, int c, int d) {
+    if (next(a) == b) {
+        reversePath(b, c);
+    } else {
+        reversePath(a, d);
+    }
+}
+
+void IteratedLocalSearch::undoJournal() {
+    bool wasJournaling = journaling;
+    journaling = false;
+    for (size_t k = journal.size(); k-- > 0;) {
+        const Operation& op = journal[k];
+        if (op.kind == OP_REVERSE) {
+            reverseRange(op.first, op.second);
+        } else {
+            rotateRange(op.first, op.first + (op.third - op.second), op.third);
+        }
+    }
+    journal.clear();
+    journaling = wasJournaling;
+}
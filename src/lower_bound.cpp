@@ -0,0 +1,239 @@
+#include "lower_bound.h"
+#include "local_search.h"
+#include "neighbour_lists.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <numeric>
+
+namespace {
+
+const double INFINITE_WEIGHT = std::numeric_limits<double>::max();
+
+int findRoot(std::vector<int>& parent, int city) {
+    while (parent[city] != city) {
+        parent[city] = parent[parent[city]];
+        city = parent[city];
+    }
+    return city;
+}
+
+} // namespace
+
+HeldKarpBound::HeldKarpBound()
+    : neighbourCount(10),
+      maxIterations(1000),
+      verifyInterval(0),
+      denseLimit(20000),
+      upperBound(0.0),
+      cancelled(false),
+      bound(0.0),
+      estimate(0.0),
+      iterations(0) {
+}
+
+void HeldKarpBound::setCoordinates(const double* xs, const double* ys, std::size_t n) {
+    this->xs.assign(xs, xs + n);
+    this->ys.assign(ys, ys + n);
+    bound = 0.0;
+    estimate = 0.0;
+    iterations = 0;
+}
+
+double HeldKarpBound::dist(int a, int b) const {
+    double dx = xs[a] - xs[b];
+    double dy = ys[a] - ys[b];
+    return std::sqrt(dx * dx + dy * dy);
+}
+
+// Undirected k-NN edges, each pair once
+void HeldKarpBound::buildCandidateEdges() {
+    std::size_t n = xs.size();
+    NeighbourLists lists = buildNeighbourLists(xs.data(), ys.data(), n, neighbourCount);
+    edges.clear();
+    for (std::size_t a = 0; a < n; ++a) {
+        for (int j = 0; j < lists.k; ++j) {
+            int b = lists.of(static_cast<int>(a))[j];
+            const int* back = lists.of(b);
+            bool listedBothWays = std::find(back, back + lists.k, static_cast<int>(a)) != back + lists.k;
+            // A mutual pair is added from its lower end only
+            if (!listedBothWays || static_cast<int>(a) < b) {
+                edges.push_back(Edge{static_cast<int>(a), b, dist(static_cast<int>(a), b)});
+            }
+        }
+    }
+}
+
+bool HeldKarpBound::sparseOneTree(double& value) {
+    std::size_t n = xs.size();
+    std::vector<std::pair<double, int>> order;
+    order.reserve(edges.size());
+    // The two cheapest edges at the special city, by edge index
+    int first = -1, second = -1;
+    double firstWeight = INFINITE_WEIGHT, secondWeight = INFINITE_WEIGHT;
+    for (std::size_t e = 0; e < edges.size(); ++e) {
+        double weight = edges[e].length + penalty[edges[e].a] + penalty[edges[e].b];
+        if (edges[e].a != 0 && edges[e].b != 0) {
+            order.push_back(std::make_pair(weight, static_cast<int>(e)));
+        } else if (weight < firstWeight) {
+            second = first;
+            secondWeight = firstWeight;
+            first = static_cast<int>(e);
+            firstWeight = weight;
+        } else if (weight < secondWeight) {
+            second = static_cast<int>(e);
+            secondWeight = weight;
+        }
+    }
+    if (second < 0) return false;
+    std::sort(order.begin(), order.end());
+
+    // Kruskal over cities 1..n-1
+    std::vector<int> parent(n);
+    std::iota(parent.begin(), parent.end(), 0);
+    degree.assign(n, 0);
+    std::size_t joined = 0;
+    double weight = firstWeight + secondWeight;
+    for (int e : {first, second}) {
+        ++degree[edges[e].a];
+        ++degree[edges[e].b];
+    }
+    for (const auto& entry : order) {
+        const Edge& edge = edges[entry.second];
+        int ra = findRoot(parent, edge.a);
+        int rb = findRoot(parent, edge.b);
+        if (ra == rb) continue;
+        parent[ra] = rb;
+        weight += entry.first;
+        ++degree[edge.a];
+        ++degree[edge.b];
+        if (++joined == n - 2) break;
+    }
+    if (joined != n - 2) return false;
+
+    value = weight - 2.0 * std::accumulate(penalty.begin(), penalty.end(), 0.0);
+    return true;
+}
+
+// Prim on the complete graph over cities 1..n-1
+double HeldKarpBound::denseOneTree() {
+    int n = static_cast<int>(xs.size());
+    std::vector<double> key(n, INFINITE_WEIGHT);
+    std::vector<int> from(n, -1);
+    std::vector<char> inTree(n, 0);
+    degree.assign(n, 0);
+    double weight = 0.0;
+    key[1] = 0.0;
+    for (int step = 1; step < n; ++step) {
+        int city = -1;
+        for (int c = 1; c < n; ++c) {
+            if (!inTree[c] && (city < 0 || key[c] < key[city])) city = c;
+        }
+        inTree[city] = 1;
+        if (from[city] >= 0) {
+            weight += key[city];
+            ++degree[city];
+            ++degree[from[city]];
+        }
+        for (int c = 1; c < n; ++c) {
+            if (inTree[c]) continue;
+            double w = dist(city, c) + penalty[city] + penalty[c];
+            if (w < key[c]) {
+                key[c] = w;
+                from[c] = city;
+            }
+        }
+    }
+
+    int first = -1, second = -1;
+    for (int c = 1; c < n; ++c) {
+        double w = dist(0, c) + penalty[0] + penalty[c];
+        if (first < 0 || w < dist(0, first) + penalty[0] + penalty[first]) {
+            second = first;
+            first = c;
+        } else if (second < 0 || w < dist(0, second) + penalty[0] + penalty[second]) {
+            second = c;
+        }
+    }
+    weight += dist(0, first) + dist(0, second) + 2.0 * penalty[0] + penalty[first] + penalty[second];
+    degree[0] = 2;
+    ++degree[first];
+    ++degree[second];
+    return weight - 2.0 * std::accumulate(penalty.begin(), penalty.end(), 0.0);
+}
+
+void HeldKarpBound::verify() {
+    if (xs.size() > denseLimit) return;
+    // The dense pass reuses degree, which the ascent still needs
+    std::vector<int> ascentDegree = degree;
+    double value = denseOneTree();
+    degree.swap(ascentDegree);
+    if (value > bound.load()) bound = value;
+}
+
+double HeldKarpBound::compute() {
+    std::size_t n = xs.size();
+    cancelled = false;
+    bound = 0.0;
+    estimate = 0.0;
+    iterations = 0;
+    if (n < 3) {
+        // One or two cities: the tour is the bound
+        double length = n == 2 ? 2.0 * dist(0, 1) : 0.0;
+        bound = length;
+        estimate = length;
+        return length;
+    }
+
+    double target = upperBound;
+    if (target <= 0.0) {
+        IteratedLocalSearch search;
+        search.setMaxKicks(0);
+        search.setCoordinates(xs, ys);
+        search.step();
+        target = search.getLength();
+    }
+
+    buildCandidateEdges();
+    penalty.assign(n, 0.0);
+    std::vector<double> bestPenalty = penalty;
+    double lambda = 2.0;
+    int sinceImprovement = 0;
+    int period = std::max(10, static_cast<int>(n / 50));
+    // Auto interval: a dense check costs about as much as n/10 sparse iterations
+    int verifyEvery = verifyInterval > 0 ? verifyInterval : std::max(100, static_cast<int>(n / 10));
+    for (int iteration = 0; iteration < maxIterations && !cancelled; ++iteration) {
+        double value;
+        bool connected = sparseOneTree(value);
+        if (!connected) {
+            // Clustered instances: fall back to the complete graph
+            if (n > denseLimit) break;
+            value = denseOneTree();
+        }
+        iterations = iteration + 1;
+        if (!connected && value > bound.load()) bound = value;
+        if (value > estimate.load()) {
+            estimate = value;
+            bestPenalty = penalty;
+            sinceImprovement = 0;
+        } else if (++sinceImprovement >= period) {
+            lambda /= 2.0;
+            sinceImprovement = 0;
+        }
+
+        double norm = 0.0;
+        for (std::size_t i = 0; i < n; ++i) norm += static_cast<double>(degree[i] - 2) * (degree[i] - 2);
+        // A 1-tree with all degrees 2 is an optimal tour
+        if (norm == 0.0 || lambda < 1e-6 || value >= target) break;
+        if ((iteration + 1) % verifyEvery == 0) verify();
+
+        double step = lambda * (target - value) / norm;
+        for (std::size_t i = 0; i < n; ++i) penalty[i] += step * (degree[i] - 2);
+    }
+
+    if (!cancelled) {
+        penalty = bestPenalty;
+        verify();
+    }
+    return bound.load();
+}
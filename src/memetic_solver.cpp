@@ -0,0 +1,499 @@
+#include "memetic_solver.h"
+#include "exact_solver.h"
+#include "local_search.h"
+#include "parallel_for.h"
+#include "window_annealer.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+namespace {
+
+// Children within this of a member's length count as copies of it
+const double DUPLICATE_TOLERANCE = 1e-7;
+
+// Replaces `from` by `to` among a's two tour neighbours
+inline void relink(int* link, int a, int from, int to) {
+    if (link[2 * a] == from) {
+        link[2 * a] = to;
+    } else {
+        link[2 * a + 1] = to;
+    }
+}
+
+// Neighbour lists of the edges one parent has and the other lacks
+void differingEdges(const int* linkA, const int* linkB, int n, std::vector<int>& only) {
+    only.assign(2 * static_cast<std::size_t>(n), -1);
+    for (int v = 0; v < n; ++v) {
+        for (int side = 0; side < 2; ++side) {
+            int w = linkA[2 * v + side];
+            if (w != linkB[2 * v] && w != linkB[2 * v + 1]) only[2 * v + side] = w;
+        }
+    }
+}
+
+void removeEdge(std::vector<int>& only, int u, int w) {
+    for (int side = 0; side < 2; ++side) {
+        if (only[2 * u + side] == w) {
+            only[2 * u + side] = -1;
+            break;
+        }
+    }
+    for (int side = 0; side < 2; ++side) {
+        if (only[2 * w + side] == u) {
+            only[2 * w + side] = -1;
+            break;
+        }
+    }
+}
+
+} // namespace
+
+const char* crossoverName(Crossover crossover) {
+    switch (crossover) {
+        case Crossover::Order: return "ox";
+        case Crossover::EdgeRecombination: return "erx";
+        default: return "eax";
+    }
+}
+
+bool parseCrossover(const char* name, Crossover& crossover) {
+    const Crossover crossovers[] = {Crossover::EdgeAssembly, Crossover::Order, Crossover::EdgeRecombination};
+    for (Crossover candidate : crossovers) {
+        if (std::strcmp(name, crossoverName(candidate)) == 0) {
+            crossover = candidate;
+            return true;
+        }
+    }
+    return false;
+}
+
+MemeticSolver::MemeticSolver()
+    : bestLength(0.0),
+      populationSize(30),
+      crossover(Crossover::EdgeAssembly),
+      polish(MemeticPolish::LocalSearch),
+      polishIterations(20),
+      maxGenerations(300),
+      stagnationLimit(30),
+      threadCount(0),
+      seed(1),
+      neighbourCount(10),
+      exactLimit(16),
+      initialised(false),
+      generation(0),
+      stagnantGenerations(0),
+      improvingOffspring(0) {
+}
+
+void MemeticSolver::setCoordinates(const std::vector<double>& xs, const std::vector<double>& ys) {
+    this->xs = xs;
+    this->ys = ys;
+    neighbours = buildNeighbourLists(xs.data(), ys.data(), xs.size(), neighbourCount);
+    reset();
+}
+
+void MemeticSolver::reset() {
+    std::size_t n = xs.size();
+    pool.assign(2 * static_cast<std::size_t>(populationSize) * n, 0);
+    lengths.assign(2 * static_cast<std::size_t>(populationSize), 0.0);
+    bestTour.clear();
+    bestLength = 0.0;
+    rng.seed(seed);
+    initialised = false;
+    generation = 0;
+    stagnantGenerations = 0;
+    improvingOffspring = 0;
+}
+
+double MemeticSolver::dist(int a, int b) const {
+    double dx = xs[a] - xs[b];
+    double dy = ys[a] - ys[b];
+    return std::sqrt(dx * dx + dy * dy);
+}
+
+double MemeticSolver::length(const int* tour) const {
+    std::size_t n = xs.size();
+    double total = 0.0;
+    for (std::size_t i = 0; i < n; ++i) total += dist(tour[i], tour[i + 1 == n ? 0 : i + 1]);
+    return total;
+}
+
+double MemeticSolver::getMeanLength() const {
+    if (!initialised) return 0.0;
+    double total = 0.0;
+    for (int i = 0; i < populationSize; ++i) total += lengths[i];
+    return total / populationSize;
+}
+
+template<typename Body>
+void MemeticSolver::forEachSlot(int first, int count, Body body) {
+    int workers = std::max(1, std::min(resolveWorkerCount(threadCount), count));
+    // Slots are dealt out round-robin, so every worker gets a similar mix
+    parallelFor(static_cast<std::size_t>(workers), workers, [&](std::size_t worker) {
+        IteratedLocalSearch engine;
+        engine.setNeighbourCount(neighbourCount);
+        engine.setMaxKicks(0);
+        engine.setCoordinates(xs, ys);
+        std::vector<int> tour(xs.size());
+        for (int index = first + static_cast<int>(worker); index < first + count; index += workers) {
+            std::mt19937 random(seed ^ (static_cast<unsigned>(generation) * 2654435761u + static_cast<unsigned>(index) * 40503u));
+            int* target = slot(index);
+            body(target, random);
+
+            if (polish == MemeticPolish::LocalSearch || generation == 0) {
+                tour.assign(target, target + xs.size());
+                engine.setTour(tour);
+                engine.step();
+                std::copy(engine.getTour().begin(), engine.getTour().end(), target);
+            } else {
+                WindowAnnealParams params;
+                params.iterations = static_cast<long>(polishIterations) * static_cast<long>(xs.size());
+                double meanEdge = length(target) / static_cast<double>(xs.size());
+                params.startTemperature = 0.05 * meanEdge;
+                params.endTemperature = 0.001 * meanEdge;
+                annealWindow(xs.data(), ys.data(), target, xs.size(), 0, xs.size(), params, random);
+            }
+            lengths[index] = length(target);
+        }
+    });
+}
+
+bool MemeticSolver::step() {
+    std::size_t n = xs.size();
+    if (n < 8 || n <= static_cast<std::size_t>(exactLimit)) {
+        if (initialised || n < 2) {
+            initialised = true;
+            return false;
+        }
+        ExactSolver exact;
+        exact.setCoordinates(xs.data(), ys.data(), n);
+        exact.setDynamicProgrammingLimit(std::max(exactLimit, 7));
+        bestTour = exact.solve();
+        bestLength = exact.getLength();
+        initialised = true;
+        return false;
+    }
+
+    if (!initialised) {
+        // Random tours, polished by local search whatever the polish setting
+        forEachSlot(0, populationSize, [&](int* target, std::mt19937& random) {
+            for (std::size_t i = 0; i < n; ++i) target[i] = static_cast<int>(i);
+            std::shuffle(target, target + n, random);
+        });
+        initialised = true;
+        updateBest();
+        generation = 1;
+        return true;
+    }
+    if ((maxGenerations > 0 && generation > maxGenerations) || (stagnationLimit > 0 && stagnantGenerations >= stagnationLimit)) {
+        return false;
+    }
+
+    std::vector<int> order(populationSize);
+    for (int i = 0; i < populationSize; ++i) order[i] = i;
+    std::shuffle(order.begin(), order.end(), rng);
+    forEachSlot(populationSize, populationSize, [&](int* target, std::mt19937& random) {
+        int k = static_cast<int>((target - pool.data()) / static_cast<std::ptrdiff_t>(n)) - populationSize;
+        const int* a = slot(order[k]);
+        const int* b = slot(order[(k + 1) % populationSize]);
+        switch (crossover) {
+            case Crossover::Order: orderCrossover(a, b, target, random); break;
+            case Crossover::EdgeRecombination: edgeRecombination(a, b, target, random); break;
+            default: edgeAssembly(a, b, target, random); break;
+        }
+    });
+
+    // Each child competes with the parent it was built on
+    double before = bestLength;
+    for (int k = 0; k < populationSize; ++k) {
+        int parent = order[k];
+        int child = populationSize + k;
+        if (lengths[child] >= lengths[parent] - DUPLICATE_TOLERANCE) continue;
+        bool duplicate = false;
+        for (int i = 0; i < populationSize && !duplicate; ++i) duplicate = std::abs(lengths[i] - lengths[child]) < DUPLICATE_TOLERANCE;
+        if (duplicate) continue;
+        std::copy(slot(child), slot(child) + n, slot(parent));
+        lengths[parent] = lengths[child];
+        ++improvingOffspring;
+    }
+    updateBest();
+    stagnantGenerations = bestLength < before - DUPLICATE_TOLERANCE ? 0 : stagnantGenerations + 1;
+    ++generation;
+    return true;
+}
+
+void MemeticSolver::updateBest() {
+    int best = 0;
+    for (int i = 1; i < populationSize; ++i) {
+        if (lengths[i] < lengths[best]) best = i;
+    }
+    if (bestTour.empty() || lengths[best] < bestLength) {
+        bestTour.assign(slot(best), slot(best) + xs.size());
+        bestLength = lengths[best];
+    }
+}
+
+// EAX with a single random AB-cycle: the differing edges of the parents
+// are split into cycles alternating between an edge of a and one of b;
+// swapping one cycle's a-edges for its b-edges leaves every city with two
+// neighbours, possibly in several subtours, which are then joined smallest
+// first by the cheapest 2-exchange with a listed neighbour.
+void MemeticSolver::edgeAssembly(const int* a, const int* b, int* child, std::mt19937& random) const {
+    int n = static_cast<int>(xs.size());
+    std::vector<int> link(2 * static_cast<std::size_t>(n)), linkB(2 * static_cast<std::size_t>(n));
+    for (int i = 0; i < n; ++i) {
+        int previous = i == 0 ? n - 1 : i - 1;
+        int next = i + 1 == n ? 0 : i + 1;
+        link[2 * a[i]] = a[previous];
+        link[2 * a[i] + 1] = a[next];
+        linkB[2 * b[i]] = b[previous];
+        linkB[2 * b[i] + 1] = b[next];
+    }
+    std::vector<int> onlyA, onlyB;
+    differingEdges(link.data(), linkB.data(), n, onlyA);
+    differingEdges(linkB.data(), link.data(), n, onlyB);
+
+    // Walk alternately along a-only and b-only edges; whenever the walk
+    // returns to a city through the opposite kind of edge to the one it
+    // left by, the loop in between is an AB-cycle
+    std::vector<std::vector<int>> cycles;
+    std::vector<char> startsWithA;
+    std::vector<int> path;
+    std::vector<int> visits(4 * static_cast<std::size_t>(n), -1);
+    auto forget = [&](int city, int position) {
+        for (int s = 0; s < 4; ++s) {
+            if (visits[4 * city + s] == position) visits[4 * city + s] = -1;
+        }
+    };
+    int scan = static_cast<int>(random() % static_cast<unsigned>(n));
+    for (int scanned = 0; scanned <= n;) {
+        if (path.empty()) {
+            while (scanned < n && onlyA[2 * scan] < 0 && onlyA[2 * scan + 1] < 0) {
+                scan = scan + 1 == n ? 0 : scan + 1;
+                ++scanned;
+            }
+            if (scanned >= n) break;
+            path.push_back(scan);
+            visits[4 * scan] = 0;
+        }
+        int edges = static_cast<int>(path.size()) - 1;
+        bool needA = edges % 2 == 0;
+        std::vector<int>& only = needA ? onlyA : onlyB;
+        int current = path.back();
+        int choices[2], count = 0;
+        for (int side = 0; side < 2; ++side) {
+            if (only[2 * current + side] >= 0) choices[count++] = only[2 * current + side];
+        }
+        if (count == 0) {
+            // Dead end (the walk's edges are dropped); start a fresh walk
+            for (int p = 0; p < static_cast<int>(path.size()); ++p) forget(path[p], p);
+            path.clear();
+            continue;
+        }
+        int next = choices[count == 2 ? random() % 2 : 0];
+        removeEdge(only, current, next);
+
+        int closesAt = -1;
+        for (int s = 0; s < 4 && closesAt < 0; ++s) {
+            int position = visits[4 * next + s];
+            if (position >= 0 && (position % 2 == 0) != needA) closesAt = position;
+        }
+        if (closesAt < 0) {
+            path.push_back(next);
+            for (int s = 0; s < 4; ++s) {
+                if (visits[4 * next + s] < 0) {
+                    visits[4 * next + s] = edges + 1;
+                    break;
+                }
+            }
+            continue;
+        }
+        cycles.push_back(std::vector<int>(path.begin() + closesAt, path.end()));
+        startsWithA.push_back(closesAt % 2 == 0);
+        for (int p = closesAt + 1; p < static_cast<int>(path.size()); ++p) forget(path[p], p);
+        path.resize(closesAt + 1);
+    }
+    if (cycles.empty()) {
+        std::copy(a, a + n, child);
+        return;
+    }
+
+    // Swap one cycle's a-edges for its b-edges
+    std::size_t chosen = random() % cycles.size();
+    const std::vector<int>& cycle = cycles[chosen];
+    int size = static_cast<int>(cycle.size());
+    for (int pass = 0; pass < 2; ++pass) {
+        for (int j = 0; j < size; ++j) {
+            bool isA = (j % 2 == 0) == static_cast<bool>(startsWithA[chosen]);
+            int u = cycle[j], w = cycle[(j + 1) % size];
+            if (pass == 0 && isA) {
+                relink(link.data(), u, w, -1);
+                relink(link.data(), w, u, -1);
+            } else if (pass == 1 && !isA) {
+                relink(link.data(), u, -1, w);
+                relink(link.data(), w, -1, u);
+            }
+        }
+    }
+
+    // Label the subtours, then merge the smallest into a neighbour's
+    std::vector<int> component(n, -1);
+    std::vector<std::vector<int>> members;
+    for (int start = 0; start < n; ++start) {
+        if (component[start] >= 0) continue;
+        int label = static_cast<int>(members.size());
+        members.push_back(std::vector<int>());
+        int previous = -1, current = start;
+        do {
+            component[current] = label;
+            members[label].push_back(current);
+            int next = link[2 * current] != previous ? link[2 * current] : link[2 * current + 1];
+            previous = current;
+            current = next;
+        } while (current != start);
+    }
+    int remaining = static_cast<int>(members.size());
+    while (remaining > 1) {
+        int smallest = -1;
+        for (int c = 0; c < static_cast<int>(members.size()); ++c) {
+            if (!members[c].empty() && (smallest < 0 || members[c].size() < members[smallest].size())) smallest = c;
+        }
+        double bestCost = std::numeric_limits<double>::max();
+        int bu = -1, bu2 = -1, bv = -1, bv2 = -1;
+        bool crossed = false;
+        auto consider = [&](int u, int v) {
+            for (int us = 0; us < 2; ++us) {
+                int u2 = link[2 * u + us];
+                for (int vs = 0; vs < 2; ++vs) {
+                    int v2 = link[2 * v + vs];
+                    double removed = dist(u, u2) + dist(v, v2);
+                    double straight = dist(u, v) + dist(u2, v2) - removed;
+                    double cross = dist(u, v2) + dist(u2, v) - removed;
+                    if (straight < bestCost || cross < bestCost) {
+                        crossed = cross < straight;
+                        bestCost = std::min(straight, cross);
+                        bu = u;
+                        bu2 = u2;
+                        bv = v;
+                        bv2 = v2;
+                    }
+                }
+            }
+        };
+        for (int u : members[smallest]) {
+            const int* near = neighbours.of(u);
+            for (int j = 0; j < neighbours.k; ++j) {
+                if (component[near[j]] != smallest) consider(u, near[j]);
+            }
+        }
+        if (bu < 0) {
+            // No listed neighbour outside: every city is a candidate
+            for (int v = 0; v < n; ++v) {
+                if (component[v] != smallest) consider(members[smallest][0], v);
+            }
+        }
+        if (crossed) {
+            relink(link.data(), bu, bu2, bv2);
+            relink(link.data(), bu2, bu, bv);
+            relink(link.data(), bv, bv2, bu2);
+            relink(link.data(), bv2, bv, bu);
+        } else {
+            relink(link.data(), bu, bu2, bv);
+            relink(link.data(), bu2, bu, bv2);
+            relink(link.data(), bv, bv2, bu);
+            relink(link.data(), bv2, bv, bu2);
+        }
+        int target = component[bv];
+        for (int city : members[smallest]) component[city] = target;
+        members[target].insert(members[target].end(), members[smallest].begin(), members[smallest].end());
+        members[smallest].clear();
+        --remaining;
+    }
+
+    int previous = -1, current = 0;
+    for (int i = 0; i < n; ++i) {
+        child[i] = current;
+        int next = link[2 * current] != previous ? link[2 * current] : link[2 * current + 1];
+        previous = current;
+        current = next;
+    }
+}
+
+void MemeticSolver::orderCrossover(const int* a, const int* b, int* child, std::mt19937& random) const {
+    int n = static_cast<int>(xs.size());
+    int first = static_cast<int>(random() % static_cast<unsigned>(n));
+    int last = static_cast<int>(random() % static_cast<unsigned>(n));
+    if (first > last) std::swap(first, last);
+    std::vector<char> used(n, 0);
+    for (int i = first; i <= last; ++i) {
+        child[i] = a[i];
+        used[a[i]] = 1;
+    }
+    int write = (last + 1) % n;
+    for (int k = 0; k < n; ++k) {
+        int city = b[(last + 1 + k) % n];
+        if (used[city]) continue;
+        child[write] = city;
+        write = (write + 1) % n;
+    }
+}
+
+void MemeticSolver::edgeRecombination(const int* a, const int* b, int* child, std::mt19937& random) const {
+    int n = static_cast<int>(xs.size());
+    // Up to four distinct neighbours per city from the two parents
+    std::vector<int> edges(4 * static_cast<std::size_t>(n), -1);
+    std::vector<int> degree(n, 0);
+    auto add = [&](int u, int v) {
+        for (int s = 0; s < degree[u]; ++s) {
+            if (edges[4 * u + s] == v) return;
+        }
+        edges[4 * u + degree[u]++] = v;
+    };
+    for (int i = 0; i < n; ++i) {
+        int next = i + 1 == n ? 0 : i + 1;
+        add(a[i], a[next]);
+        add(a[next], a[i]);
+        add(b[i], b[next]);
+        add(b[next], b[i]);
+    }
+    auto drop = [&](int u, int v) {
+        for (int s = 0; s < degree[u]; ++s) {
+            if (edges[4 * u + s] == v) {
+                edges[4 * u + s] = edges[4 * u + --degree[u]];
+                return;
+            }
+        }
+    };
+
+    // Unvisited cities, for the random restart when a walk gets stuck
+    std::vector<int> unvisited(n), slotOf(n);
+    for (int i = 0; i < n; ++i) unvisited[i] = slotOf[i] = i;
+    auto visit = [&](int city) {
+        int last = unvisited.back();
+        unvisited[slotOf[city]] = last;
+        slotOf[last] = slotOf[city];
+        unvisited.pop_back();
+        for (int s = 0; s < degree[city]; ++s) drop(edges[4 * city + s], city);
+    };
+
+    int current = a[0];
+    for (int i = 0; i < n; ++i) {
+        child[i] = current;
+        visit(current);
+        if (unvisited.empty()) break;
+        int next = -1, fewest = 5, ties = 0;
+        for (int s = 0; s < degree[current]; ++s) {
+            int candidate = edges[4 * current + s];
+            if (degree[candidate] < fewest) {
+                fewest = degree[candidate];
+                next = candidate;
+                ties = 1;
+            } else if (degree[candidate] == fewest && random() % ++ties == 0) {
+                next = candidate;
+            }
+        }
+        current = next >= 0 ? next : unvisited[random() % unvisited.size()];
+    }
+}
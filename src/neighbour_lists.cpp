@@ -0,0 +1,155 @@
+#include "neighbour_lists.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <utility>
+
+namespace {
+
+inline double squaredDistance(const double* xs, const double* ys, int a, int b) {
+    double dx = xs[a] - xs[b];
+    double dy = ys[a] - ys[b];
+    return dx * dx + dy * dy;
+}
+
+// Exact k nearest of one city by a full scan, nearest first
+void scanNeighbours(const double* xs, const double* ys, std::size_t n, int k, int city, int* out) {
+    std::vector<std::pair<double, int>> all;
+    all.reserve(n);
+    for (std::size_t other = 0; other < n; ++other) {
+        if (static_cast<int>(other) != city) {
+            all.push_back(std::make_pair(squaredDistance(xs, ys, city, static_cast<int>(other)), static_cast<int>(other)));
+        }
+    }
+    std::partial_sort(all.begin(), all.begin() + k, all.end());
+    for (int j = 0; j < k; ++j) out[j] = all[j].second;
+}
+
+int clampedCount(std::size_t n, int k) {
+    return static_cast<int>(std::min<std::size_t>(k < 0 ? 0 : static_cast<std::size_t>(k), n > 0 ? n - 1 : 0));
+}
+
+} // namespace
+
+NeighbourLists buildNeighbourLists(const double* xs, const double* ys, std::size_t n, int k) {
+    NeighbourLists lists;
+    lists.k = clampedCount(n, k);
+    lists.indices.resize(n * lists.k);
+    if (lists.k == 0) return lists;
+
+    double minX = std::numeric_limits<double>::max(), maxX = -minX;
+    double minY = minX, maxY = -minX;
+    for (std::size_t i = 0; i < n; ++i) {
+        minX = std::min(minX, xs[i]);
+        maxX = std::max(maxX, xs[i]);
+        minY = std::min(minY, ys[i]);
+        maxY = std::max(maxY, ys[i]);
+    }
+    int side = std::max(1, static_cast<int>(std::sqrt(static_cast<double>(n) / 2.0)));
+    double cellW = std::max((maxX - minX) / side, 1e-12);
+    double cellH = std::max((maxY - minY) / side, 1e-12);
+    auto cellOf = [&](double v, double lo, double size) {
+        return std::min(side - 1, static_cast<int>((v - lo) / size));
+    };
+
+    // Counting sort of the cities into cells
+    std::vector<int> cellStart(static_cast<std::size_t>(side) * side + 1, 0);
+    std::vector<int> cellCities(n);
+    std::vector<int> cityCell(n);
+    for (std::size_t i = 0; i < n; ++i) {
+        cityCell[i] = cellOf(ys[i], minY, cellH) * side + cellOf(xs[i], minX, cellW);
+        cellStart[cityCell[i] + 1]++;
+    }
+    for (std::size_t c = 1; c < cellStart.size(); ++c) cellStart[c] += cellStart[c - 1];
+    std::vector<int> fill(cellStart.begin(), cellStart.end() - 1);
+    for (std::size_t i = 0; i < n; ++i) cellCities[fill[cityCell[i]]++] = static_cast<int>(i);
+
+    // Max-heap on squared distance holding the best k found so far
+    std::vector<std::pair<double, int>> heap;
+    heap.reserve(lists.k + 1);
+    double ringStep = std::min(cellW, cellH);
+    for (std::size_t i = 0; i < n; ++i) {
+        heap.clear();
+        int cx = cityCell[i] % side;
+        int cy = cityCell[i] / side;
+        for (int ring = 0; ring < side; ++ring) {
+            for (int y = std::max(0, cy - ring); y <= std::min(side - 1, cy + ring); ++y) {
+                bool edgeRow = y == cy - ring || y == cy + ring;
+                for (int x = std::max(0, cx - ring); x <= std::min(side - 1, cx + ring); ++x) {
+                    if (!edgeRow && x != cx - ring && x != cx + ring) continue;
+                    int cell = y * side + x;
+                    for (int s = cellStart[cell]; s < cellStart[cell + 1]; ++s) {
+                        int other = cellCities[s];
+                        if (other == static_cast<int>(i)) continue;
+                        double dx = xs[other] - xs[i];
+                        double dy = ys[other] - ys[i];
+                        double d2 = dx * dx + dy * dy;
+                        if (static_cast<int>(heap.size()) < lists.k) {
+                            heap.push_back(std::make_pair(d2, other));
+                            std::push_heap(heap.begin(), heap.end());
+                        } else if (d2 < heap.front().first) {
+                            std::pop_heap(heap.begin(), heap.end());
+                            heap.back() = std::make_pair(d2, other);
+                            std::push_heap(heap.begin(), heap.end());
+                        }
+                    }
+                }
+            }
+            // Anything outside the rings searched so far is at least this far away
+            double reach = ring * ringStep;
+            if (static_cast<int>(heap.size()) == lists.k && reach * reach >= heap.front().first) break;
+        }
+        std::sort_heap(heap.begin(), heap.end());
+        int* out = lists.indices.data() + i * lists.k;
+        for (int j = 0; j < lists.k; ++j) out[j] = heap[j].second;
+    }
+    return lists;
+}
+
+void appendToNeighbourLists(NeighbourLists& lists, const double* xs, const double* ys, std::size_t n, int k) {
+    if (lists.k != clampedCount(n, k) || lists.indices.size() != (n - 1) * lists.k) {
+        lists = buildNeighbourLists(xs, ys, n, k);
+        return;
+    }
+    int added = static_cast<int>(n) - 1;
+    lists.indices.resize(n * lists.k);
+    scanNeighbours(xs, ys, n, lists.k, added, lists.indices.data() + static_cast<std::size_t>(added) * lists.k);
+
+    for (int city = 0; city < added; ++city) {
+        int* list = lists.indices.data() + static_cast<std::size_t>(city) * lists.k;
+        double d2 = squaredDistance(xs, ys, city, added);
+        if (d2 >= squaredDistance(xs, ys, city, list[lists.k - 1])) continue;
+        int slot = lists.k - 1;
+        while (slot > 0 && d2 < squaredDistance(xs, ys, city, list[slot - 1])) {
+            list[slot] = list[slot - 1];
+            --slot;
+        }
+        list[slot] = added;
+    }
+}
+
+void removeFromNeighbourLists(NeighbourLists& lists, const double* xs, const double* ys, std::size_t n, int k,
+                              int removed) {
+    if (lists.k != clampedCount(n, k) || lists.indices.size() != (n + 1) * lists.k) {
+        lists = buildNeighbourLists(xs, ys, n, k);
+        return;
+    }
+    std::vector<int> stale;
+    std::size_t write = 0;
+    for (std::size_t city = 0; city <= n; ++city) {
+        if (static_cast<int>(city) == removed) continue;
+        const int* list = lists.indices.data() + city * lists.k;
+        bool heldRemoved = false;
+        for (int j = 0; j < lists.k; ++j) {
+            int other = list[j];
+            heldRemoved = heldRemoved || other == removed;
+            lists.indices[write * lists.k + j] = other > removed ? other - 1 : other;
+        }
+        if (heldRemoved) stale.push_back(static_cast<int>(write));
+        ++write;
+    }
+    lists.indices.resize(n * lists.k);
+    for (int city : stale) {
+        scanNeighbours(xs, ys, n, lists.k, city, lists.indices.data() + static_cast<std::size_t>(city) * lists.k);
+    }
+}
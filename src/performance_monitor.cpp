@@ -0,0 +1,84 @@
+#include "performance_monitor.h"
+
+const double PerformanceMonitor::HISTOGRAM_LIMITS_MS[PerformanceMonitor::HISTOGRAM_BUCKETS - 1] = {
+    8.0, 12.0, 17.0, 20.0, 25.0, 33.0, 50.0
+};
+
+PerformanceMonitor::PerformanceMonitor(std::size_t capacity)
+    : samples(capacity < 1 ? 1 : capacity),
+      head(0),
+      count(0) {
+}
+
+void PerformanceMonitor::recordFrame(const FrameSample& sample) {
+    if (count == samples.size()) {
+        const FrameSample& oldest = samples[head];
+        totals.moves -= oldest.moves;
+        totals.accepted -= oldest.accepted;
+        totals.solveSeconds -= oldest.solveSeconds;
+        totals.renderSeconds -= oldest.renderSeconds;
+        totals.frameSeconds -= oldest.frameSeconds;
+    } else {
+        ++count;
+    }
+    samples[head] = sample;
+    head = head + 1 == samples.size() ? 0 : head + 1;
+    totals.moves += sample.moves;
+    totals.accepted += sample.accepted;
+    totals.solveSeconds += sample.solveSeconds;
+    totals.renderSeconds += sample.renderSeconds;
+    totals.frameSeconds += sample.frameSeconds;
+
+    // Re-summed once per lap so rounding in the running totals cannot drift
+    if (head == 0) {
+        totals = FrameSample();
+        for (const FrameSample& held : samples) {
+            totals.moves += held.moves;
+            totals.accepted += held.accepted;
+            totals.solveSeconds += held.solveSeconds;
+            totals.renderSeconds += held.renderSeconds;
+            totals.frameSeconds += held.frameSeconds;
+        }
+    }
+}
+
+void PerformanceMonitor::clear() {
+    head = 0;
+    count = 0;
+    totals = FrameSample();
+}
+
+const FrameSample& PerformanceMonitor::getSample(std::size_t index) const {
+    std::size_t oldest = (head + samples.size() - count) % samples.size();
+    return samples[(oldest + index) % samples.size()];
+}
+
+double PerformanceMonitor::getMovesPerSecond() const {
+    return totals.frameSeconds > 0.0 ? totals.moves / totals.frameSeconds : 0.0;
+}
+
+double PerformanceMonitor::getAcceptanceRate() const {
+    return totals.moves > 0 ? static_cast<double>(totals.accepted) / totals.moves : 0.0;
+}
+
+double PerformanceMonitor::getSolveShare() const {
+    return totals.frameSeconds > 0.0 ? totals.solveSeconds / totals.frameSeconds : 0.0;
+}
+
+double PerformanceMonitor::getRenderShare() const {
+    return totals.frameSeconds > 0.0 ? totals.renderSeconds / totals.frameSeconds : 0.0;
+}
+
+double PerformanceMonitor::getMeanFrameSeconds() const {
+    return count > 0 ? totals.frameSeconds / count : 0.0;
+}
+
+void PerformanceMonitor::getFrameHistogram(std::vector<int>& counts) const {
+    counts.assign(HISTOGRAM_BUCKETS, 0);
+    for (std::size_t i = 0; i < count; ++i) {
+        double milliseconds = getSample(i).frameSeconds * 1000.0;
+        int bucket = 0;
+        while (bucket < HISTOGRAM_BUCKETS - 1 && milliseconds >= HISTOGRAM_LIMITS_MS[bucket]) ++bucket;
+        counts[bucket]++;
+    }
+}
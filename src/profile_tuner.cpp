@@ -0,0 +1,144 @@
+#include "profile_tuner.h"
+#include "ils_solver.h"
+#include "parallel_for.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <limits>
+#include <numeric>
+#include <ostream>
+#include <random>
+#include <stdexcept>
+
+namespace {
+
+const int CALIBRATION_BUDGET = 20;
+
+double logUniform(std::mt19937& rng, double lo, double hi) {
+    return std::exp(std::uniform_real_distribution<double>(std::log(lo), std::log(hi))(rng));
+}
+
+} // namespace
+
+ProfileTuner::ProfileTuner()
+    : configurationCount(27),
+      eta(3),
+      budgetSeconds(60.0),
+      threadCount(0),
+      mode(SolverMode::Annealing),
+      seed(1),
+      log(nullptr),
+      bestScore(0.0),
+      rungCount(0) {
+}
+
+std::vector<SolverProfile> ProfileTuner::sampleConfigurations() const {
+    static const int STEPS[] = {1, 2, 5, 10, 20, 50, 100};
+    std::mt19937 rng(seed);
+    std::vector<SolverProfile> configurations(1);
+    while (static_cast<int>(configurations.size()) < configurationCount) {
+        SolverProfile profile;
+        profile.temperatureFactor = logUniform(rng, 0.05, 20.0);
+        profile.minTemperatureFactor = logUniform(rng, 1e-4, 1e-2);
+        profile.iterationsPerTemperature = STEPS[std::uniform_int_distribution<int>(0, 6)(rng)];
+        profile.coolingRate = 1.0 - logUniform(rng, 1e-6, 1e-2);
+        profile.swapWeight = std::uniform_real_distribution<double>(0.0, 1.0)(rng);
+        profile.segmentWeight = 1.0 - profile.swapWeight;
+        profile.neighbourCount = std::uniform_int_distribution<int>(5, 16)(rng);
+        configurations.push_back(profile);
+    }
+    return configurations;
+}
+
+double ProfileTuner::evaluate(const SolverProfile& profile, size_t instance, int budget) const {
+    const std::vector<City>& cities = instances[instance];
+    SolverProfile run = profile;
+    run.iterationsPerCity = budget;
+    // Same seed for every configuration, so they race on equal terms
+    unsigned runSeed = seed + static_cast<unsigned>(instance);
+    if (mode == SolverMode::Annealing) {
+        TSPSolver solver;
+        solver.setCities(cities);
+        solver.applyProfile(run);
+        solver.setSeed(runSeed);
+        return solver.solve().distance;
+    }
+    ILSSolver solver;
+    solver.setHybrid(mode == SolverMode::Hybrid);
+    solver.setCities(cities);
+    solver.applyProfile(run);
+    solver.setMaxKicks(std::max(1L, static_cast<long>(budget) * static_cast<long>(cities.size()) / 100));
+    solver.setSeed(runSeed);
+    return solver.solve().distance;
+}
+
+// Seconds for one budget unit over the whole instance set
+double ProfileTuner::secondsPerUnit() const {
+    auto started = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < instances.size(); ++i) {
+        evaluate(SolverProfile(), i, CALIBRATION_BUDGET);
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+    return std::max(seconds, 1e-6) / CALIBRATION_BUDGET;
+}
+
+SolverProfile ProfileTuner::tune() {
+    if (instances.empty()) {
+        throw std::runtime_error("ProfileTuner: no instances");
+    }
+    for (const std::vector<City>& cities : instances) {
+        if (cities.size() < 2) {
+            throw std::runtime_error("ProfileTuner: every instance needs at least 2 cities");
+        }
+    }
+
+    std::vector<SolverProfile> survivors = sampleConfigurations();
+    rungCount = 0;
+    for (int count = configurationCount; count > 1; count = (count + eta - 1) / eta) ++rungCount;
+    rungCount = std::max(rungCount, 1);
+    double unitsPerRung = budgetSeconds / secondsPerUnit() / rungCount;
+    int workers = resolveWorkerCount(threadCount);
+
+    std::vector<double> scores;
+    int budget = 1;
+    for (int rung = 0; rung < rungCount; ++rung) {
+        size_t count = survivors.size();
+        budget = std::max(1, static_cast<int>(std::min(unitsPerRung / count, 1e6)));
+
+        // One task per (configuration, instance) pair
+        std::vector<double> lengths(count * instances.size());
+        parallelFor(lengths.size(), workers, [&](size_t task) {
+            lengths[task] = evaluate(survivors[task / instances.size()], task % instances.size(), budget);
+        });
+
+        scores.assign(count, 0.0);
+        for (size_t i = 0; i < instances.size(); ++i) {
+            double best = std::numeric_limits<double>::max();
+            for (size_t c = 0; c < count; ++c) best = std::min(best, lengths[c * instances.size() + i]);
+            for (size_t c = 0; c < count; ++c) scores[c] += lengths[c * instances.size() + i] / best / instances.size();
+        }
+
+        std::vector<size_t> order(count);
+        std::iota(order.begin(), order.end(), 0);
+        std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) { return scores[a] < scores[b]; });
+        if (log) {
+            *log << "Rung " << rung + 1 << "/" << rungCount << ": " << count << " configurations, "
+                 << budget << " iterations per city, best score " << scores[order[0]] << std::endl;
+        }
+
+        size_t keep = (count + eta - 1) / eta;
+        std::vector<SolverProfile> next;
+        std::vector<double> nextScores;
+        for (size_t i = 0; i < keep; ++i) {
+            next.push_back(survivors[order[i]]);
+            nextScores.push_back(scores[order[i]]);
+        }
+        survivors.swap(next);
+        scores.swap(nextScores);
+    }
+
+    bestScore = scores[0];
+    SolverProfile winner = survivors[0];
+    winner.iterationsPerCity = budget;
+    return winner;
+}
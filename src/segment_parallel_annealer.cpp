@@ -0,0 +1,132 @@
+#include "segment_parallel_annealer.h"
+#include "tour_kernels.h"
+#include "parallel_for.h"
+#include "exact_solver.h"
+#include "solver_profile.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+namespace {
+
+// Smallest segment worth giving its own thread
+const size_t MIN_SEGMENT = 16;
+
+} // namespace
+
+SegmentParallelAnnealer::SegmentParallelAnnealer()
+    : tourLengthValue(0.0),
+      threadCount(0),
+      epochs(200),
+      iterationsPerEpoch(20000),
+      startTemperature(0.0),
+      endTemperature(0.0),
+      epoch(0),
+      temperature(0.0),
+      epochCooling(1.0),
+      rng(std::chrono::steady_clock::now().time_since_epoch().count()) {
+}
+
+void SegmentParallelAnnealer::setCities(const std::vector<City>& cities) {
+    this->cities = cities;
+    xs.resize(cities.size());
+    ys.resize(cities.size());
+    for (size_t i = 0; i < cities.size(); ++i) {
+        xs[i] = cities[i].x;
+        ys[i] = cities[i].y;
+    }
+    initialTour.clear();
+    reset();
+}
+
+void SegmentParallelAnnealer::setTour(const std::vector<int>& tour) {
+    initialTour = tour;
+    reset();
+}
+
+void SegmentParallelAnnealer::reset() {
+    size_t n = cities.size();
+
+    // Use the supplied tour only if it is a permutation of the cities
+    bool valid = initialTour.size() == n;
+    std::vector<bool> seen(n, false);
+    for (size_t k = 0; valid && k < n; ++k) {
+        int city = initialTour[k];
+        valid = city >= 0 && static_cast<size_t>(city) < n && !seen[city];
+        if (valid) seen[city] = true;
+    }
+    if (valid) {
+        tour = initialTour;
+    } else {
+        tour.resize(n);
+        for (size_t i = 0; i < n; ++i) tour[i] = static_cast<int>(i);
+        std::shuffle(tour.begin(), tour.end(), rng);
+    }
+    tourLengthValue = tourLength(xs.data(), ys.data(), tour.data(), n);
+
+    double start = startTemperature;
+    double end = endTemperature;
+    if (start <= 0.0 || end <= 0.0) {
+        double edgeScale = typicalEdgeLength(xs.data(), ys.data(), n);
+        if (start <= 0.0) start = edgeScale;
+        if (end <= 0.0) end = edgeScale * 1e-3;
+    }
+    temperature = start;
+    epochCooling = std::pow(end / start, 1.0 / static_cast<double>(epochs));
+    epoch = 0;
+}
+
+bool SegmentParallelAnnealer::step() {
+    size_t n = tour.size();
+    if (epoch >= epochs) return false;
+    if (n < 8) {
+        // Too small to cut into segments; solved outright in one step
+        ExactSolver exact;
+        exact.setCoordinates(xs.data(), ys.data(), n);
+        tour = exact.solve();
+        tourLengthValue = tourLength(xs.data(), ys.data(), tour.data(), n);
+        epoch = epochs;
+        return true;
+    }
+
+    size_t segments = std::min(static_cast<size_t>(resolveWorkerCount(threadCount)), n / MIN_SEGMENT);
+    segments = std::max<size_t>(segments, 1);
+    size_t segmentLength = n / segments;
+    // Half a segment per epoch moves every boundary into a segment interior
+    size_t offset = (static_cast<size_t>(epoch) * (segmentLength / 2)) % n;
+
+    std::vector<unsigned> seeds(segments);
+    for (auto& seed : seeds) seed = static_cast<unsigned>(rng());
+
+    WindowAnnealParams params;
+    params.iterations = iterationsPerEpoch;
+    params.startTemperature = temperature;
+    params.endTemperature = temperature * epochCooling;
+
+    parallelFor(segments, static_cast<int>(segments), [&](size_t s) {
+        std::mt19937 local(seeds[s]);
+        size_t begin = (offset + s * segmentLength) % n;
+        size_t length = s + 1 == segments ? n - s * segmentLength : segmentLength;
+        annealWindow(xs.data(), ys.data(), tour.data(), n, begin, length, params, local);
+    });
+
+    // Exact recomputation once per epoch keeps the summed deltas from drifting
+    tourLengthValue = tourLength(xs.data(), ys.data(), tour.data(), n);
+    temperature *= epochCooling;
+    epoch++;
+    return true;
+}
+
+TSPSolution SegmentParallelAnnealer::solve() {
+    reset();
+    while (step()) {
+    }
+    return getCurrentSolution();
+}
+
+TSPSolution SegmentParallelAnnealer::getCurrentSolution() const {
+    TSPSolution solution;
+    solution.tour = tour;
+    solution.distance = tourLengthValue;
+    return solution;
+}
@@ -0,0 +1,366 @@
+#include "solution_cache.h"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+
+namespace {
+
+const char CACHE_MAGIC[8] = {'T', 'S', 'P', 'C', 'A', 'C', 'H', 'E'};
+const std::uint32_t CACHE_VERSION = 1;
+const std::uint32_t BYTE_ORDER_MARK = 0x01020304;
+// Smallest per-city hashes kept as an entry's sketch
+const std::size_t SKETCH_SIZE = 16;
+// Near-hit candidates checked exactly per shard, by sketch votes
+const std::size_t NEAR_CANDIDATES = 3;
+
+std::uint64_t mix(std::uint64_t value) {
+    value += 0x9e3779b97f4a7c15ull;
+    value = (value ^ (value >> 30)) * 0xbf58476d1ce4e5b9ull;
+    value = (value ^ (value >> 27)) * 0x94d049bb133111ebull;
+    return value ^ (value >> 31);
+}
+
+// -0.0 and 0.0 are the same coordinate
+std::uint64_t coordinateBits(double value) {
+    if (value == 0.0) value = 0.0;
+    std::uint64_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    return bits;
+}
+
+std::uint64_t cityHash(const City& city) {
+    return mix(coordinateBits(city.x) ^ mix(coordinateBits(city.y)));
+}
+
+bool samePoint(const City& a, const City& b) {
+    return coordinateBits(a.x) == coordinateBits(b.x) && coordinateBits(a.y) == coordinateBits(b.y);
+}
+
+std::vector<std::uint64_t> sortedHashes(const std::vector<City>& cities) {
+    std::vector<std::uint64_t> hashes(cities.size());
+    for (std::size_t i = 0; i < cities.size(); ++i) hashes[i] = cityHash(cities[i]);
+    std::sort(hashes.begin(), hashes.end());
+    return hashes;
+}
+
+std::vector<std::uint64_t> bottomSketch(const std::vector<std::uint64_t>& sorted) {
+    std::vector<std::uint64_t> sketch;
+    for (std::size_t i = 0; i < sorted.size() && sketch.size() < SKETCH_SIZE; ++i) {
+        if (sketch.empty() || sketch.back() != sorted[i]) sketch.push_back(sorted[i]);
+    }
+    return sketch;
+}
+
+// Size of the multiset symmetric difference, giving up above `limit`
+std::size_t symmetricDifference(const std::vector<std::uint64_t>& a, const std::vector<std::uint64_t>& b, std::size_t limit) {
+    std::size_t i = 0, j = 0, difference = 0;
+    while ((i < a.size() || j < b.size()) && difference <= limit) {
+        if (j == b.size() || (i < a.size() && a[i] < b[j])) {
+            ++i;
+            ++difference;
+        } else if (i == a.size() || b[j] < a[i]) {
+            ++j;
+            ++difference;
+        } else {
+            ++i;
+            ++j;
+        }
+    }
+    return difference;
+}
+
+// Query index of every cached city (-1 where the query lacks it); each
+// query index is used at most once, so duplicate coordinates pair up
+std::vector<int> matchCities(const std::vector<City>& cached, const std::vector<City>& query, std::vector<char>& used) {
+    std::vector<std::pair<std::uint64_t, int>> byHash(query.size());
+    for (std::size_t i = 0; i < query.size(); ++i) byHash[i] = std::make_pair(cityHash(query[i]), static_cast<int>(i));
+    std::sort(byHash.begin(), byHash.end());
+    used.assign(query.size(), 0);
+
+    std::vector<int> indices(cached.size(), -1);
+    for (std::size_t k = 0; k < cached.size(); ++k) {
+        std::uint64_t hash = cityHash(cached[k]);
+        auto found = std::lower_bound(byHash.begin(), byHash.end(), std::make_pair(hash, -1));
+        for (; found != byHash.end() && found->first == hash; ++found) {
+            int index = found->second;
+            if (!used[index] && samePoint(query[index], cached[k])) {
+                used[index] = 1;
+                indices[k] = index;
+                break;
+            }
+        }
+    }
+    return indices;
+}
+
+template<typename T>
+void writeValue(std::ofstream& out, const T& value) {
+    out.write(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+template<typename T>
+void readValue(std::ifstream& in, T& value) {
+    if (!in.read(reinterpret_cast<char*>(&value), sizeof(value))) throw std::runtime_error("SolutionCache: truncated cache file");
+}
+
+} // namespace
+
+std::uint64_t instanceHash(const std::vector<City>& cities) {
+    std::uint64_t sum = 0;
+    for (const City& city : cities) sum += cityHash(city);
+    return mix(sum ^ mix(cities.size()));
+}
+
+std::size_t SolutionCache::Entry::bytes() const {
+    // Sketch values are also held by the shard's index
+    return sizeof(Entry) + tour.size() * sizeof(City) + hashes.size() * sizeof(std::uint64_t) +
+           sketch.size() * (3 * sizeof(std::uint64_t) + 2 * sizeof(void*));
+}
+
+SolutionCache::SolutionCache(std::size_t capacityBytes, int shardCount)
+    : maxDifference(0) {
+    if (shardCount < 1) shardCount = 1;
+    for (int i = 0; i < shardCount; ++i) shards.emplace_back(new Shard());
+    shardCapacity = capacityBytes / static_cast<std::size_t>(shardCount);
+}
+
+SolutionCache::Match SolutionCache::lookup(const std::vector<City>& cities) {
+    Match match;
+    std::size_t n = cities.size();
+    if (n < 3) return match;
+    std::uint64_t key = instanceHash(cities);
+    std::vector<std::uint64_t> hashes = sortedHashes(cities);
+    std::vector<char> used;
+
+    {
+        Shard& shard = shardFor(key);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        auto found = shard.byKey.find(key);
+        if (found != shard.byKey.end() && found->second->hashes == hashes) {
+            std::vector<int> tour = matchCities(found->second->tour, cities, used);
+            if (std::find(tour.begin(), tour.end(), -1) == tour.end()) {
+                shard.entries.splice(shard.entries.begin(), shard.entries, found->second);
+                match.kind = MATCH_EXACT;
+                match.tour = tour;
+                match.length = found->second->length;
+            }
+        }
+    }
+    if (match.kind == MATCH_EXACT) {
+        std::lock_guard<std::mutex> lock(statsMutex);
+        ++stats.hits;
+        return match;
+    }
+
+    // Near hits: vote for entries sharing sketch values, then count the
+    // difference exactly for the best-voted few of every shard
+    std::size_t limit = maxDifference > 0 ? static_cast<std::size_t>(maxDifference) : std::max<std::size_t>(3, n / 20);
+    std::vector<std::uint64_t> sketch = bottomSketch(hashes);
+    std::size_t bestDifference = limit + 1;
+    for (auto& shardPointer : shards) {
+        Shard& shard = *shardPointer;
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        std::unordered_map<std::uint64_t, int> votes;
+        for (std::uint64_t value : sketch) {
+            auto range = shard.bySketch.equal_range(value);
+            for (auto it = range.first; it != range.second; ++it) ++votes[it->second];
+        }
+        std::vector<std::pair<int, std::uint64_t>> candidates;
+        for (const auto& vote : votes) candidates.push_back(std::make_pair(vote.second, vote.first));
+        std::sort(candidates.rbegin(), candidates.rend());
+        if (candidates.size() > NEAR_CANDIDATES) candidates.resize(NEAR_CANDIDATES);
+
+        for (const auto& candidate : candidates) {
+            // A sketch value may outlive its entry; find() never inserts
+            auto found = shard.byKey.find(candidate.second);
+            if (found == shard.byKey.end()) continue;
+            auto entry = found->second;
+            std::size_t sizeGap = entry->hashes.size() > n ? entry->hashes.size() - n : n - entry->hashes.size();
+            if (sizeGap >= bestDifference) continue;
+            std::size_t difference = symmetricDifference(entry->hashes, hashes, bestDifference - 1);
+            if (difference >= bestDifference || difference == 0) continue;
+            std::vector<int> tour = matchCities(entry->tour, cities, used);
+            std::size_t common = static_cast<std::size_t>(std::count_if(tour.begin(), tour.end(), [](int index) { return index >= 0; }));
+            if (common < 3) continue;
+            bestDifference = difference;
+            shard.entries.splice(shard.entries.begin(), shard.entries, entry);
+            match.kind = MATCH_NEAR;
+            match.tour = tour;
+            match.cachedTour = entry->tour;
+            match.length = entry->length;
+            match.added.clear();
+            for (std::size_t i = 0; i < n; ++i) {
+                if (!used[i]) match.added.push_back(static_cast<int>(i));
+            }
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(statsMutex);
+    if (match.kind == MATCH_NEAR) {
+        ++stats.nearHits;
+    } else {
+        ++stats.misses;
+    }
+    return match;
+}
+
+void SolutionCache::store(const std::vector<City>& cities, const std::vector<int>& tour, double length) {
+    std::size_t n = cities.size();
+    if (n < 3 || tour.size() != n) return;
+    Entry entry;
+    entry.tour.reserve(n);
+    std::vector<char> seen(n, 0);
+    for (int city : tour) {
+        if (city < 0 || static_cast<std::size_t>(city) >= n || seen[city]) return;
+        seen[city] = 1;
+        entry.tour.push_back(City(cities[city].x, cities[city].y, static_cast<int>(entry.tour.size())));
+    }
+    entry.key = instanceHash(cities);
+    entry.length = length;
+    entry.hashes = sortedHashes(cities);
+    entry.sketch = bottomSketch(entry.hashes);
+    insert(std::move(entry));
+}
+
+void SolutionCache::insert(Entry entry) {
+    Shard& shard = shardFor(entry.key);
+    std::size_t bytes = entry.bytes();
+    bool stored = false;
+    long evicted = 0;
+    {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        auto found = shard.byKey.find(entry.key);
+        if (found != shard.byKey.end()) {
+            // Same key, same cities: only the tour can improve
+            Entry& existing = *found->second;
+            if (entry.length < existing.length && existing.hashes == entry.hashes) {
+                existing.tour.swap(entry.tour);
+                existing.length = entry.length;
+                stored = true;
+            }
+            shard.entries.splice(shard.entries.begin(), shard.entries, found->second);
+        } else if (bytes <= shardCapacity) {
+            shard.entries.push_front(std::move(entry));
+            Entry& added = shard.entries.front();
+            shard.byKey[added.key] = shard.entries.begin();
+            for (std::uint64_t value : added.sketch) shard.bySketch.insert(std::make_pair(value, added.key));
+            shard.bytes += bytes;
+            stored = true;
+            while (shard.bytes > shardCapacity) {
+                evict(shard);
+                ++evicted;
+            }
+        }
+    }
+    std::lock_guard<std::mutex> lock(statsMutex);
+    if (stored) ++stats.stores;
+    stats.evictions += evicted;
+}
+
+// Drops the least recently used entry; the shard's lock is held
+void SolutionCache::evict(Shard& shard) {
+    Entry& victim = shard.entries.back();
+    for (std::uint64_t value : victim.sketch) {
+        auto range = shard.bySketch.equal_range(value);
+        for (auto it = range.first; it != range.second; ++it) {
+            if (it->second == victim.key) {
+                shard.bySketch.erase(it);
+                break;
+            }
+        }
+    }
+    shard.byKey.erase(victim.key);
+    shard.bytes -= victim.bytes();
+    shard.entries.pop_back();
+}
+
+void SolutionCache::clear() {
+    for (auto& shard : shards) {
+        std::lock_guard<std::mutex> lock(shard->mutex);
+        shard->entries.clear();
+        shard->byKey.clear();
+        shard->bySketch.clear();
+        shard->bytes = 0;
+    }
+}
+
+SolutionCacheStats SolutionCache::getStats() const {
+    SolutionCacheStats result;
+    {
+        std::lock_guard<std::mutex> lock(statsMutex);
+        result = stats;
+    }
+    result.entries = 0;
+    result.bytes = 0;
+    for (const auto& shard : shards) {
+        std::lock_guard<std::mutex> lock(shard->mutex);
+        result.entries += shard->entries.size();
+        result.bytes += shard->bytes;
+    }
+    return result;
+}
+
+// Least recently used first, so loading restores the recency order
+void SolutionCache::save(const std::string& path) const {
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    if (!out) throw std::runtime_error("SolutionCache: cannot write " + path);
+    out.write(CACHE_MAGIC, sizeof(CACHE_MAGIC));
+    writeValue(out, CACHE_VERSION);
+    writeValue(out, BYTE_ORDER_MARK);
+    std::uint64_t count = getStats().entries;
+    writeValue(out, count);
+
+    std::uint64_t written = 0;
+    for (const auto& shard : shards) {
+        std::lock_guard<std::mutex> lock(shard->mutex);
+        for (auto entry = shard->entries.rbegin(); entry != shard->entries.rend() && written < count; ++entry, ++written) {
+            writeValue(out, static_cast<std::uint64_t>(entry->tour.size()));
+            writeValue(out, entry->length);
+            for (const City& city : entry->tour) {
+                writeValue(out, city.x);
+                writeValue(out, city.y);
+            }
+        }
+    }
+    // Entries added while saving are left out; patch the count to match
+    out.seekp(sizeof(CACHE_MAGIC) + 2 * sizeof(std::uint32_t));
+    writeValue(out, written);
+    if (!out) throw std::runtime_error("SolutionCache: cannot write " + path);
+}
+
+void SolutionCache::load(const std::string& path) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in) throw std::runtime_error("SolutionCache: cannot open " + path);
+    char magic[sizeof(CACHE_MAGIC)];
+    std::uint32_t version = 0, byteOrder = 0;
+    std::uint64_t count = 0;
+    if (!in.read(magic, sizeof(magic)) || std::memcmp(magic, CACHE_MAGIC, sizeof(magic)) != 0) {
+        throw std::runtime_error("SolutionCache: " + path + " is not a cache file");
+    }
+    readValue(in, version);
+    readValue(in, byteOrder);
+    if (version != CACHE_VERSION) throw std::runtime_error("SolutionCache: unsupported cache version " + std::to_string(version));
+    if (byteOrder != BYTE_ORDER_MARK) throw std::runtime_error("SolutionCache: cache file has the wrong byte order");
+    readValue(in, count);
+
+    in.seekg(0, std::ios::end);
+    std::uint64_t remaining = static_cast<std::uint64_t>(in.tellg());
+    in.seekg(sizeof(CACHE_MAGIC) + 2 * sizeof(std::uint32_t) + sizeof(count));
+    for (std::uint64_t e = 0; e < count; ++e) {
+        std::uint64_t n = 0;
+        double length = 0.0;
+        readValue(in, n);
+        readValue(in, length);
+        if (n > remaining / (2 * sizeof(double))) throw std::runtime_error("SolutionCache: truncated cache file");
+        std::vector<City> cities(n);
+        std::vector<int> tour(n);
+        for (std::uint64_t i = 0; i < n; ++i) {
+            readValue(in, cities[i].x);
+            readValue(in, cities[i].y);
+            cities[i].id = static_cast<int>(i);
+            tour[i] = static_cast<int>(i);
+        }
+        store(cities, tour, length);
+    }
+}
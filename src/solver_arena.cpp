@@ -0,0 +1,27 @@
+#include "solver_arena.h"
+#include <cstdint>
+#include <stdexcept>
+
+SolverArena::SolverArena() : base(nullptr), size(0), used(0), allocations(0) {}
+
+void SolverArena::reserve(std::size_t bytes) {
+    used = 0;
+    if (bytes <= size) return;
+
+    // Over-allocate by one alignment unit so the base can be aligned by hand
+    block.reset(new unsigned char[bytes + ALIGNMENT]);
+    std::uintptr_t raw = reinterpret_cast<std::uintptr_t>(block.get());
+    base = block.get() + (ALIGNMENT - raw % ALIGNMENT) % ALIGNMENT;
+    size = bytes;
+    allocations++;
+}
+
+void* SolverArena::carve(std::size_t bytes) {
+    std::size_t rounded = (bytes + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT;
+    if (used + rounded > size) {
+        throw std::length_error("SolverArena: layout exceeds reserved size");
+    }
+    void* p = base + used;
+    used += rounded;
+    return p;
+}
@@ -0,0 +1,86 @@
+#include "solver_profile.h"
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <limits>
+#include <sstream>
+#include <stdexcept>
+
+SolverProfile loadProfile(const std::string& path) {
+    std::ifstream in(path);
+    if (!in) {
+        throw std::runtime_error("SolverProfile: cannot open " + path);
+    }
+
+    SolverProfile profile;
+    std::string line;
+    int lineNumber = 0;
+    while (std::getline(in, line)) {
+        ++lineNumber;
+        line = line.substr(0, line.find('#'));
+        std::size_t split = line.find('=');
+        std::istringstream keyStream(line.substr(0, split));
+        std::string key;
+        if (!(keyStream >> key)) continue;
+        if (split == std::string::npos) {
+            throw std::runtime_error("SolverProfile: expected key = value on line " + std::to_string(lineNumber));
+        }
+
+        std::istringstream value(line.substr(split + 1));
+        bool parsed;
+        if (key == "temperature_factor") parsed = static_cast<bool>(value >> profile.temperatureFactor);
+        else if (key == "min_temperature_factor") parsed = static_cast<bool>(value >> profile.minTemperatureFactor);
+        else if (key == "cooling_rate") parsed = static_cast<bool>(value >> profile.coolingRate);
+        else if (key == "iterations_per_temperature") parsed = static_cast<bool>(value >> profile.iterationsPerTemperature);
+        else if (key == "iterations_per_city") parsed = static_cast<bool>(value >> profile.iterationsPerCity);
+        else if (key == "swap_weight") parsed = static_cast<bool>(value >> profile.swapWeight);
+        else if (key == "segment_weight") parsed = static_cast<bool>(value >> profile.segmentWeight);
+        else if (key == "neighbour_count") parsed = static_cast<bool>(value >> profile.neighbourCount);
+        else throw std::runtime_error("SolverProfile: unknown key " + key + " in " + path);
+        if (!parsed) {
+            throw std::runtime_error("SolverProfile: bad value for " + key + " in " + path);
+        }
+    }
+
+    if (profile.temperatureFactor <= 0.0 || profile.minTemperatureFactor <= 0.0 ||
+        profile.coolingRate <= 0.0 || profile.coolingRate >= 1.0 || profile.iterationsPerTemperature < 1 ||
+        profile.iterationsPerCity < 0 || profile.neighbourCount < 1) {
+        throw std::runtime_error("SolverProfile: value out of range in " + path);
+    }
+    return profile;
+}
+
+void saveProfile(const std::string& path, const SolverProfile& profile, const std::string& comment) {
+    std::ofstream out(path);
+    if (!out) {
+        throw std::runtime_error("SolverProfile: cannot write " + path);
+    }
+    out.precision(17);
+    if (!comment.empty()) out << "# " << comment << "\n";
+    out << "temperature_factor = " << profile.temperatureFactor << "\n"
+        << "min_temperature_factor = " << profile.minTemperatureFactor << "\n"
+        << "cooling_rate = " << profile.coolingRate << "\n"
+        << "iterations_per_temperature = " << profile.iterationsPerTemperature << "\n"
+        << "iterations_per_city = " << profile.iterationsPerCity << "\n"
+        << "swap_weight = " << profile.swapWeight << "\n"
+        << "segment_weight = " << profile.segmentWeight << "\n"
+        << "neighbour_count = " << profile.neighbourCount << "\n";
+}
+
+double typicalEdgeLength(const double* xs, const double* ys, std::size_t n) {
+    if (n == 0) return 1.0;
+    double minX = std::numeric_limits<double>::max(), maxX = -minX;
+    double minY = minX, maxY = -minX;
+    for (std::size_t i = 0; i < n; ++i) {
+        minX = std::min(minX, xs[i]);
+        maxX = std::max(maxX, xs[i]);
+        minY = std::min(minY, ys[i]);
+        maxY = std::max(maxY, ys[i]);
+    }
+    // A good tour also walks the longer side out and back, which is what
+    // sets the scale of thin and collinear sets, where the area is near zero
+    double count = static_cast<double>(n);
+    double area = (maxX - minX) * (maxY - minY);
+    double longer = std::max(maxX - minX, maxY - minY);
+    return std::max(std::max(std::sqrt(area / count), 2.0 * longer / count), 1e-9);
+}
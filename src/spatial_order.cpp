@@ -0,0 +1,94 @@
+#include "spatial_order.h"
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <utility>
+
+namespace {
+
+const std::uint32_t GRID = 1u << 16;
+
+std::uint64_t mortonKey(std::uint32_t x, std::uint32_t y) {
+    std::uint64_t key = 0;
+    for (int bit = 15; bit >= 0; --bit) {
+        key = (key << 2) | (((y >> bit) & 1u) << 1) | ((x >> bit) & 1u);
+    }
+    return key;
+}
+
+// Distance along the Hilbert curve, rotating the quadrant frame per level
+std::uint64_t hilbertKey(std::uint32_t x, std::uint32_t y) {
+    std::uint64_t key = 0;
+    for (std::uint32_t s = GRID / 2; s > 0; s /= 2) {
+        std::uint32_t rx = (x & s) ? 1u : 0u;
+        std::uint32_t ry = (y & s) ? 1u : 0u;
+        key += static_cast<std::uint64_t>(s) * s * ((3u * rx) ^ ry);
+        if (ry == 0) {
+            if (rx == 1) {
+                x = GRID - 1 - x;
+                y = GRID - 1 - y;
+            }
+            std::swap(x, y);
+        }
+    }
+    return key;
+}
+
+} // namespace
+
+const char* spatialOrderName(SpatialOrder order) {
+    switch (order) {
+        case SpatialOrder::Hilbert: return "hilbert";
+        case SpatialOrder::Morton: return "morton";
+        default: return "none";
+    }
+}
+
+bool parseSpatialOrder(const char* name, SpatialOrder& order) {
+    if (std::strcmp(name, "none") == 0) order = SpatialOrder::None;
+    else if (std::strcmp(name, "hilbert") == 0) order = SpatialOrder::Hilbert;
+    else if (std::strcmp(name, "morton") == 0) order = SpatialOrder::Morton;
+    else return false;
+    return true;
+}
+
+std::vector<int> spatialOrdering(const double* xs, const double* ys, std::size_t n, SpatialOrder order) {
+    std::vector<int> ordering;
+    if (order == SpatialOrder::None || n == 0) return ordering;
+
+    double minX = std::numeric_limits<double>::max(), maxX = -minX;
+    double minY = minX, maxY = -minX;
+    for (std::size_t i = 0; i < n; ++i) {
+        minX = std::min(minX, xs[i]);
+        maxX = std::max(maxX, xs[i]);
+        minY = std::min(minY, ys[i]);
+        maxY = std::max(maxY, ys[i]);
+    }
+    // A square cell keeps the curve's locality on elongated instances
+    double span = std::max(maxX - minX, maxY - minY);
+    double scale = span > 0.0 ? (GRID - 1) / span : 0.0;
+
+    std::vector<std::pair<std::uint64_t, int>> keyed(n);
+    for (std::size_t i = 0; i < n; ++i) {
+        std::uint32_t qx = static_cast<std::uint32_t>((xs[i] - minX) * scale);
+        std::uint32_t qy = static_cast<std::uint32_t>((ys[i] - minY) * scale);
+        std::uint64_t key = order == SpatialOrder::Hilbert ? hilbertKey(qx, qy) : mortonKey(qx, qy);
+        keyed[i] = std::make_pair(key, static_cast<int>(i));
+    }
+    std::sort(keyed.begin(), keyed.end());
+
+    ordering.resize(n);
+    for (std::size_t k = 0; k < n; ++k) ordering[k] = keyed[k].second;
+    return ordering;
+}
+
+int removeFromOrdering(std::vector<int>& ordering, int original) {
+    if (ordering.empty()) return original;
+    int position = static_cast<int>(std::find(ordering.begin(), ordering.end(), original) - ordering.begin());
+    ordering.erase(ordering.begin() + position);
+    for (int& entry : ordering) {
+        if (entry > original) --entry;
+    }
+    return position;
+}
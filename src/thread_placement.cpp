@@ -0,0 +1,216 @@
+#include "thread_placement.h"
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <thread>
+#include <dirent.h>
+#include <sched.h>
+
+namespace {
+
+// Affinity of the calling thread before its last pin()
+thread_local cpu_set_t savedMask;
+thread_local bool hasSavedMask = false;
+
+std::string readLine(const std::string& path) {
+    std::ifstream in(path);
+    std::string line;
+    std::getline(in, line);
+    return line;
+}
+
+} // namespace
+
+const char* placementPolicyName(PlacementPolicy policy) {
+    switch (policy) {
+        case PlacementPolicy::Compact: return "compact";
+        case PlacementPolicy::Scatter: return "scatter";
+        default: return "none";
+    }
+}
+
+bool parsePlacementPolicy(const char* name, PlacementPolicy& policy) {
+    const PlacementPolicy policies[] = {PlacementPolicy::None, PlacementPolicy::Compact, PlacementPolicy::Scatter};
+    for (PlacementPolicy candidate : policies) {
+        if (std::strcmp(name, placementPolicyName(candidate)) == 0) {
+            policy = candidate;
+            return true;
+        }
+    }
+    return false;
+}
+
+std::vector<int> parseCpuList(const std::string& list) {
+    std::vector<int> cpus;
+    std::size_t at = 0;
+    while (at < list.size()) {
+        std::size_t end = list.find(',', at);
+        if (end == std::string::npos) end = list.size();
+        std::string part = list.substr(at, end - at);
+        at = end + 1;
+
+        char* rest = nullptr;
+        long first = std::strtol(part.c_str(), &rest, 10);
+        if (rest == part.c_str() || first < 0) continue;
+        long last = first;
+        if (*rest == '-') {
+            const char* second = rest + 1;
+            last = std::strtol(second, &rest, 10);
+            if (rest == second || last < first) continue;
+        }
+        for (long cpu = first; cpu <= last; ++cpu) cpus.push_back(static_cast<int>(cpu));
+    }
+    std::sort(cpus.begin(), cpus.end());
+    cpus.erase(std::unique(cpus.begin(), cpus.end()), cpus.end());
+    return cpus;
+}
+
+CpuTopology CpuTopology::detect(const std::string& sysfsRoot, bool allowedOnly) {
+    CpuTopology topology;
+    std::vector<int> online = parseCpuList(readLine(sysfsRoot + "/cpu/online"));
+    if (online.empty()) {
+        unsigned hardware = std::max(std::thread::hardware_concurrency(), 1u);
+        for (unsigned cpu = 0; cpu < hardware; ++cpu) online.push_back(static_cast<int>(cpu));
+    }
+    if (allowedOnly) {
+        cpu_set_t allowed;
+        CPU_ZERO(&allowed);
+        if (sched_getaffinity(0, sizeof(allowed), &allowed) == 0) {
+            online.erase(std::remove_if(online.begin(), online.end(), [&](int cpu) {
+                return cpu >= CPU_SETSIZE || !CPU_ISSET(cpu, &allowed);
+            }), online.end());
+        }
+    }
+
+    // nodeN/cpulist for every node directory; CPUs no node claims go to node 0
+    std::vector<int> nodeOfCpu;
+    if (DIR* directory = opendir((sysfsRoot + "/node").c_str())) {
+        while (dirent* entry = readdir(directory)) {
+            const char* name = entry->d_name;
+            if (std::strncmp(name, "node", 4) != 0 || name[4] < '0' || name[4] > '9') continue;
+            int node = std::atoi(name + 4);
+            for (int cpu : parseCpuList(readLine(sysfsRoot + "/node/" + name + "/cpulist"))) {
+                if (cpu >= static_cast<int>(nodeOfCpu.size())) nodeOfCpu.resize(cpu + 1, -1);
+                nodeOfCpu[cpu] = node;
+            }
+        }
+        closedir(directory);
+    }
+
+    // Nodes are renumbered densely in case some are CPU-less
+    std::vector<int> nodeIds;
+    for (int cpu : online) {
+        int node = cpu < static_cast<int>(nodeOfCpu.size()) && nodeOfCpu[cpu] >= 0 ? nodeOfCpu[cpu] : 0;
+        nodeIds.push_back(node);
+    }
+    std::vector<int> distinct = nodeIds;
+    std::sort(distinct.begin(), distinct.end());
+    distinct.erase(std::unique(distinct.begin(), distinct.end()), distinct.end());
+    topology.cpus = online;
+    for (int node : nodeIds) {
+        topology.nodes.push_back(static_cast<int>(std::lower_bound(distinct.begin(), distinct.end(), node) - distinct.begin()));
+    }
+    topology.nodeCount = static_cast<int>(distinct.size());
+    return topology;
+}
+
+int CpuTopology::nodeOf(int cpu) const {
+    auto found = std::lower_bound(cpus.begin(), cpus.end(), cpu);
+    if (found == cpus.end() || *found != cpu) return -1;
+    return nodes[found - cpus.begin()];
+}
+
+ThreadPlacement::ThreadPlacement()
+    : policy(PlacementPolicy::None) {
+}
+
+ThreadPlacement::ThreadPlacement(const CpuTopology& topology, PlacementPolicy policy)
+    : topology(topology),
+      policy(policy) {
+    buildOrder(-1);
+}
+
+void ThreadPlacement::restrictToNode(int node) {
+    if (node < 0 || node >= topology.nodeCount) return;
+    buildOrder(node);
+}
+
+// Compact walks node by node; scatter takes the k-th CPU of every node
+// before any node's (k+1)-th
+void ThreadPlacement::buildOrder(int node) {
+    order.clear();
+    std::vector<std::vector<int>> byNode(std::max(topology.nodeCount, 1));
+    for (std::size_t i = 0; i < topology.cpus.size(); ++i) {
+        if (node < 0 || topology.nodes[i] == node) byNode[topology.nodes[i]].push_back(topology.cpus[i]);
+    }
+    if (policy == PlacementPolicy::Scatter) {
+        for (std::size_t k = 0; order.size() < topology.cpus.size(); ++k) {
+            bool any = false;
+            for (const auto& cpus : byNode) {
+                if (k < cpus.size()) {
+                    order.push_back(cpus[k]);
+                    any = true;
+                }
+            }
+            if (!any) break;
+        }
+    } else {
+        for (const auto& cpus : byNode) order.insert(order.end(), cpus.begin(), cpus.end());
+    }
+}
+
+int ThreadPlacement::cpuFor(int worker) const {
+    if (policy == PlacementPolicy::None || order.empty() || worker < 0) return -1;
+    return order[static_cast<std::size_t>(worker) % order.size()];
+}
+
+int ThreadPlacement::nodeFor(int worker) const {
+    int cpu = cpuFor(worker);
+    return cpu < 0 ? -1 : topology.nodeOf(cpu);
+}
+
+bool ThreadPlacement::pin(int worker) {
+    int cpu = cpuFor(worker);
+    WorkerPlacement placement;
+    placement.worker = worker;
+    placement.cpu = cpu;
+    placement.node = nodeFor(worker);
+    if (cpu >= 0 && cpu < CPU_SETSIZE) {
+        cpu_set_t previous;
+        CPU_ZERO(&previous);
+        bool saved = sched_getaffinity(0, sizeof(previous), &previous) == 0;
+        cpu_set_t mask;
+        CPU_ZERO(&mask);
+        CPU_SET(cpu, &mask);
+        placement.pinned = sched_setaffinity(0, sizeof(mask), &mask) == 0;
+        // Only the first of nested pins keeps the mask to go back to
+        if (placement.pinned && saved && !hasSavedMask) {
+            savedMask = previous;
+            hasSavedMask = true;
+        }
+    }
+    placement.runningOn = sched_getcpu();
+
+    std::lock_guard<std::mutex> lock(mutex);
+    if (worker >= 0) {
+        if (static_cast<std::size_t>(worker) >= placements.size()) placements.resize(worker + 1);
+        placements[worker] = placement;
+    }
+    return placement.pinned;
+}
+
+void ThreadPlacement::release() {
+    if (!hasSavedMask) return;
+    sched_setaffinity(0, sizeof(savedMask), &savedMask);
+    hasSavedMask = false;
+}
+
+std::vector<WorkerPlacement> ThreadPlacement::getPlacements() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    std::vector<WorkerPlacement> result;
+    for (std::size_t i = 0; i < placements.size(); ++i) {
+        if (placements[i].worker == static_cast<int>(i)) result.push_back(placements[i]);
+    }
+    return result;
+}
@@ -0,0 +1,368 @@
+#include "tour_kernels.h"
+#include <cmath>
+#include <type_traits>
+#include <utility>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define TSP_KERNELS_X86 1
+#include <immintrin.h>
+#endif
+
+namespace {
+
+KernelIsa forcedIsa = KernelIsa::Scalar;
+bool isaForced = false;
+
+KernelIsa detectKernelIsa() {
+#ifdef TSP_KERNELS_X86
+    __builtin_cpu_init();
+    // The AVX2 kernels are built with FMA enabled, and some CPUs have AVX2
+    // without it; the AVX-512 path falls back on the AVX2 helpers too
+    bool fma = __builtin_cpu_supports("fma");
+    if (fma && __builtin_cpu_supports("avx512f")) return KernelIsa::Avx512;
+    if (fma && __builtin_cpu_supports("avx2")) return KernelIsa::Avx2;
+#endif
+    return KernelIsa::Scalar;
+}
+
+KernelIsa detectedKernelIsa() {
+    static const KernelIsa detected = detectKernelIsa();
+    return detected;
+}
+
+template<typename Scalar>
+inline typename ScalarTraits<Scalar>::Length edge(const Scalar* xs, const Scalar* ys, int a, int b) {
+    return ScalarTraits<Scalar>::edge(xs[a] - xs[b], ys[a] - ys[b]);
+}
+
+template<typename Scalar>
+typename ScalarTraits<Scalar>::Length tourLengthScalar(const Scalar* xs, const Scalar* ys, const int* tour,
+                                                       std::size_t n, std::size_t start) {
+    typename ScalarTraits<Scalar>::Length total = 0;
+    for (std::size_t k = start; k + 1 < n; ++k) {
+        total += edge(xs, ys, tour[k], tour[k + 1]);
+    }
+    // Closing edge back to the start city
+    return total + edge(xs, ys, tour[n - 1], tour[0]);
+}
+
+// Handles every case, including adjacent positions and the wrap-around edge.
+template<typename Scalar>
+typename ScalarTraits<Scalar>::Length swapDeltaScalar(const Scalar* xs, const Scalar* ys, const int* tour,
+                                                      std::size_t n, int i, int j) {
+    if (i == j || n <= 3) return 0;
+    if (i > j) std::swap(i, j);
+
+    int a = tour[i == 0 ? n - 1 : i - 1];
+    int ci = tour[i];
+    int b = tour[i + 1];
+    int c = tour[j - 1];
+    int cj = tour[j];
+    int d = tour[static_cast<std::size_t>(j) == n - 1 ? 0 : j + 1];
+
+    if (j == i + 1) {
+        return edge(xs, ys, a, cj) + edge(xs, ys, ci, d) - edge(xs, ys, a, ci) - edge(xs, ys, cj, d);
+    }
+    if (i == 0 && static_cast<std::size_t>(j) == n - 1) {
+        // cj -> ci is the closing edge, so the pair is adjacent the other way round
+        return edge(xs, ys, c, ci) + edge(xs, ys, cj, b) - edge(xs, ys, c, cj) - edge(xs, ys, ci, b);
+    }
+    return edge(xs, ys, a, cj) + edge(xs, ys, cj, b) + edge(xs, ys, c, ci) + edge(xs, ys, ci, d)
+         - edge(xs, ys, a, ci) - edge(xs, ys, ci, b) - edge(xs, ys, c, cj) - edge(xs, ys, cj, d);
+}
+
+// True when the general eight-edge swap formula does not apply to (i, j).
+inline bool isSpecialSwap(std::size_t n, int i, int j) {
+    if (i > j) std::swap(i, j);
+    return i == j || n <= 3 || j == i + 1 || (i == 0 && static_cast<std::size_t>(j) == n - 1);
+}
+
+// Resolves the six cities around each of Lanes swap candidates so the
+// eight affected edges can be gathered in one go.
+template<int Lanes>
+struct SwapLanes {
+    alignas(64) int a[Lanes], ci[Lanes], b[Lanes], p[Lanes], cj[Lanes], d[Lanes];
+
+    SwapLanes(const int* tour, std::size_t n, const int* first, const int* second) {
+        for (int lane = 0; lane < Lanes; ++lane) {
+            int i = first[lane];
+            int j = second[lane];
+            if (i > j) std::swap(i, j);
+            a[lane] = tour[i == 0 ? n - 1 : i - 1];
+            ci[lane] = tour[i];
+            b[lane] = tour[static_cast<std::size_t>(i) + 1 == n ? 0 : i + 1];
+            p[lane] = tour[j == 0 ? n - 1 : j - 1];
+            cj[lane] = tour[j];
+            d[lane] = tour[static_cast<std::size_t>(j) + 1 == n ? 0 : j + 1];
+        }
+    }
+};
+
+template<typename Scalar>
+void fixSpecialSwaps(const Scalar* xs, const Scalar* ys, const int* tour, std::size_t n,
+                     const int* first, const int* second, typename ScalarTraits<Scalar>::Length* deltas, int lanes) {
+    for (int lane = 0; lane < lanes; ++lane) {
+        if (isSpecialSwap(n, first[lane], second[lane])) {
+            deltas[lane] = swapDeltaScalar(xs, ys, tour, n, first[lane], second[lane]);
+        }
+    }
+}
+
+#ifdef TSP_KERNELS_X86
+
+// --- double: 4 lanes (AVX2) / 8 lanes (AVX-512) ---
+
+__attribute__((target("avx2,fma")))
+inline __m256d edge4(const double* xs, const double* ys, __m128i a, __m128i b) {
+    __m256d dx = _mm256_sub_pd(_mm256_i32gather_pd(xs, a, 8), _mm256_i32gather_pd(xs, b, 8));
+    __m256d dy = _mm256_sub_pd(_mm256_i32gather_pd(ys, a, 8), _mm256_i32gather_pd(ys, b, 8));
+    return _mm256_sqrt_pd(_mm256_fmadd_pd(dx, dx, _mm256_mul_pd(dy, dy)));
+}
+
+__attribute__((target("avx2,fma")))
+inline double horizontalSum(__m256d v) {
+    alignas(32) double lanes[4];
+    _mm256_store_pd(lanes, v);
+    return (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+}
+
+__attribute__((target("avx2,fma")))
+double tourLengthAvx2(const double* xs, const double* ys, const int* tour, std::size_t n) {
+    __m256d acc = _mm256_setzero_pd();
+    std::size_t k = 0;
+    // tour[k + 4] must exist, so the last block stops one short of the end
+    for (; k + 4 < n; k += 4) {
+        __m128i from = _mm_loadu_si128(reinterpret_cast<const __m128i*>(tour + k));
+        __m128i to = _mm_loadu_si128(reinterpret_cast<const __m128i*>(tour + k + 1));
+        acc = _mm256_add_pd(acc, edge4(xs, ys, from, to));
+    }
+    return horizontalSum(acc) + tourLengthScalar(xs, ys, tour, n, k);
+}
+
+__attribute__((target("avx512f")))
+double tourLengthAvx512(const double* xs, const double* ys, const int* tour, std::size_t n) {
+    __m512d acc = _mm512_setzero_pd();
+    std::size_t k = 0;
+    for (; k + 8 < n; k += 8) {
+        __m256i from = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(tour + k));
+        __m256i to = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(tour + k + 1));
+        __m512d dx = _mm512_sub_pd(_mm512_i32gather_pd(from, xs, 8), _mm512_i32gather_pd(to, xs, 8));
+        __m512d dy = _mm512_sub_pd(_mm512_i32gather_pd(from, ys, 8), _mm512_i32gather_pd(to, ys, 8));
+        acc = _mm512_add_pd(acc, _mm512_sqrt_pd(_mm512_fmadd_pd(dx, dx, _mm512_mul_pd(dy, dy))));
+    }
+    return _mm512_reduce_add_pd(acc) + tourLengthScalar(xs, ys, tour, n, k);
+}
+
+__attribute__((target("avx2,fma")))
+void swapDeltasAvx2(const double* xs, const double* ys, const int* tour, std::size_t n,
+                    const int* first, const int* second, double* deltas, std::size_t k) {
+    std::size_t c = 0;
+    for (; c + 4 <= k; c += 4) {
+        SwapLanes<4> l(tour, n, first + c, second + c);
+        __m128i va = _mm_load_si128(reinterpret_cast<const __m128i*>(l.a));
+        __m128i vci = _mm_load_si128(reinterpret_cast<const __m128i*>(l.ci));
+        __m128i vb = _mm_load_si128(reinterpret_cast<const __m128i*>(l.b));
+        __m128i vp = _mm_load_si128(reinterpret_cast<const __m128i*>(l.p));
+        __m128i vcj = _mm_load_si128(reinterpret_cast<const __m128i*>(l.cj));
+        __m128i vd = _mm_load_si128(reinterpret_cast<const __m128i*>(l.d));
+
+        __m256d added = _mm256_add_pd(_mm256_add_pd(edge4(xs, ys, va, vcj), edge4(xs, ys, vcj, vb)),
+                                      _mm256_add_pd(edge4(xs, ys, vp, vci), edge4(xs, ys, vci, vd)));
+        __m256d removed = _mm256_add_pd(_mm256_add_pd(edge4(xs, ys, va, vci), edge4(xs, ys, vci, vb)),
+                                        _mm256_add_pd(edge4(xs, ys, vp, vcj), edge4(xs, ys, vcj, vd)));
+        _mm256_storeu_pd(deltas + c, _mm256_sub_pd(added, removed));
+        fixSpecialSwaps(xs, ys, tour, n, first + c, second + c, deltas + c, 4);
+    }
+    for (; c < k; ++c) {
+        deltas[c] = swapDeltaScalar(xs, ys, tour, n, first[c], second[c]);
+    }
+}
+
+// --- float: 8 lanes (AVX2) / 16 lanes (AVX-512), summed in double ---
+
+__attribute__((target("avx2,fma")))
+inline __m256 edge8(const float* xs, const float* ys, __m256i a, __m256i b) {
+    __m256 dx = _mm256_sub_ps(_mm256_i32gather_ps(xs, a, 4), _mm256_i32gather_ps(xs, b, 4));
+    __m256 dy = _mm256_sub_ps(_mm256_i32gather_ps(ys, a, 4), _mm256_i32gather_ps(ys, b, 4));
+    // No fused multiply-add, so each lane rounds exactly as ScalarTraits<float>::edge
+    return _mm256_sqrt_ps(_mm256_add_ps(_mm256_mul_ps(dx, dx), _mm256_mul_ps(dy, dy)));
+}
+
+__attribute__((target("avx2,fma")))
+inline __m256d widenSum(__m256 v) {
+    return _mm256_add_pd(_mm256_cvtps_pd(_mm256_castps256_ps128(v)), _mm256_cvtps_pd(_mm256_extractf128_ps(v, 1)));
+}
+
+__attribute__((target("avx2,fma")))
+double tourLengthAvx2(const float* xs, const float* ys, const int* tour, std::size_t n) {
+    __m256d acc = _mm256_setzero_pd();
+    std::size_t k = 0;
+    for (; k + 8 < n; k += 8) {
+        __m256i from = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(tour + k));
+        __m256i to = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(tour + k + 1));
+        acc = _mm256_add_pd(acc, widenSum(edge8(xs, ys, from, to)));
+    }
+    return horizontalSum(acc) + tourLengthScalar(xs, ys, tour, n, k);
+}
+
+__attribute__((target("avx512f")))
+double tourLengthAvx512(const float* xs, const float* ys, const int* tour, std::size_t n) {
+    __m512d acc = _mm512_setzero_pd();
+    std::size_t k = 0;
+    for (; k + 16 < n; k += 16) {
+        __m512i from = _mm512_loadu_si512(tour + k);
+        __m512i to = _mm512_loadu_si512(tour + k + 1);
+        __m512 dx = _mm512_sub_ps(_mm512_i32gather_ps(from, xs, 4), _mm512_i32gather_ps(to, xs, 4));
+        __m512 dy = _mm512_sub_ps(_mm512_i32gather_ps(from, ys, 4), _mm512_i32gather_ps(to, ys, 4));
+        __m512 e = _mm512_sqrt_ps(_mm512_fmadd_ps(dx, dx, _mm512_mul_ps(dy, dy)));
+        __m256 low = _mm512_castps512_ps256(e);
+        __m256 high = _mm256_castpd_ps(_mm512_extractf64x4_pd(_mm512_castps_pd(e), 1));
+        acc = _mm512_add_pd(acc, _mm512_add_pd(_mm512_cvtps_pd(low), _mm512_cvtps_pd(high)));
+    }
+    return _mm512_reduce_add_pd(acc) + tourLengthScalar(xs, ys, tour, n, k);
+}
+
+__attribute__((target("avx2,fma")))
+void swapDeltasAvx2(const float* xs, const float* ys, const int* tour, std::size_t n,
+                    const int* first, const int* second, double* deltas, std::size_t k) {
+    std::size_t c = 0;
+    for (; c + 8 <= k; c += 8) {
+        SwapLanes<8> l(tour, n, first + c, second + c);
+        __m256i va = _mm256_load_si256(reinterpret_cast<const __m256i*>(l.a));
+        __m256i vci = _mm256_load_si256(reinterpret_cast<const __m256i*>(l.ci));
+        __m256i vb = _mm256_load_si256(reinterpret_cast<const __m256i*>(l.b));
+        __m256i vp = _mm256_load_si256(reinterpret_cast<const __m256i*>(l.p));
+        __m256i vcj = _mm256_load_si256(reinterpret_cast<const __m256i*>(l.cj));
+        __m256i vd = _mm256_load_si256(reinterpret_cast<const __m256i*>(l.d));
+
+        // Each edge is widened before the sum, in swapDeltaScalar's order, so
+        // the delta does not cancel in single precision
+        __m256 edges[8] = {edge8(xs, ys, va, vcj), edge8(xs, ys, vcj, vb), edge8(xs, ys, vp, vci), edge8(xs, ys, vci, vd),
+                           edge8(xs, ys, va, vci), edge8(xs, ys, vci, vb), edge8(xs, ys, vp, vcj), edge8(xs, ys, vcj, vd)};
+        __m256d low = _mm256_cvtps_pd(_mm256_castps256_ps128(edges[0]));
+        __m256d high = _mm256_cvtps_pd(_mm256_extractf128_ps(edges[0], 1));
+        for (int e = 1; e < 8; ++e) {
+            __m256d edgeLow = _mm256_cvtps_pd(_mm256_castps256_ps128(edges[e]));
+            __m256d edgeHigh = _mm256_cvtps_pd(_mm256_extractf128_ps(edges[e], 1));
+            low = e < 4 ? _mm256_add_pd(low, edgeLow) : _mm256_sub_pd(low, edgeLow);
+            high = e < 4 ? _mm256_add_pd(high, edgeHigh) : _mm256_sub_pd(high, edgeHigh);
+        }
+        _mm256_storeu_pd(deltas + c, low);
+        _mm256_storeu_pd(deltas + c + 4, high);
+        fixSpecialSwaps(xs, ys, tour, n, first + c, second + c, deltas + c, 8);
+    }
+    for (; c < k; ++c) {
+        deltas[c] = swapDeltaScalar(xs, ys, tour, n, first[c], second[c]);
+    }
+}
+
+// --- int32 fixed point: 4 lanes, exact in double up to 2^53 ---
+
+__attribute__((target("avx2,fma")))
+std::int64_t tourLengthAvx2(const std::int32_t* xs, const std::int32_t* ys, const int* tour, std::size_t n) {
+    const __m256d half = _mm256_set1_pd(0.5);
+    __m256d acc = _mm256_setzero_pd();
+    std::size_t k = 0;
+    for (; k + 4 < n; k += 4) {
+        __m128i from = _mm_loadu_si128(reinterpret_cast<const __m128i*>(tour + k));
+        __m128i to = _mm_loadu_si128(reinterpret_cast<const __m128i*>(tour + k + 1));
+        __m128i dxi = _mm_sub_epi32(_mm_i32gather_epi32(xs, from, 4), _mm_i32gather_epi32(xs, to, 4));
+        __m128i dyi = _mm_sub_epi32(_mm_i32gather_epi32(ys, from, 4), _mm_i32gather_epi32(ys, to, 4));
+        __m256d dx = _mm256_cvtepi32_pd(dxi);
+        __m256d dy = _mm256_cvtepi32_pd(dyi);
+        __m256d e = _mm256_sqrt_pd(_mm256_fmadd_pd(dx, dx, _mm256_mul_pd(dy, dy)));
+        // nint() as in TSPLIB: truncate after adding one half
+        acc = _mm256_add_pd(acc, _mm256_floor_pd(_mm256_add_pd(e, half)));
+    }
+    return static_cast<std::int64_t>(horizontalSum(acc)) + tourLengthScalar(xs, ys, tour, n, k);
+}
+
+#endif // TSP_KERNELS_X86
+
+} // namespace
+
+KernelIsa activeKernelIsa() {
+    return isaForced ? forcedIsa : detectedKernelIsa();
+}
+
+void forceKernelIsa(KernelIsa isa) {
+    // Never select an instruction set the CPU cannot execute
+    KernelIsa detected = detectedKernelIsa();
+    forcedIsa = static_cast<int>(isa) > static_cast<int>(detected) ? detected : isa;
+    isaForced = true;
+}
+
+const char* kernelIsaName(KernelIsa isa) {
+    switch (isa) {
+        case KernelIsa::Avx2: return "avx2";
+        case KernelIsa::Avx512: return "avx512";
+        default: return "scalar";
+    }
+}
+
+template<typename Scalar>
+typename ScalarTraits<Scalar>::Length tourLength(const Scalar* xs, const Scalar* ys, const int* tour, std::size_t n) {
+    if (n < 2) return 0;
+
+#ifdef TSP_KERNELS_X86
+    KernelIsa isa = activeKernelIsa();
+    if constexpr (std::is_floating_point<Scalar>::value) {
+        if (isa == KernelIsa::Avx512) return tourLengthAvx512(xs, ys, tour, n);
+    }
+    if (isa != KernelIsa::Scalar) return tourLengthAvx2(xs, ys, tour, n);
+#endif
+    return tourLengthScalar(xs, ys, tour, n, 0);
+}
+
+template<typename Scalar>
+typename ScalarTraits<Scalar>::Length compensatedTourLength(const Scalar* xs, const Scalar* ys, const int* tour, std::size_t n) {
+    using Length = typename ScalarTraits<Scalar>::Length;
+    if (n < 2) return 0;
+    if constexpr (!std::is_floating_point<Length>::value) {
+        return tourLengthScalar(xs, ys, tour, n, 0);
+    } else {
+        Length sum = 0;
+        Length compensation = 0;
+        for (std::size_t k = 0; k < n; ++k) {
+            Length term = edge(xs, ys, tour[k], tour[k + 1 == n ? 0 : k + 1]);
+            Length next = sum + term;
+            // Recover the low-order bits lost by whichever operand is smaller
+            compensation += std::abs(sum) >= std::abs(term) ? (sum - next) + term : (term - next) + sum;
+            sum = next;
+        }
+        return sum + compensation;
+    }
+}
+
+template<typename Scalar>
+void evaluateSwapDeltas(const Scalar* xs, const Scalar* ys, const int* tour, std::size_t n,
+                        const int* first, const int* second,
+                        typename ScalarTraits<Scalar>::Length* deltas, std::size_t k) {
+#ifdef TSP_KERNELS_X86
+    // Index resolution dominates the swap kernel, so AVX2 also serves AVX-512 CPUs
+    if constexpr (std::is_floating_point<Scalar>::value) {
+        if (activeKernelIsa() != KernelIsa::Scalar && n > 3) {
+            swapDeltasAvx2(xs, ys, tour, n, first, second, deltas, k);
+            return;
+        }
+    }
+#endif
+    for (std::size_t c = 0; c < k; ++c) {
+        deltas[c] = swapDeltaScalar(xs, ys, tour, n, first[c], second[c]);
+    }
+}
+
+template double tourLength<double>(const double*, const double*, const int*, std::size_t);
+template double tourLength<float>(const float*, const float*, const int*, std::size_t);
+template std::int64_t tourLength<std::int32_t>(const std::int32_t*, const std::int32_t*, const int*, std::size_t);
+
+template double compensatedTourLength<double>(const double*, const double*, const int*, std::size_t);
+template double compensatedTourLength<float>(const float*, const float*, const int*, std::size_t);
+template std::int64_t compensatedTourLength<std::int32_t>(const std::int32_t*, const std::int32_t*, const int*, std::size_t);
+
+template void evaluateSwapDeltas<double>(const double*, const double*, const int*, std::size_t,
+                                         const int*, const int*, double*, std::size_t);
+template void evaluateSwapDeltas<float>(const float*, const float*, const int*, std::size_t,
+                                        const int*, const int*, double*, std::size_t);
+template void evaluateSwapDeltas<std::int32_t>(const std::int32_t*, const std::int32_t*, const int*, std::size_t,
+                                               const int*, const int*, std::int64_t*, std::size_t);
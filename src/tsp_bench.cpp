@@ -0,0 +1,181 @@
+#include "tsp_solver.h"
+#include "annealing_kernel.h"
+#include "libtsp.h"
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+
+namespace {
+
+void printUsage(const char* program) {
+    std::cout << "Usage: " << program << " [--cities N] [--iterations M] [--seed S]\n"
+              << "  --cities      random cities in a 1000 x 1000 square (default 2000)\n"
+              << "  --iterations  annealing iterations per run (default 5000000)\n"
+              << "  --seed        seed for the cities and every run (default 1)\n";
+}
+
+struct BenchRun {
+    double seconds;
+    double distance;
+    long iterations;
+};
+
+// Geometric schedule from about the typical edge length down a thousandfold,
+// cooled every iteration, as the console front end does
+KernelSchedule benchSchedule(int cityCount, long iterations, unsigned seed) {
+    double edgeScale = std::sqrt(1000.0 * 1000.0 / cityCount);
+    KernelSchedule schedule;
+    schedule.initialTemperature = edgeScale;
+    schedule.minTemperature = edgeScale * 1e-3;
+    schedule.coolingRate = std::pow(1e-3, 1.0 / iterations);
+    schedule.iterationsPerTemperature = 1;
+    schedule.maxIterations = iterations;
+    schedule.seed = seed;
+    return schedule;
+}
+
+// The generic path: TSPSolver's runtime move choice, candidate buffers and
+// double conversions on every iteration
+BenchRun runGeneric(const std::vector<double>& xs, const std::vector<double>& ys, const KernelSchedule& schedule,
+                    bool segmentMoves) {
+    std::vector<City> cities;
+    for (size_t i = 0; i < xs.size(); ++i) cities.push_back(City(xs[i], ys[i], static_cast<int>(i)));
+    TSPSolver solver;
+    solver.setInitialTemperature(schedule.initialTemperature);
+    solver.setMinTemperature(schedule.minTemperature);
+    solver.setCoolingRate(schedule.coolingRate);
+    solver.setIterationsPerTemperature(schedule.iterationsPerTemperature);
+    solver.setMaxIterations(static_cast<int>(schedule.maxIterations));
+    solver.setMoveWeights(1.0, segmentMoves ? 1.0 : 0.0);
+    solver.setExactLimit(0);
+    solver.setSeed(schedule.seed);
+    solver.setCities(cities);
+
+    auto started = std::chrono::steady_clock::now();
+    TSPSolution solution = solver.solve();
+    BenchRun run;
+    run.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+    run.distance = solution.distance;
+    run.iterations = solver.getIteration();
+    return run;
+}
+
+BenchRun runKernel(const KernelConfig& config, const std::vector<double>& xs, const std::vector<double>& ys,
+                   const KernelSchedule& schedule) {
+    auto started = std::chrono::steady_clock::now();
+    KernelResult result = runAnnealingKernel(config, xs.data(), ys.data(), xs.size(), schedule);
+    BenchRun run;
+    run.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+    run.distance = result.distance;
+    run.iterations = result.iterations;
+    return run;
+}
+
+void printRun(const std::string& name, const BenchRun& run, double baseline) {
+    double rate = run.seconds > 0.0 ? run.iterations / run.seconds : 0.0;
+    std::cout << std::left << std::setw(34) << name << std::right << std::fixed
+              << std::setw(10) << std::setprecision(2) << rate / 1e6
+              << std::setw(14) << std::setprecision(1) << run.distance;
+    if (baseline > 0.0) std::cout << std::setw(9) << std::setprecision(2) << rate / baseline << "x";
+    std::cout << std::endl;
+}
+
+// Mean wall time of a tsp_set_coordinates / tsp_solve(0) / tsp_get_tour
+// round trip through the C interface, reusing one context
+double libtspRoundTrip(int cityCount, int repeats, unsigned seed) {
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<double> coord(0.0, 1000.0);
+    std::vector<double> xs(cityCount), ys(cityCount);
+    for (int i = 0; i < cityCount; ++i) {
+        xs[i] = coord(rng);
+        ys[i] = coord(rng);
+    }
+    std::vector<int32_t> tour(cityCount);
+    tsp_context* context = tsp_create();
+    if (!context) return 0.0;
+    auto started = std::chrono::steady_clock::now();
+    for (int r = 0; r < repeats; ++r) {
+        tsp_set_coordinates(context, xs.data(), ys.data(), xs.size());
+        tsp_solve(context, 0.0);
+        tsp_get_tour(context, tour.data(), tour.size());
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+    tsp_destroy(context);
+    return seconds / repeats;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    int cityCount = 2000;
+    long iterations = 5000000;
+    unsigned seed = 1;
+
+    for (int i = 1; i < argc; ++i) {
+        bool hasValue = i + 1 < argc;
+        if (std::strcmp(argv[i], "--cities") == 0 && hasValue) {
+            cityCount = std::atoi(argv[++i]);
+        } else if (std::strcmp(argv[i], "--iterations") == 0 && hasValue) {
+            iterations = std::atol(argv[++i]);
+        } else if (std::strcmp(argv[i], "--seed") == 0 && hasValue) {
+            seed = static_cast<unsigned>(std::strtoul(argv[++i], nullptr, 10));
+        } else {
+            printUsage(argv[0]);
+            return std::strcmp(argv[i], "--help") == 0 ? 0 : 1;
+        }
+    }
+    if (cityCount < 4 || iterations < 1) {
+        std::cerr << "Need at least 4 cities and 1 iteration" << std::endl;
+        return 1;
+    }
+
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<double> coord(0.0, 1000.0);
+    std::vector<double> xs(cityCount), ys(cityCount);
+    for (int i = 0; i < cityCount; ++i) {
+        xs[i] = coord(rng);
+        ys[i] = coord(rng);
+    }
+    KernelSchedule schedule = benchSchedule(cityCount, iterations, seed);
+
+    std::cout << cityCount << " cities, " << iterations << " iterations per run" << std::endl;
+    std::cout << std::left << std::setw(34) << "Run" << std::right << std::setw(10) << "Mit/s"
+              << std::setw(14) << "Length" << std::setw(10) << "Speedup" << std::endl;
+
+    // Speedups are over the generic path with the same moves available
+    BenchRun genericSwap = runGeneric(xs, ys, schedule, false);
+    double swapRate = genericSwap.iterations / genericSwap.seconds;
+    printRun("generic euclidean double swap", genericSwap, 0.0);
+    BenchRun genericMixed = runGeneric(xs, ys, schedule, true);
+    printRun("generic euclidean double swap+or", genericMixed, 0.0);
+
+    const KernelMetric metrics[] = {KernelMetric::Euclidean, KernelMetric::Manhattan, KernelMetric::Maximum};
+    const KernelScalar scalars[] = {KernelScalar::Double, KernelScalar::Float, KernelScalar::Fixed};
+    const KernelMoves moveSets[] = {KERNEL_MOVES_SWAP, KERNEL_MOVES_TWO_OPT, KERNEL_MOVES_BOTH};
+    for (KernelMetric metric : metrics) {
+        for (KernelScalar scalar : scalars) {
+            for (KernelMoves moves : moveSets) {
+                KernelConfig config(metric, scalar, moves);
+                std::string name = std::string("kernel ") + kernelMetricName(metric) + " " + kernelScalarName(scalar) +
+                                   " " + kernelMovesName(moves);
+                BenchRun run = runKernel(config, xs, ys, schedule);
+                // Only the Euclidean swap runs are the same problem and moves as the generic one
+                bool comparable = metric == KernelMetric::Euclidean && moves == KERNEL_MOVES_SWAP;
+                printRun(name, run, comparable ? swapRate : 0.0);
+            }
+        }
+    }
+
+    std::cout << std::endl << "libtsp round trip (set coordinates, solve(0), get tour)" << std::endl;
+    for (int cities : {10, 50, 200}) {
+        double seconds = libtspRoundTrip(cities, 2000, seed);
+        std::cout << std::left << std::setw(34) << (std::to_string(cities) + " cities") << std::right
+                  << std::setw(10) << std::setprecision(1) << seconds * 1e6 << " us" << std::endl;
+    }
+    return 0;
+}
@@ -0,0 +1,150 @@
+#include "island_model.h"
+#include "instance_file.h"
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <string>
+
+namespace {
+
+void printUsage(const char* program) {
+    std::cout << "Usage: " << program << " [options]\n"
+              << "  --islands    island processes on this machine, joined in a ring (default 2)\n"
+              << "  --population annealers per island (default: one per core)\n"
+              << "  --epochs     migration rounds (default 20)\n"
+              << "  --epoch-iterations  annealing iterations per annealer between migrations (default 100000)\n"
+              << "  --cities     random instance size (default 1000)\n"
+              << "  --input      .tspb or \"x y\" text instance instead\n"
+              << "  --seed       instance and annealer seed (default 1)\n"
+              << "  --placement  none|compact|scatter thread pinning, one NUMA node per island (default none)\n"
+              << "  --listen     run one island of a ring spread over machines, listening on this port\n"
+              << "  --peer       HOST:PORT of the next island in that ring\n"
+              << "  --index      this island's position in that ring (default 0)\n";
+}
+
+std::vector<City> loadCities(const std::string& path) {
+    std::vector<City> cities;
+    if (isInstanceFile(path)) {
+        MappedInstance instance(path);
+        for (size_t i = 0; i < instance.cityCount(); ++i) {
+            cities.push_back(City(instance.xs()[i], instance.ys()[i], static_cast<int>(i)));
+        }
+        return cities;
+    }
+
+    std::ifstream in(path);
+    if (!in) {
+        throw std::runtime_error("cannot open " + path);
+    }
+    double x, y;
+    while (in >> x >> y) {
+        cities.push_back(City(x, y, static_cast<int>(cities.size())));
+    }
+    return cities;
+}
+
+std::vector<City> randomCities(int count, unsigned seed) {
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<double> coord(0.0, 1000.0);
+    std::vector<City> cities;
+    for (int i = 0; i < count; ++i) {
+        double x = coord(rng);
+        double y = coord(rng);
+        cities.push_back(City(x, y, i));
+    }
+    return cities;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    IslandConfig config;
+    int islandCount = 2;
+    int cityCount = 1000;
+    std::string input;
+    int listenPort = -1;
+    std::string peer;
+    int index = 0;
+
+    for (int i = 1; i < argc; ++i) {
+        bool hasValue = i + 1 < argc;
+        if (std::strcmp(argv[i], "--islands") == 0 && hasValue) {
+            islandCount = std::atoi(argv[++i]);
+        } else if (std::strcmp(argv[i], "--population") == 0 && hasValue) {
+            config.population = std::atoi(argv[++i]);
+        } else if (std::strcmp(argv[i], "--epochs") == 0 && hasValue) {
+            config.epochs = std::atoi(argv[++i]);
+        } else if (std::strcmp(argv[i], "--epoch-iterations") == 0 && hasValue) {
+            config.epochIterations = std::atoi(argv[++i]);
+        } else if (std::strcmp(argv[i], "--cities") == 0 && hasValue) {
+            cityCount = std::atoi(argv[++i]);
+        } else if (std::strcmp(argv[i], "--input") == 0 && hasValue) {
+            input = argv[++i];
+        } else if (std::strcmp(argv[i], "--seed") == 0 && hasValue) {
+            config.seed = static_cast<unsigned>(std::strtoul(argv[++i], nullptr, 10));
+        } else if (std::strcmp(argv[i], "--placement") == 0 && hasValue) {
+            if (!parsePlacementPolicy(argv[++i], config.placement)) {
+                std::cerr << "Unknown placement: " << argv[i] << std::endl;
+                return 1;
+            }
+        } else if (std::strcmp(argv[i], "--listen") == 0 && hasValue) {
+            listenPort = std::atoi(argv[++i]);
+        } else if (std::strcmp(argv[i], "--peer") == 0 && hasValue) {
+            peer = argv[++i];
+        } else if (std::strcmp(argv[i], "--index") == 0 && hasValue) {
+            index = std::atoi(argv[++i]);
+        } else {
+            printUsage(argv[0]);
+            return std::strcmp(argv[i], "--help") == 0 ? 0 : 1;
+        }
+    }
+    if ((listenPort >= 0) != !peer.empty() || (!peer.empty() && peer.find(':') == std::string::npos)) {
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    try {
+        std::vector<City> cities = input.empty() ? randomCities(cityCount, config.seed) : loadCities(input);
+        TSPSolution solution;
+        IslandStats stats;
+        std::vector<std::vector<WorkerPlacement>> placements;
+        if (!peer.empty()) {
+            IslandSolver island;
+            island.setCities(cities);
+            island.setConfig(config);
+            island.setIslandIndex(index);
+            island.listen(listenPort, "0.0.0.0");
+            size_t colon = peer.rfind(':');
+            island.setPeer(peer.substr(0, colon), std::atoi(peer.c_str() + colon + 1));
+            solution = island.run();
+            stats = island.getStats();
+            placements.assign(1, island.getPlacements());
+            islandCount = 1;
+        } else {
+            solution = runIslands(cities, islandCount, config, &stats, &placements);
+        }
+
+        long fullBytes = stats.messages * static_cast<long>(24 + 4 * cities.size());
+        std::cout << "Islands:    " << islandCount << "\n"
+                  << "Cities:     " << cities.size() << "\n"
+                  << "Distance:   " << solution.distance << "\n"
+                  << "Time:       " << stats.seconds << " s\n"
+                  << "Throughput: " << (stats.seconds > 0.0 ? stats.iterations / stats.seconds : 0.0) << " iterations/s\n"
+                  << "Migration:  " << stats.messages << " messages (" << stats.deltaMessages << " deltas), "
+                  << stats.bytesSent << " bytes vs " << fullBytes << " as full tours, "
+                  << stats.migrantsAccepted << " migrants accepted" << std::endl;
+        for (size_t island = 0; island < placements.size(); ++island) {
+            for (const WorkerPlacement& worker : placements[island]) {
+                std::cout << "Placement:  island " << island << " worker " << worker.worker << " -> cpu " << worker.cpu
+                          << " (node " << worker.node << "), running on cpu " << worker.runningOn
+                          << (worker.pinned ? "" : ", not pinned") << "\n";
+            }
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -1,115 +1,700 @@
 #include "tsp_solver.h"
+#include "tour_kernels.h"
+#include "lower_bound.h"
+#include "exact_solver.h"
+#include "thread_placement.h"
+#include "solution_cache.h"
 #include <algorithm>
+#include <cassert>
 #include <cmath>
 #include <limits>
 #include <iostream>
 #include <random>
+#include <thread>
 
-TSPSolver::TSPSolver() 
-    : initialTemperature(10000.0),
+template<typename Scalar>
+BasicTSPSolver<Scalar>::BasicTSPSolver() 
+    : currentTour(nullptr),
+      bestTour(nullptr),
+      scratch(nullptr),
+      candidateFirst(nullptr),
+      candidateSecond(nullptr),
+      candidateDelta(nullptr),
+      candidateCapacity(0),
+      journal(nullptr),
+      journalSize(0),
+      journalCapacity(0),
+      bestMaterialised(true),
+      bestIteration(0),
+      currentLength(0),
+      bestLength(0),
+      initialTemperature(10000.0),
       coolingRate(0.995),
       minTemperature(1.0),
       maxIterations(100000),
+      iterationsPerTemperature(1),
+      candidatesPerStep(1),
+      resyncInterval(ScalarTraits<Scalar>::defaultResyncInterval),
+      coordinateScale(1.0),
+      spatialOrder(SpatialOrder::None),
+      journalLimit(0),
+      swapWeight(1.0),
+      segmentWeight(1.0),
+      segmentLimit(50),
+      stagnationLimit(0),
+      warmTemperature(0.0),
+      warmIterations(0),
+      targetGap(0.0),
+      parallelBound(true),
+      exactLimit(16),
+      solutionCache(nullptr),
+      placement(nullptr),
+      placementWorker(0),
+      placedCpu(-1),
       temperature(initialTemperature),
       iteration(0),
       running(false),
       finished(false),
+      movesSinceResync(0),
+      lowerBound(0.0),
+      lastKickIteration(0),
+      kickCount(0),
+      warmRestarting(false),
+      warmBudget(0),
+      warmCooling(1.0),
       rng(std::chrono::steady_clock::now().time_since_epoch().count()) {
 }
 
-void TSPSolver::setCities(const std::vector<City>& cities) {
+template<typename Scalar>
+void BasicTSPSolver<Scalar>::setCities(const std::vector<City>& cities) {
     this->cities = cities;
+    lowerBound = 0.0;
+    originalIndex.clear();
+    if (spatialOrder != SpatialOrder::None) {
+        std::vector<double> px(cities.size()), py(cities.size());
+        for (size_t i = 0; i < cities.size(); ++i) {
+            px[i] = cities[i].x;
+            py[i] = cities[i].y;
+        }
+        originalIndex = spatialOrdering(px.data(), py.data(), cities.size(), spatialOrder);
+    }
+    
+    xs.resize(cities.size());
+    ys.resize(cities.size());
+    for (size_t i = 0; i < cities.size(); ++i) {
+        const City& city = cities[originalIndex.empty() ? i : originalIndex[i]];
+        xs[i] = ScalarTraits<Scalar>::fromCoordinate(city.x, coordinateScale);
+        ys[i] = ScalarTraits<Scalar>::fromCoordinate(city.y, coordinateScale);
+    }
     reset();
 }
 
-void TSPSolver::reset() {
+// Carves the tours, candidate buffers and scratch space for the current
+// instance out of the arena. The arena only grows, so repeated resets of the
+// same instance reuse the block it already holds.
+template<typename Scalar>
+void BasicTSPSolver<Scalar>::layoutBuffers() {
+    size_t n = cities.size();
+    candidateCapacity = static_cast<size_t>(candidatesPerStep);
+    journalCapacity = journalLimit > 0 ? static_cast<size_t>(journalLimit) : std::max<size_t>(n, 1);
+    
+    arena.reserve(3 * SolverArena::footprint<int>(n) +
+                  2 * SolverArena::footprint<int>(candidateCapacity) +
+                  SolverArena::footprint<Length>(candidateCapacity) +
+                  SolverArena::footprint<MoveRecord>(journalCapacity));
+    currentTour = arena.allocate<int>(n);
+    bestTour = arena.allocate<int>(n);
+    scratch = arena.allocate<int>(n);
+    candidateFirst = arena.allocate<int>(candidateCapacity);
+    candidateSecond = arena.allocate<int>(candidateCapacity);
+    candidateDelta = arena.allocate<Length>(candidateCapacity);
+    journal = arena.allocate<MoveRecord>(journalCapacity);
+}
+
+template<typename Scalar>
+void BasicTSPSolver<Scalar>::pinThread() {
+    if (!placement || !placement->pin(placementWorker)) return;
+    int cpu = placement->cpuFor(placementWorker);
+    if (cpu != placedCpu) {
+        placedCpu = cpu;
+        localiseBuffers();
+    }
+}
+
+// Copies everything the annealing loop touches into memory allocated (and
+// so first-touched) by the calling thread
+template<typename Scalar>
+void BasicTSPSolver<Scalar>::localiseBuffers() {
+    std::vector<Scalar>(xs).swap(xs);
+    std::vector<Scalar>(ys).swap(ys);
+    if (!currentTour) return;
+    size_t n = cities.size();
+    materialiseBest();
+    std::vector<int> current(currentTour, currentTour + n);
+    std::vector<int> best(bestTour, bestTour + n);
+    arena = SolverArena();
+    layoutBuffers();
+    std::copy(current.begin(), current.end(), currentTour);
+    std::copy(best.begin(), best.end(), bestTour);
+}
+
+template<typename Scalar>
+void BasicTSPSolver<Scalar>::reset() {
+    layoutBuffers();
+    
     if (!cities.empty()) {
-        currentSolution.tour = generateInitialTour();
-        currentSolution.distance = calculateDistance(currentSolution.tour);
-        bestSolution = currentSolution;
+        generateInitialTour(currentTour);
+        std::copy(currentTour, currentTour + cities.size(), bestTour);
+        currentLength = calculateDistance(currentTour);
+        bestLength = currentLength;
     } else {
-        currentSolution = TSPSolution();
-        bestSolution = TSPSolution();
+        currentLength = 0;
+        bestLength = 0;
     }
+    journalSize = 0;
+    bestMaterialised = true;
+    bestIteration = 0;
     
     temperature = initialTemperature;
     iteration = 0;
     running = false;
     finished = false;
+    movesSinceResync = 0;
+    precisionStats = PrecisionStats();
+    lastKickIteration = 0;
+    kickCount = 0;
+    warmRestarting = false;
 }
 
-TSPSolution TSPSolver::solve() {
+template<typename Scalar>
+TSPSolution BasicTSPSolver<Scalar>::solve() {
+    pinThread();
+    TSPSolution solution;
     if (cities.size() < 2) {
-        return currentSolution;
+        solution = makeSolution(currentTour, currentLength);
+    } else {
+        reset();
+        if (cities.size() <= static_cast<size_t>(exactLimit)) {
+            solution = solveExactly();
+        } else {
+            solution = solutionCache ? solveThroughCache() : runToCompletion();
+        }
     }
-    
-    reset();
+    if (placement) ThreadPlacement::release();
+    return solution;
+}
+
+template<typename Scalar>
+TSPSolution BasicTSPSolver<Scalar>::reoptimise() {
+    if (cities.size() < 2) {
+        return makeSolution(currentTour, currentLength);
+    }
+    return runToCompletion();
+}
+
+template<typename Scalar>
+TSPSolution BasicTSPSolver<Scalar>::runToCompletion() {
     running = true;
     
-    while (temperature > minTemperature && iteration < maxIterations && running) {
-        // Generate neighbor solution
-        std::vector<int> newTour = generateNeighbor(currentSolution.tour);
-        double newDistance = calculateDistance(newTour);
-        
-        // Decide whether to accept the new solution
-        if (newDistance < currentSolution.distance || 
-            acceptanceProbability(currentSolution.distance, newDistance, temperature) > std::uniform_real_distribution<double>(0.0, 1.0)(rng)) {
-            
-            currentSolution.tour = newTour;
-            currentSolution.distance = newDistance;
-            
-            // Update best solution if this is better
-            if (newDistance < bestSolution.distance) {
-                bestSolution = currentSolution;
-            }
+    // The bound is polled every few thousand iterations and abandoned
+    // when the schedule ends first
+    bool boundWanted = targetGap > 0.0 && lowerBound <= 0.0 && cities.size() >= 3;
+    if (boundWanted && !parallelBound) {
+        computeLowerBound();
+        boundWanted = false;
+    }
+    HeldKarpBound bound;
+    std::thread boundThread;
+    if (boundWanted) {
+        std::vector<double> px(cities.size()), py(cities.size());
+        for (size_t i = 0; i < cities.size(); ++i) {
+            px[i] = cities[i].x;
+            py[i] = cities[i].y;
         }
-        
-        // Cool down
-        temperature *= coolingRate;
-        iteration++;
+        bound.setCoordinates(px.data(), py.data(), cities.size());
+        boundThread = std::thread([&bound]() { bound.compute(); });
     }
     
+    while (!exhausted() && running) {
+        anneal();
+        if (boundWanted && (iteration & 4095) == 0) lowerBound = bound.getBound();
+    }
+    
+    if (boundWanted) {
+        bound.cancel();
+        boundThread.join();
+        lowerBound = bound.getBound();
+    }
     running = false;
     finished = true;
-    return bestSolution;
+    
+    // Report the best tour's exact length rather than the accumulated one
+    materialiseBest();
+    bestLength = calculateDistance(bestTour);
+    return makeSolution(bestTour, bestLength);
 }
 
-bool TSPSolver::step() {
-    if (cities.size() < 2 || temperature <= minTemperature || iteration >= maxIterations) {
-        running = false;
+template<typename Scalar>
+TSPSolution BasicTSPSolver<Scalar>::solveThroughCache() {
+    SolutionCache::Match match = solutionCache->lookup(cities);
+    if (match.kind == SolutionCache::MATCH_EXACT && seedTour(match.tour)) {
         finished = true;
-        return false;
+        return getCurrentSolution();
+    }
+    if (match.kind != SolutionCache::MATCH_NEAR) {
+        TSPSolution solution = runToCompletion();
+        solutionCache->store(cities, solution.tour, solution.distance);
+        return solution;
+    }
+    
+    // Load the cached instance with its tour, then edit it into the query:
+    // origin holds the query index of every city loaded (-1 = not in it)
+    std::vector<City> query = cities;
+    std::vector<int> origin = match.tour;
+    std::vector<int> cachedOrder(match.cachedTour.size());
+    for (size_t i = 0; i < cachedOrder.size(); ++i) cachedOrder[i] = static_cast<int>(i);
+    setCities(match.cachedTour);
+    seedTour(cachedOrder);
+    for (int i = static_cast<int>(origin.size()) - 1; i >= 0; --i) {
+        if (origin[i] >= 0) continue;
+        removeCity(i);
+        origin.erase(origin.begin() + i);
     }
+    for (int added : match.added) {
+        addCity(query[added]);
+        origin.push_back(added);
+    }
+    TSPSolution edited = reoptimise();
     
-    // Generate neighbor solution
-    std::vector<int> newTour = generateNeighbor(currentSolution.tour);
-    double newDistance = calculateDistance(newTour);
+    std::vector<int> tour(edited.tour.size());
+    for (size_t i = 0; i < tour.size(); ++i) tour[i] = origin[edited.tour[i]];
+    setCities(query);
+    seedTour(tour);
+    finished = true;
+    TSPSolution solution = getCurrentSolution();
+    solutionCache->store(cities, solution.tour, solution.distance);
+    return solution;
+}
+
+// Costs in internal order through the scalar's own edge lengths, so the
+// optimum is optimal under the metric the annealer would have used
+template<typename Scalar>
+TSPSolution BasicTSPSolver<Scalar>::solveExactly() {
+    size_t n = cities.size();
+    std::vector<double> costs(n * n);
+    for (size_t a = 0; a < n; ++a) {
+        for (size_t b = 0; b < n; ++b) costs[a * n + b] = toDistance(edgeLength(static_cast<int>(a), static_cast<int>(b)));
+    }
+    ExactSolver exact;
+    exact.setCostMatrix(costs.data(), n);
+    exact.setDynamicProgrammingLimit(exactLimit);
+    std::vector<int> tour = exact.solve();
+    // Never reached while setExactLimit caps the limit, but an empty tour
+    // must not pass for an optimal one
+    if (tour.empty()) return solutionCache ? solveThroughCache() : runToCompletion();
     
-    // Decide whether to accept the new solution
-    if (newDistance < currentSolution.distance || 
-        acceptanceProbability(currentSolution.distance, newDistance, temperature) > std::uniform_real_distribution<double>(0.0, 1.0)(rng)) {
-        
-        currentSolution.tour = newTour;
-        currentSolution.distance = newDistance;
-        
-        // Update best solution if this is better
-        if (newDistance < bestSolution.distance) {
-            bestSolution = currentSolution;
+    std::copy(tour.begin(), tour.end(), currentTour);
+    std::copy(tour.begin(), tour.end(), bestTour);
+    currentLength = calculateDistance(currentTour);
+    bestLength = currentLength;
+    lowerBound = toDistance(bestLength);
+    running = false;
+    finished = true;
+    return makeSolution(bestTour, bestLength);
+}
+
+template<typename Scalar>
+bool BasicTSPSolver<Scalar>::exhausted() const {
+    if (lowerBound > 0.0 && targetGap > 0.0 && toDistance(bestLength) <= lowerBound * (1.0 + targetGap)) return true;
+    if (warmRestarting) return iteration >= warmBudget;
+    return temperature <= minTemperature || iteration >= maxIterations;
+}
+
+template<typename Scalar>
+double BasicTSPSolver<Scalar>::computeLowerBound() {
+    std::vector<double> px(cities.size()), py(cities.size());
+    for (size_t i = 0; i < cities.size(); ++i) {
+        px[i] = cities[i].x;
+        py[i] = cities[i].y;
+    }
+    HeldKarpBound bound;
+    bound.setCoordinates(px.data(), py.data(), cities.size());
+    lowerBound = bound.compute();
+    return lowerBound;
+}
+
+template<typename Scalar>
+void BasicTSPSolver<Scalar>::addCity(const City& city) {
+    materialiseBest();
+    std::vector<int> tour(bestTour, bestTour + cities.size());
+    
+    cities.push_back(city);
+    lowerBound = 0.0;
+    xs.push_back(ScalarTraits<Scalar>::fromCoordinate(city.x, coordinateScale));
+    ys.push_back(ScalarTraits<Scalar>::fromCoordinate(city.y, coordinateScale));
+    int added = static_cast<int>(cities.size()) - 1;
+    if (!originalIndex.empty()) originalIndex.push_back(added);
+    
+    // Cheapest insertion: the edge whose detour through the new city is shortest
+    size_t insertAfter = 0;
+    if (tour.size() >= 2) {
+        Length bestCost = 0;
+        for (size_t i = 0; i < tour.size(); ++i) {
+            int a = tour[i];
+            int b = tour[i + 1 == tour.size() ? 0 : i + 1];
+            Length cost = edgeLength(a, added) + edgeLength(added, b) - edgeLength(a, b);
+            if (i == 0 || cost < bestCost) {
+                bestCost = cost;
+                insertAfter = i;
+            }
         }
     }
+    tour.insert(tour.begin() + (tour.empty() ? 0 : insertAfter + 1), added);
+    warmRestart(tour);
+}
+
+template<typename Scalar>
+void BasicTSPSolver<Scalar>::removeCity(int index) {
+    if (index < 0 || static_cast<size_t>(index) >= cities.size()) return;
+    materialiseBest();
+    cities.erase(cities.begin() + index);
+    lowerBound = 0.0;
+    int removed = removeFromOrdering(originalIndex, index);
+    
+    // Splicing out joins the removed city's two tour neighbours directly
+    std::vector<int> tour;
+    tour.reserve(cities.size());
+    for (size_t i = 0; i <= cities.size(); ++i) {
+        int city = bestTour[i];
+        if (city != removed) tour.push_back(city > removed ? city - 1 : city);
+    }
+    xs.erase(xs.begin() + removed);
+    ys.erase(ys.begin() + removed);
+    warmRestart(tour);
+}
+
+template<typename Scalar>
+bool BasicTSPSolver<Scalar>::seedTour(const std::vector<int>& tour) {
+    size_t n = cities.size();
+    if (tour.size() != n || n == 0) return false;
+    std::vector<int> renumbered(n);
+    for (size_t i = 0; i < n; ++i) renumbered[originalIndex.empty() ? i : originalIndex[i]] = static_cast<int>(i);
+    std::vector<char> seen(n, 0);
+    for (int city : tour) {
+        if (city < 0 || static_cast<size_t>(city) >= n || seen[city]) return false;
+        seen[city] = 1;
+    }
+    for (size_t i = 0; i < n; ++i) currentTour[i] = renumbered[tour[i]];
+    std::copy(currentTour, currentTour + n, bestTour);
+    currentLength = calculateDistance(currentTour);
+    bestLength = currentLength;
+    journalSize = 0;
+    bestMaterialised = true;
+    bestIteration = iteration;
+    movesSinceResync = 0;
+    return true;
+}
+
+// Makes `tour` both the current and the best tour and arms a short
+// re-anneal that cools a thousandfold over its budget.
+template<typename Scalar>
+void BasicTSPSolver<Scalar>::warmRestart(const std::vector<int>& tour) {
+    layoutBuffers();
+    std::copy(tour.begin(), tour.end(), currentTour);
+    std::copy(tour.begin(), tour.end(), bestTour);
+    currentLength = calculateDistance(currentTour);
+    bestLength = currentLength;
+    journalSize = 0;
+    bestMaterialised = true;
+    bestIteration = 0;
+    
+    size_t n = cities.size();
+    double meanEdge = n > 0 ? toDistance(currentLength) / static_cast<double>(n) : 0.0;
+    temperature = warmTemperature > 0.0 ? warmTemperature : std::max(0.1 * meanEdge, 1e-9);
+    warmBudget = warmIterations > 0 ? warmIterations : static_cast<int>(std::min<size_t>(100 * n, 10000000));
+    warmCooling = std::pow(1e-3, 1.0 / std::max(warmBudget, 1));
+    warmRestarting = true;
+    
+    iteration = 0;
+    running = false;
+    finished = false;
+    movesSinceResync = 0;
+    lastKickIteration = 0;
+}
+
+template<typename Scalar>
+void BasicTSPSolver<Scalar>::setMoveWeights(double swap, double segmentInsertion) {
+    swapWeight = std::max(swap, 0.0);
+    segmentWeight = std::max(segmentInsertion, 0.0);
+    if (swapWeight + segmentWeight <= 0.0) swapWeight = 1.0;
+}
+
+template<typename Scalar>
+void BasicTSPSolver<Scalar>::applyProfile(const SolverProfile& profile) {
+    std::vector<double> px(cities.size()), py(cities.size());
+    for (size_t i = 0; i < cities.size(); ++i) {
+        px[i] = cities[i].x;
+        py[i] = cities[i].y;
+    }
+    double edge = typicalEdgeLength(px.data(), py.data(), cities.size());
+    initialTemperature = profile.temperatureFactor * edge;
+    minTemperature = profile.minTemperatureFactor * edge;
+    coolingRate = profile.coolingRate;
+    setIterationsPerTemperature(profile.iterationsPerTemperature);
+    if (profile.iterationsPerCity > 0) {
+        double budget = static_cast<double>(profile.iterationsPerCity) * cities.size();
+        maxIterations = static_cast<int>(std::min(budget, static_cast<double>(std::numeric_limits<int>::max())));
+    }
+    setMoveWeights(profile.swapWeight, profile.segmentWeight);
+    reset();
+}
+
+// One annealing iteration: score a neighbour by its O(1) delta and apply it
+// in place if accepted, so no neighbour tour is ever materialised.
+template<typename Scalar>
+void BasicTSPSolver<Scalar>::anneal() {
+    // Segment moves need two blocks plus the fixed position 0
+    bool segmentMove = cities.size() >= 5 &&
+        std::uniform_real_distribution<double>(0.0, swapWeight + segmentWeight)(rng) >= swapWeight;
+    
+    MoveRecord move;
+    Length delta;
+    if (segmentMove) {
+        move = generateSegmentMove();
+        delta = segmentDelta(move);
+    } else {
+        int chosen = generateNeighbor();
+        move = MoveRecord{MOVE_SWAP, candidateFirst[chosen], candidateSecond[chosen], 0};
+        delta = candidateDelta[chosen];
+    }
+    Length newLength = currentLength + delta;
+    
+    // Decide whether to accept the new solution
+    if (newLength < currentLength || 
+        acceptanceProbability(toDistance(currentLength), toDistance(newLength), temperature) > std::uniform_real_distribution<double>(0.0, 1.0)(rng)) {
+        commitMove(move, delta);
+    }
+    
+    // Deep minima late in the run: perturb with a double bridge
+    if (stagnationLimit > 0 && iteration - std::max(bestIteration, lastKickIteration) >= stagnationLimit) {
+        kick();
+    }
     
     // Cool down
-    temperature *= coolingRate;
     iteration++;
+    if (warmRestarting) {
+        temperature *= warmCooling;
+    } else if (iteration % iterationsPerTemperature == 0) {
+        temperature *= coolingRate;
+    }
+}
+
+template<typename Scalar>
+void BasicTSPSolver<Scalar>::commitMove(const MoveRecord& move, Length delta) {
+    applyMove(currentTour, move);
+    currentLength += delta;
+    recordAcceptedMove(move);
+    
+    // Deltas accumulate rounding error (quickly so in reduced precision),
+    // so the running length is periodically recomputed exactly.
+    if (resyncInterval > 0 && ++movesSinceResync >= resyncInterval) {
+        verifyRunningLength();
+    }
+    
+    // A new best costs O(1): the current tour *is* the best until the
+    // next accepted move, so the journal simply starts over.
+    if (currentLength < bestLength) {
+        bestLength = currentLength;
+        bestIteration = iteration;
+        bestMaterialised = false;
+        journalSize = 0;
+    }
+}
+
+// Kept out of commitMove so the hot path only pays for the counter.
+template<typename Scalar>
+void BasicTSPSolver<Scalar>::verifyRunningLength() {
+    size_t n = cities.size();
+#ifndef NDEBUG
+    std::vector<char> seen(n, 0);
+    for (size_t i = 0; i < n; ++i) {
+        assert(currentTour[i] >= 0 && static_cast<size_t>(currentTour[i]) < n && !seen[currentTour[i]]);
+        seen[currentTour[i]] = 1;
+    }
+#endif
+    Length exact = compensatedTourLength(xs.data(), ys.data(), currentTour, n);
+    double drift = std::abs(toDistance(currentLength) - toDistance(exact));
+    precisionStats.checks++;
+    precisionStats.lastDrift = drift;
+    precisionStats.maxDrift = std::max(precisionStats.maxDrift, drift);
+    currentLength = exact;
+    movesSinceResync = 0;
+}
+
+// Or-opt style segment insertion: a segment of up to segmentLimit cities is
+// moved forwards or backwards past a neighbouring block. Position 0 never
+// moves, which keeps both blocks inside the array.
+template<typename Scalar>
+typename BasicTSPSolver<Scalar>::MoveRecord BasicTSPSolver<Scalar>::generateSegmentMove() {
+    int n = static_cast<int>(cities.size());
+    auto uniform = [&](int lo, int hi) { return std::uniform_int_distribution<int>(lo, hi)(rng); };
+    
+    int length = uniform(1, std::min(segmentLimit, n - 3));
+    int first, second, third;
+    if (uniform(0, 1) == 0) {
+        first = uniform(1, n - 1 - length);
+        second = first + length - 1;
+        third = uniform(second + 1, n - 1);
+    } else {
+        second = uniform(1, n - 1 - length);
+        third = second + length;
+        first = uniform(1, second);
+    }
+    return MoveRecord{uniform(0, 1) == 0 ? MOVE_SEGMENT : MOVE_SEGMENT_REVERSED, first, second, third};
+}
+
+// Exchanging [i..j] and [j+1..k] replaces three edges; with reversal the
+// block [i..j] is entered at j and left at i instead.
+template<typename Scalar>
+typename BasicTSPSolver<Scalar>::Length BasicTSPSolver<Scalar>::segmentDelta(const MoveRecord& move) const {
+    const int* t = currentTour;
+    int before = t[move.first - 1];
+    int head = t[move.first];
+    int tail = t[move.second];
+    int otherHead = t[move.second + 1];
+    int otherTail = t[move.third];
+    int after = t[static_cast<size_t>(move.third) + 1 == cities.size() ? 0 : move.third + 1];
+    
+    Length removed = edgeLength(before, head) + edgeLength(tail, otherHead) + edgeLength(otherTail, after);
+    if (move.kind == MOVE_SEGMENT_REVERSED) {
+        return edgeLength(before, otherHead) + edgeLength(otherTail, tail) + edgeLength(head, after) - removed;
+    }
+    return edgeLength(before, otherHead) + edgeLength(otherTail, head) + edgeLength(tail, after) - removed;
+}
+
+// Double bridge: A B C D -> A C B D. It is the segment exchange of B and C
+// with long blocks, applied unconditionally.
+template<typename Scalar>
+void BasicTSPSolver<Scalar>::kick() {
+    lastKickIteration = iteration;
+    int n = static_cast<int>(cities.size());
+    if (n < 8) return;
+    
+    std::uniform_int_distribution<int> cut(1, n - 1);
+    int cuts[3];
+    do {
+        cuts[0] = cut(rng);
+        cuts[1] = cut(rng);
+        cuts[2] = cut(rng);
+        std::sort(cuts, cuts + 3);
+    } while (cuts[0] == cuts[1] || cuts[1] == cuts[2]);
+    
+    MoveRecord move{MOVE_SEGMENT, cuts[0], cuts[1] - 1, cuts[2] - 1};
+    commitMove(move, segmentDelta(move));
+    kickCount++;
+}
+
+template<typename Scalar>
+void BasicTSPSolver<Scalar>::applyMove(int* tour, const MoveRecord& move) {
+    if (move.kind == MOVE_SWAP) {
+        std::swap(tour[move.first], tour[move.second]);
+        return;
+    }
+    std::rotate(tour + move.first, tour + move.second + 1, tour + move.third + 1);
+    if (move.kind == MOVE_SEGMENT_REVERSED) {
+        // The original [first..second] block now ends the range
+        std::reverse(tour + move.third - (move.second - move.first), tour + move.third + 1);
+    }
+}
+
+template<typename Scalar>
+void BasicTSPSolver<Scalar>::undoMove(int* tour, const MoveRecord& move) {
+    if (move.kind == MOVE_SWAP) {
+        std::swap(tour[move.first], tour[move.second]);
+        return;
+    }
+    int movedLength = move.third - move.second;
+    if (move.kind == MOVE_SEGMENT_REVERSED) {
+        std::reverse(tour + move.first + movedLength, tour + move.third + 1);
+    }
+    std::rotate(tour + move.first, tour + move.first + movedLength, tour + move.third + 1);
+}
+
+template<typename Scalar>
+bool BasicTSPSolver<Scalar>::step() {
+    if (cities.size() < 2 || exhausted()) {
+        running = false;
+        finished = true;
+        return false;
+    }
+    
+    anneal();
     
     return true;
 }
 
-TSPSolution TSPSolver::getCurrentSolution() const {
-    return bestSolution;
+template<typename Scalar>
+TSPSolution BasicTSPSolver<Scalar>::getCurrentSolution() const {
+    if (bestMaterialised) {
+        return makeSolution(bestTour, bestLength);
+    }
+    TSPSolution solution = makeSolution(currentTour, bestLength);
+    undoJournal(solution.tour.data());
+    return solution;
+}
+
+template<typename Scalar>
+void BasicTSPSolver<Scalar>::recordAcceptedMove(const MoveRecord& move) {
+    if (bestMaterialised) return;
+    
+    // Replaying a long journal would cost more than one copy, so snapshot now
+    if (journalSize == journalCapacity) {
+        // The overflowing move is already applied to the current tour and is
+        // the newest, so it is undone before the journaled ones
+        std::copy(currentTour, currentTour + cities.size(), bestTour);
+        undoMove(bestTour, move);
+        undoJournal(bestTour);
+        bestMaterialised = true;
+        journalSize = 0;
+        return;
+    }
+    journal[journalSize++] = move;
 }
 
-void TSPSolver::start() {
+template<typename Scalar>
+void BasicTSPSolver<Scalar>::undoJournal(int* tour) const {
+    for (size_t k = journalSize; k-- > 0;) {
+        undoMove(tour, journal[k]);
+    }
+}
+
+// Rebuilds the best tour from the current one by undoing the journal.
+template<typename Scalar>
+void BasicTSPSolver<Scalar>::materialiseBest() {
+    if (bestMaterialised) return;
+    
+    std::copy(currentTour, currentTour + cities.size(), bestTour);
+    undoJournal(bestTour);
+    bestMaterialised = true;
+    journalSize = 0;
+}
+
+template<typename Scalar>
+TSPSolution BasicTSPSolver<Scalar>::makeSolution(const int* tour, Length length) const {
+    TSPSolution solution;
+    if (tour) {
+        solution.tour.assign(tour, tour + cities.size());
+        if (!originalIndex.empty()) {
+            for (int& city : solution.tour) city = originalIndex[city];
+        }
+    }
+    solution.distance = toDistance(length);
+    return solution;
+}
+
+template<typename Scalar>
+void BasicTSPSolver<Scalar>::start() {
+    pinThread();
     if (cities.size() < 2) return;
     
     if (finished) {
@@ -119,70 +704,82 @@ void TSPSolver::start() {
     running = true;
 }
 
-void TSPSolver::pause() {
+template<typename Scalar>
+void BasicTSPSolver<Scalar>::pause() {
     running = false;
+    if (placement) ThreadPlacement::release();
 }
 
-void TSPSolver::resume() {
+template<typename Scalar>
+void BasicTSPSolver<Scalar>::resume() {
+    pinThread();
     if (finished) {
         reset();
     }
     running = true;
 }
 
-std::vector<int> TSPSolver::generateInitialTour() const {
-    std::vector<int> tour(cities.size());
+template<typename Scalar>
+void BasicTSPSolver<Scalar>::generateInitialTour(int* tour) const {
     for (size_t i = 0; i < cities.size(); ++i) {
         tour[i] = static_cast<int>(i);
     }
     
     // Shuffle the tour
-    std::shuffle(tour.begin(), tour.end(), rng);
-    return tour;
+    std::shuffle(tour, tour + cities.size(), rng);
 }
 
-std::vector<int> TSPSolver::generateNeighbor(const std::vector<int>& tour) const {
-    std::vector<int> newTour = tour;
+// Draws candidatesPerStep swap proposals, scores them in one kernel pass
+// and returns the index of the best one.
+template<typename Scalar>
+int BasicTSPSolver<Scalar>::generateNeighbor() {
+    size_t count = std::min(static_cast<size_t>(candidatesPerStep), candidateCapacity);
     
-    // Swap two random cities
-    if (newTour.size() > 1) {
-        std::uniform_int_distribution<size_t> dist(0, newTour.size() - 1);
-        size_t i = dist(rng);
-        size_t j = dist(rng);
+    std::uniform_int_distribution<int> dist(0, static_cast<int>(cities.size()) - 1);
+    for (size_t c = 0; c < count; ++c) {
+        int i = dist(rng);
+        int j = dist(rng);
         
         // Ensure i != j
         while (j == i) {
             j = dist(rng);
         }
-        
-        std::swap(newTour[i], newTour[j]);
+        candidateFirst[c] = i;
+        candidateSecond[c] = j;
     }
     
-    return newTour;
-}
-
-double TSPSolver::calculateDistance(const std::vector<int>& tour) const {
-    if (tour.size() < 2) return 0.0;
+    evaluateSwapDeltas(xs.data(), ys.data(), currentTour, cities.size(),
+                       candidateFirst, candidateSecond, candidateDelta, count);
     
-    double totalDistance = 0.0;
-    for (size_t i = 0; i < tour.size(); ++i) {
-        const City& from = cities[tour[i]];
-        const City& to = cities[tour[(i + 1) % tour.size()]];
-        totalDistance += distance(from, to);
+    int best = 0;
+    for (size_t c = 1; c < count; ++c) {
+        if (candidateDelta[c] < candidateDelta[best]) {
+            best = static_cast<int>(c);
+        }
     }
-    
-    return totalDistance;
+    return best;
 }
 
-double TSPSolver::distance(const City& a, const City& b) const {
+template<typename Scalar>
+typename BasicTSPSolver<Scalar>::Length BasicTSPSolver<Scalar>::calculateDistance(const int* tour) const {
+    return tourLength(xs.data(), ys.data(), tour, cities.size());
+}
+
+template<typename Scalar>
+double BasicTSPSolver<Scalar>::distance(const City& a, const City& b) const {
     double dx = a.x - b.x;
     double dy = a.y - b.y;
     return std::sqrt(dx * dx + dy * dy);
 }
 
-double TSPSolver::acceptanceProbability(double oldDistance, double newDistance, double temperature) const {
+template<typename Scalar>
+double BasicTSPSolver<Scalar>::acceptanceProbability(double oldDistance, double newDistance, double temperature) const {
     if (newDistance < oldDistance) {
         return 1.0;
     }
     return std::exp((oldDistance - newDistance) / temperature);
-}
\ No newline at end of file
+}
+
+template class BasicTSPSolver<double>;
+template class BasicTSPSolver<float>;
+template class BasicTSPSolver<std::int32_t>;
\ No newline at end of file
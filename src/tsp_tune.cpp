@@ -0,0 +1,121 @@
+#include "profile_tuner.h"
+#include "instance_file.h"
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <string>
+
+namespace {
+
+void printUsage(const char* program) {
+    std::cout << "Usage: " << program << " (--instances FILE... | --random K N) [options]\n"
+              << "  --instances  .tspb or \"x y\" text instances to tune on\n"
+              << "  --random     K random instances of N cities each\n"
+              << "  --configs    configurations raced (default 27)\n"
+              << "  --eta        survivors are the best 1/eta of each rung (default 3)\n"
+              << "  --budget     total CPU seconds (default 60)\n"
+              << "  --threads    worker threads (default: all cores)\n"
+              << "  --mode       sa|ils|hybrid (default sa)\n"
+              << "  --seed       sampling seed (default 1)\n"
+              << "  --output     profile file to write (default tsp_profile.txt)\n";
+}
+
+std::vector<City> loadCities(const std::string& path) {
+    std::vector<City> cities;
+    if (isInstanceFile(path)) {
+        MappedInstance instance(path);
+        for (size_t i = 0; i < instance.cityCount(); ++i) {
+            cities.push_back(City(instance.xs()[i], instance.ys()[i], static_cast<int>(i)));
+        }
+        return cities;
+    }
+
+    std::ifstream in(path);
+    if (!in) {
+        throw std::runtime_error("cannot open " + path);
+    }
+    double x, y;
+    while (in >> x >> y) {
+        cities.push_back(City(x, y, static_cast<int>(cities.size())));
+    }
+    return cities;
+}
+
+std::vector<City> randomCities(int count, std::mt19937& rng) {
+    std::uniform_real_distribution<double> coord(0.0, 1000.0);
+    std::vector<City> cities;
+    for (int i = 0; i < count; ++i) {
+        double x = coord(rng);
+        double y = coord(rng);
+        cities.push_back(City(x, y, i));
+    }
+    return cities;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    ProfileTuner tuner;
+    std::vector<std::string> files;
+    int randomCount = 0;
+    int randomSize = 0;
+    unsigned seed = 1;
+    SolverMode mode = SolverMode::Annealing;
+    std::string output = "tsp_profile.txt";
+
+    for (int i = 1; i < argc; ++i) {
+        bool hasValue = i + 1 < argc;
+        if (std::strcmp(argv[i], "--instances") == 0) {
+            while (i + 1 < argc && std::strncmp(argv[i + 1], "--", 2) != 0) files.push_back(argv[++i]);
+        } else if (std::strcmp(argv[i], "--random") == 0 && i + 2 < argc) {
+            randomCount = std::atoi(argv[++i]);
+            randomSize = std::atoi(argv[++i]);
+        } else if (std::strcmp(argv[i], "--configs") == 0 && hasValue) {
+            tuner.setConfigurationCount(std::atoi(argv[++i]));
+        } else if (std::strcmp(argv[i], "--eta") == 0 && hasValue) {
+            tuner.setEta(std::atoi(argv[++i]));
+        } else if (std::strcmp(argv[i], "--budget") == 0 && hasValue) {
+            tuner.setBudgetSeconds(std::atof(argv[++i]));
+        } else if (std::strcmp(argv[i], "--threads") == 0 && hasValue) {
+            tuner.setThreadCount(std::atoi(argv[++i]));
+        } else if (std::strcmp(argv[i], "--mode") == 0 && hasValue) {
+            if (!parseSolverMode(argv[++i], mode) || mode == SolverMode::Memetic) {
+                std::cerr << "Unknown mode: " << argv[i] << std::endl;
+                return 1;
+            }
+        } else if (std::strcmp(argv[i], "--seed") == 0 && hasValue) {
+            seed = static_cast<unsigned>(std::strtoul(argv[++i], nullptr, 10));
+        } else if (std::strcmp(argv[i], "--output") == 0 && hasValue) {
+            output = argv[++i];
+        } else {
+            printUsage(argv[0]);
+            return std::strcmp(argv[i], "--help") == 0 ? 0 : 1;
+        }
+    }
+    if (files.empty() && (randomCount <= 0 || randomSize < 2)) {
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    try {
+        std::vector<std::vector<City>> instances;
+        for (const std::string& file : files) instances.push_back(loadCities(file));
+        std::mt19937 rng(seed);
+        for (int i = 0; i < randomCount; ++i) instances.push_back(randomCities(randomSize, rng));
+
+        tuner.setInstances(instances);
+        tuner.setMode(mode);
+        tuner.setSeed(seed);
+        tuner.setLog(&std::cout);
+        SolverProfile profile = tuner.tune();
+        saveProfile(output, profile, std::string("tsp_tune, mode ") + solverModeName(mode) +
+                                         ", score " + std::to_string(tuner.getBestScore()));
+        std::cout << "Wrote " << output << std::endl;
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
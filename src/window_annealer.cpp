@@ -0,0 +1,63 @@
+#include "window_annealer.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+inline double edge(const double* xs, const double* ys, int a, int b) {
+    double dx = xs[a] - xs[b];
+    double dy = ys[a] - ys[b];
+    return std::sqrt(dx * dx + dy * dy);
+}
+
+} // namespace
+
+double annealWindow(const double* xs, const double* ys, int* tour, std::size_t n,
+                    std::size_t begin, std::size_t length,
+                    const WindowAnnealParams& params, std::mt19937& rng) {
+    // Two fixed ends plus at least two movable positions
+    if (length < 4 || length > n || params.iterations <= 0) return 0.0;
+
+    auto pos = [&](std::size_t k) { return (begin + k) % n; };
+
+    double startTemp = params.startTemperature;
+    double endTemp = params.endTemperature;
+    if (startTemp <= 0.0 || endTemp <= 0.0) {
+        double total = 0.0;
+        for (std::size_t k = 0; k + 1 < length; ++k) {
+            total += edge(xs, ys, tour[pos(k)], tour[pos(k + 1)]);
+        }
+        double mean = total / static_cast<double>(length - 1);
+        if (startTemp <= 0.0) startTemp = 0.1 * mean;
+        if (endTemp <= 0.0) endTemp = 0.001 * mean;
+    }
+    double cooling = std::pow(endTemp / startTemp, 1.0 / static_cast<double>(params.iterations));
+
+    std::uniform_int_distribution<std::size_t> interior(1, length - 2);
+    std::uniform_real_distribution<double> unit(0.0, 1.0);
+    double temperature = startTemp;
+    double change = 0.0;
+
+    for (long it = 0; it < params.iterations; ++it, temperature *= cooling) {
+        std::size_t a = interior(rng);
+        std::size_t b = interior(rng);
+        if (a == b) continue;
+        if (a > b) std::swap(a, b);
+
+        int prev = tour[pos(a - 1)];
+        int first = tour[pos(a)];
+        int last = tour[pos(b)];
+        int next = tour[pos(b + 1)];
+        double delta = edge(xs, ys, prev, last) + edge(xs, ys, first, next)
+                     - edge(xs, ys, prev, first) - edge(xs, ys, last, next);
+
+        if (delta < 0.0 || std::exp(-delta / temperature) > unit(rng)) {
+            // 2-opt: reverse local positions a..b
+            for (std::size_t i = a, j = b; i < j; ++i, --j) {
+                std::swap(tour[pos(i)], tour[pos(j)]);
+            }
+            change += delta;
+        }
+    }
+    return change;
+}